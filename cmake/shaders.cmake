@@ -0,0 +1,65 @@
+# GLSL -> SPIR-V
+
+# --------------------------------------------------------------------
+
+# Shaders are compiled into ${CMAKE_BINARY_DIR}/shaders, the renderer loads shaders/*.spv
+# relative to the working directory, so run it from the build directory.
+# shader.<stage> -> <stage>.spv, <name>.<stage> -> <name>_<stage>.spv
+# Without glslc the prebuilt SPIR-V checked in next to the sources is copied instead. Only the
+# default pipeline has one, shaders without it are left out and the modes using them fail to
+# load their pipeline at runtime.
+
+find_program(GLSLC_EXECUTABLE glslc HINTS ${Vulkan_GLSLC_EXECUTABLE} $ENV{VULKAN_SDK}/bin)
+
+function(add_shaders TARGET)
+    set(SPIRV_DIR ${CMAKE_BINARY_DIR}/shaders)
+    file(MAKE_DIRECTORY ${SPIRV_DIR})
+
+    set(SPIRV_OUTPUTS)
+    set(MISSING_PREBUILT)
+    foreach(SOURCE ${ARGN})
+        get_filename_component(SOURCE_PATH ${SOURCE} ABSOLUTE)
+        get_filename_component(SOURCE_DIR ${SOURCE_PATH} DIRECTORY)
+        get_filename_component(NAME ${SOURCE_PATH} NAME_WE)
+        get_filename_component(STAGE ${SOURCE_PATH} EXT)
+        string(SUBSTRING ${STAGE} 1 -1 STAGE)
+
+        if(NAME STREQUAL "shader")
+            set(SPIRV_NAME ${STAGE}.spv)
+        else()
+            set(SPIRV_NAME ${NAME}_${STAGE}.spv)
+        endif()
+        set(OUTPUT ${SPIRV_DIR}/${SPIRV_NAME})
+        set(PREBUILT ${SOURCE_DIR}/${SPIRV_NAME})
+
+        if(GLSLC_EXECUTABLE)
+            add_custom_command(
+                OUTPUT ${OUTPUT}
+                COMMAND ${GLSLC_EXECUTABLE} ${SOURCE_PATH} -o ${OUTPUT}
+                DEPENDS ${SOURCE_PATH}
+                COMMENT "Compiling shader ${SOURCE}")
+        elseif(EXISTS ${PREBUILT})
+            add_custom_command(
+                OUTPUT ${OUTPUT}
+                COMMAND ${CMAKE_COMMAND} -E copy ${PREBUILT} ${OUTPUT}
+                DEPENDS ${PREBUILT}
+                COMMENT "Copying prebuilt shader ${SPIRV_NAME}")
+        else()
+            list(APPEND MISSING_PREBUILT ${SOURCE})
+            continue()
+        endif()
+        list(APPEND SPIRV_OUTPUTS ${OUTPUT})
+    endforeach()
+
+    if(MISSING_PREBUILT)
+        message(WARNING "glslc not found, using the prebuilt SPIR-V in shaders/. Not built, the modes "
+                        "using them will fail to start: ${MISSING_PREBUILT}. Install the Vulkan SDK "
+                        "or set GLSLC_EXECUTABLE to build every shader")
+    elseif(NOT GLSLC_EXECUTABLE)
+        message(WARNING "glslc not found, using the prebuilt SPIR-V in shaders/")
+    endif()
+    project_log("Shaders are written to ${SPIRV_DIR}, run the renderer from ${CMAKE_BINARY_DIR}")
+
+    add_custom_target(${TARGET} ALL DEPENDS ${SPIRV_OUTPUTS})
+    project_log("Shaders: ${ARGN}")
+endfunction()
@@ -1,9 +1,97 @@
 #include <renderer/app.hpp>
 
+// std
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
-int main()
+namespace {
+
+void PrintUsage()
+{
+    std::cerr << "usage: engine [--headless] [--frames N] [--frames-in-flight N] [--quantized-vertices]"
+              << " [--instances N] [--indirect N] [--gpu-cull] [--occlusion] [--bvh] [--mesh <file>]"
+              << " [--width N] [--height N]" << std::endl;
+}
+
+} // namespace
+
+
+int main(int argc, char** argv)
 {
-    engine::App app;
+    engine::AppSettings settings;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg{argv[i]};
+
+        try
+        {
+            if (arg == "--headless")
+            {
+                settings.headless_ = true;
+            }
+            else if (arg == "--frames" && i + 1 < argc)
+            {
+                settings.frame_limit_ = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--frames-in-flight" && i + 1 < argc)
+            {
+                settings.frames_in_flight_ = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--quantized-vertices")
+            {
+                settings.quantized_vertices_ = true;
+            }
+            else if (arg == "--instances" && i + 1 < argc)
+            {
+                settings.instance_count_ = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--indirect" && i + 1 < argc)
+            {
+                settings.indirect_draw_count_ = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--gpu-cull")
+            {
+                settings.gpu_culling_ = true;
+            }
+            else if (arg == "--occlusion")
+            {
+                settings.occlusion_culling_ = true;
+            }
+            else if (arg == "--bvh")
+            {
+                settings.bvh_culling_ = true;
+            }
+            else if (arg == "--mesh" && i + 1 < argc)
+            {
+                settings.mesh_path_ = argv[++i];
+            }
+            else if (arg == "--width" && i + 1 < argc)
+            {
+                settings.width_ = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--height" && i + 1 < argc)
+            {
+                settings.height_ = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+        }
+        catch (const std::invalid_argument&)
+        {
+            std::cerr << "Invalid value for " << arg << ": " << argv[i] << std::endl;
+            PrintUsage();
+            return 2;
+        }
+        catch (const std::out_of_range&)
+        {
+            std::cerr << "Value out of range for " << arg << ": " << argv[i] << std::endl;
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    engine::App app{settings};
 
     app.Run();
-}
\ No newline at end of file
+}
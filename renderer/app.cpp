@@ -2,19 +2,72 @@
 
 // std
 #include <iostream>
+#include <stdexcept>
 
 // renderer includes
 #include <renderer/renderer/buffer.hpp>
+#include <renderer/renderer/mesh/mesh_optimizer.hpp>
+#include <renderer/renderer/mesh/mesh_file.hpp>
+#include <renderer/renderer/mesh/mesh_importer.hpp>
+#include <renderer/renderer/mesh/mesh_cooker.hpp>
 
 // keycodes
 #include <renderer/input/key_codes.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <numeric>
 
 namespace engine {
 
-App::App()
+namespace {
+
+// copy index of count copies of mesh on a square grid in the xy plane, centered on the mesh
+glm::vec3 GetGridPosition(uint32_t index, uint32_t count, const renderer::MeshRecord& mesh)
+{
+    uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(count))));
+    // meshes created without a bounding sphere have a radius of 0
+    float spacing = 2.5f * std::max(mesh.bounding_sphere_.w, 0.5f);
+    float half_extent = 0.5f * spacing * static_cast<float>(columns - 1);
+
+    return glm::vec3(mesh.bounding_sphere_)
+         + glm::vec3(spacing * static_cast<float>(index % columns) - half_extent, spacing * static_cast<float>(index / columns) - half_extent, 0.0f);
+}
+
+glm::vec4 GetGridColor(uint32_t index, uint32_t count)
+{
+    uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(count))));
+    float inv_columns = 1.0f / static_cast<float>(columns);
+    return glm::vec4(0.5f + 0.5f * (index % columns) * inv_columns, 0.5f + 0.5f * (index / columns) * inv_columns, 1.0f, 1.0f);
+}
+
+constexpr glm::vec4 s_picked_color = glm::vec4(1.0f, 0.35f, 0.2f, 1.0f);
+
+} // namespace
+
+App::App(AppSettings settings)
+    : settings_{settings}
 {
+    if (settings_.headless_)
+    {
+        if (settings_.frame_limit_ == 0)
+        {
+            settings_.frame_limit_ = s_default_headless_frames_;
+        }
+
+        device_ = std::make_unique<renderer::Device>();
+        renderer_ = std::make_unique<renderer::Renderer>(*device_, VkExtent2D{settings_.width_, settings_.height_}, settings_.frames_in_flight_);
+    }
+    else
+    {
+        window_ = std::make_unique<engine::Window>("Triangle", static_cast<int>(settings_.width_), static_cast<int>(settings_.height_));
+        device_ = std::make_unique<renderer::Device>(*window_);
+        renderer_ = std::make_unique<renderer::Renderer>(*device_, *window_, settings_.frames_in_flight_);
+        input_ = std::make_unique<systems::GLFWInput>(*window_);
+    }
+
+    registry_ = std::make_unique<renderer::ResourceRegistry>(*device_);
 
     // Initializing vertex buffer for quad
     // std::vector<renderer::Vertex> square = {           /* Vertices */
@@ -86,14 +139,60 @@ App::App()
     //                                     30, 31, 32, 33, 34, 35, // 6
     //                                 };
 
-    vertex_buffer_ = std::make_unique<renderer::VertexBuffer>(device_, std::move(cube));//, std::move(indices));
+    std::vector<uint32_t> indices;
+    // the cube is only drawn without --mesh
+    if (settings_.mesh_path_.empty())
+    {
+        renderer::mesh::MeshOptimizationReport report = renderer::mesh::OptimizeMesh(cube, indices);
+        renderer::mesh::PrintReport("cube", report);
+    }
+    // the cube spans [-0.5, 0.5]
+    const glm::vec4 cube_bounds(0.0f, 0.0f, 0.0f, std::sqrt(0.75f));
+
+    if (!settings_.mesh_path_.empty())
+    {
+        LoadMesh(settings_.mesh_path_);
+    }
+    else if (settings_.quantized_vertices_)
+    {
+        std::vector<renderer::mesh::MeshVertex> mesh_vertices(cube.size());
+        for (size_t i = 0; i < cube.size(); ++i)
+        {
+            mesh_vertices[i].pos_ = cube[i].pos_;
+            mesh_vertices[i].col_ = glm::vec4(cube[i].col_, 1.0f);
+        }
+        renderer::mesh::GenerateNormals(mesh_vertices, indices);
+
+        renderer::mesh::QuantizedMesh quantized = renderer::mesh::QuantizeMesh(mesh_vertices, indices);
+        renderer::mesh::PrintReport("cube", quantized.report_);
+
+        mesh_dequantization_ = quantized.dequantization_;
+        mesh_ = registry_->CreateMesh(quantized.vertices_, indices, cube_bounds);
+    }
+    else
+    {
+        mesh_ = registry_->CreateMesh(cube, indices, cube_bounds);
+    }
+
+    // after loading, a mesh file decides whether the vertices are quantized
+    if ((settings_.instance_count_ > 0 || settings_.indirect_draw_count_ > 0) && settings_.quantized_vertices_)
+    {
+        std::cerr << "Instanced and indirect draws are not available with quantized vertices, drawing a single mesh" << std::endl;
+        settings_.instance_count_ = 0;
+        settings_.indirect_draw_count_ = 0;
+    }
+    if (settings_.indirect_draw_count_ > 0)
+    {
+        settings_.instance_count_ = 0;
+    }
     // vertex_buffer_ = std::make_unique<renderer::VertexBuffer>(device_, std::move(cube), std::move(indices));
 
     // global descriptor pool
     global_descriptor_pool_ = 
-        renderer::DescriptorPool::Builder(device_)
-        .SetMaxSets(renderer::SwapChain::MAX_FRAMES_IN_FLIGHT)
-        .AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, renderer::SwapChain::MAX_FRAMES_IN_FLIGHT)
+        renderer::DescriptorPool::Builder(*device_)
+        .SetMaxSets(1)
+        .AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1)
+        .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1)
         .Build();
 
     auto position = glm::vec3(.0f, .0f, -5.0f);
@@ -106,87 +205,467 @@ void App::Run()
 {   
     // =========================================== Preparation for begining main loop =========================================== //
 
-    // Creating uniform buffers for future its usage in descriptor sets
-    ubo_buffers.resize(renderer::SwapChain::MAX_FRAMES_IN_FLIGHT);
-    for (int i = 0; i < ubo_buffers.size(); ++i)
+    // Frame ring buffer for uniform data. Every frame in flight owns a region of it,
+    // so a single descriptor set with a dynamic offset covers all frames
+    // the instance stream is rewritten every frame as well
+    VkDeviceSize frame_capacity = renderer::FrameRingBuffer::s_default_frame_capacity_ + settings_.instance_count_ * sizeof(renderer::InstanceData);
+    frame_ring_buffer_ = std::make_unique<renderer::FrameRingBuffer>(*device_, renderer_->GetFramesInFlight(), frame_capacity);
+
+    if (settings_.indirect_draw_count_ > 0)
     {
-        ubo_buffers[i] = std::make_unique<renderer::Buffer>(device_, sizeof(renderer::UBO), 1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
-        ubo_buffers[i]->Map();
+        CreateIndirectDraws();
     }
 
     // Creating global descriptor layout
-    global_descriptor_set_layout_ = renderer::DescriptorSetLayout::Builder(device_)
-                    .AddBindings(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
-                    .Build();
-
-    
-    // // allocating descriptor sets from global descriptor pool
-    global_descriptor_sets_.resize(renderer::SwapChain::MAX_FRAMES_IN_FLIGHT);
-    for (int i = 0; i < global_descriptor_sets_.size(); ++i)
+    renderer::DescriptorSetLayout::Builder layout_builder(*device_);
+    layout_builder.AddBindings(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT);
+    if (indirect_draws_)
     {
-        auto buffer_info = ubo_buffers[i]->DescriptorInfo();
-        renderer::DescriptorWriter(*global_descriptor_set_layout_, *global_descriptor_pool_)
-            .WriteBuffer(0, &buffer_info)
-            .Build(global_descriptor_sets_[i]);
+        // per draw data, at the prepared frame's region
+        layout_builder.AddBindings(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT);
     }
+    global_descriptor_set_layout_ = layout_builder.Build();
+
+    // allocating the descriptor set from global descriptor pool
+    auto buffer_info = frame_ring_buffer_->DescriptorInfo(sizeof(renderer::UBO));
+    renderer::DescriptorWriter writer(*global_descriptor_set_layout_, *global_descriptor_pool_);
+    writer.WriteBuffer(0, &buffer_info);
+    VkDescriptorBufferInfo draw_data_info{};
+    if (indirect_draws_)
+    {
+        draw_data_info = indirect_draws_->DrawDataDescriptorInfo();
+        writer.WriteBuffer(1, &draw_data_info);
+    }
+    writer.Build(global_descriptor_set_);
     
     // Creating pipeline for quad rendering. For now this is a kind of prototype for the rendering system 
-    pipeline_ = std::make_unique<renderer::Pipeline>(device_, renderer_.GetSwapchainRenderPass(), global_descriptor_set_layout_->GetDescriptorSetLayout());
+    renderer::PipelineConfig pipeline_config{};
+    if (settings_.quantized_vertices_)
+    {
+        pipeline_config.vertex_shader_ = "shaders/quantized_vert.spv";
+        pipeline_config.vertex_input_ = renderer::QuantizedVertexLayout::GetDescription();
+        pipeline_config.push_constant_size_ = sizeof(renderer::mesh::DequantizationConstants);
+    }
+    else if (settings_.instance_count_ > 0)
+    {
+        pipeline_config.vertex_shader_ = "shaders/instanced_vert.spv";
+        pipeline_config.vertex_input_ = renderer::InstancedVertexLayout::GetDescription();
+    }
+    else if (indirect_draws_)
+    {
+        pipeline_config.vertex_shader_ = "shaders/indirect_vert.spv";
+    }
+    pipeline_ = registry_->AddPipeline(std::make_unique<renderer::Pipeline>(*device_, renderer_->GetSwapchainRenderPass(), global_descriptor_set_layout_->GetDescriptorSetLayout(), pipeline_config));
     // pipeline_ = std::make_unique<renderer::Pipeline>(device_, renderer_.GetSwapchainRenderPass(), nullptr);
-    while(!window_.ShouldClose())
+
+    device_->GetAllocator().PrintStats();
+    registry_->GetGeometryArena().PrintStats();
+
+    uint32_t frame_count = 0;
+    auto loop_start_time = std::chrono::high_resolution_clock::now();
+
+    while(!ShouldClose(frame_count))
     {
         // main loop
-        glfwPollEvents();
-        
-        // updating input system or camera state
-        input_.Update();
+        if (window_)
+        {
+            glfwPollEvents();
+            
+            // updating input system or camera state
+            input_->Update();
+        }
 
         // std::cout << "loop" << std::endl;
-        if (auto command_buffer = renderer_.BeginFrame())
+        if (auto command_buffer = renderer_->BeginFrame())
         {
             renderer::FrameInfo frame_info{};
-            frame_info.frame_index_ = renderer_.GetFrameIndex();
+            frame_info.frame_index_ = renderer_->GetFrameIndex();
             frame_info.command_buffer_ = command_buffer;
-            frame_info.global_descriptor_set_ = global_descriptor_sets_[frame_info.frame_index_];
+            frame_info.global_descriptor_set_ = global_descriptor_set_;
+
+            // BeginFrame waited for this frame's fence, its ring buffer region is free again
+            frame_ring_buffer_->BeginFrame(frame_info.frame_index_);
 
             UpdateUBO(frame_info);
+            PrepareDraws(frame_info);
 
-            renderer_.BeginRenderPass(command_buffer);
+            renderer_->BeginRenderPass(command_buffer);
             Render(frame_info);
-            renderer_.EndRenderPass(command_buffer);
-            renderer_.EndFrame(command_buffer);
+            renderer_->EndRenderPass(command_buffer);
+            if (occlusion_culler_)
+            {
+                RenderLateDraws(frame_info);
+            }
+            renderer_->EndFrame(command_buffer);
+            ++frame_count;
         }
         else
         {
             std::cout << "Error receiving command_buffer from BeginFrame function" << std::endl;
         }
-        vkDeviceWaitIdle(device_.GetDevice());
+        // no idle wait here: BeginFrame blocks only on the fence of the frame slot it reuses,
+        // so recording frame N + 1 overlaps the GPU executing frame N
+    }
+
+    vkDeviceWaitIdle(device_->GetDevice());
+
+    // throughput report, the main use of headless runs
+    float elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - loop_start_time).count();
+    std::cout << "Rendered " << frame_count << " frames in " << elapsed << " s ("
+              << (elapsed > 0.0f ? frame_count / elapsed : 0.0f) << " FPS"
+              << (settings_.headless_ ? ", headless" : "") << ")" << std::endl;
+    if (gpu_culler_)
+    {
+        std::cout << "GPU culling: " << gpu_culler_->GetVisibleCount() << " of " << indirect_draws_->GetDrawCount() << " draws visible" << std::endl;
+    }
+    if (occlusion_culler_)
+    {
+        std::cout << "Occlusion culling: " << occlusion_culler_->GetVisibleCount() << " of " << indirect_draws_->GetDrawCount() << " draws visible, "
+                  << occlusion_culler_->GetLateVisibleCount() << " of them found by the late phase" << std::endl;
+    }
+    if (indirect_draws_ && settings_.bvh_culling_)
+    {
+        std::cout << "BVH culling: " << visible_draws_.size() << " of " << scene_bvh_.GetObjectCount() << " draws visible, "
+                  << bvh_cull_stats_.nodes_visited_ << " nodes visited, " << bvh_cull_stats_.subtrees_inside_ << " subtrees inside" << std::endl;
+    }
+}
+
+void App::LoadMesh(const std::string& path)
+{
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    if (renderer::mesh::IsImportableMesh(path))
+    {
+        ImportMesh(path);
+        return;
+    }
+
+    renderer::mesh::MeshFile file(path);
+    const renderer::mesh::MeshFileHeader& header = file.GetHeader();
+
+    switch (header.vertex_format_)
+    {
+    case renderer::mesh::MeshVertexFormat::Standard:
+        settings_.quantized_vertices_ = false;
+        break;
+    case renderer::mesh::MeshVertexFormat::Quantized:
+        settings_.quantized_vertices_ = true;
+        mesh_dequantization_ = header.dequantization_;
+        break;
+    default:
+        throw std::runtime_error("Mesh file has no drawable vertex format, cook it as standard or quantized: " + path);
     }
+
+    mesh_ = registry_->LoadMesh(file);
+
+    float load_ms = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - start_time).count();
+    std::cout << "Loaded mesh " << path << ": " << header.vertex_count_ << " vertices, " << header.index_count_ << " indices, "
+              << file.GetFileSize() << " bytes in " << load_ms << " ms" << std::endl;
+}
+
+void App::ImportMesh(const std::string& path)
+{
+    renderer::mesh::ImportedMesh imported = renderer::mesh::ImportMesh(path);
+    renderer::mesh::PrintStats(path.c_str(), imported.stats_);
+
+    // the cooker does this offline, sources loaded directly pay for it here
+    renderer::mesh::CookOptions lod_options{};
+    std::vector<renderer::mesh::Meshlet> meshlets = renderer::mesh::BuildMeshMeshlets(imported, lod_options.meshlet_settings_);
+    std::vector<renderer::mesh::MeshFileLod> lods = renderer::mesh::GenerateLodChain(
+        imported, lod_options.lod_count_, lod_options.lod_reduction_, lod_options.lod_max_error_);
+    glm::vec4 bounding_sphere = renderer::mesh::ComputeBoundingSphere(imported.vertices_);
+
+    if (settings_.quantized_vertices_)
+    {
+        renderer::mesh::QuantizedMesh quantized = renderer::mesh::QuantizeMesh(imported.vertices_, imported.indices_);
+        renderer::mesh::PrintReport(path.c_str(), quantized.report_);
+
+        mesh_dequantization_ = quantized.dequantization_;
+        mesh_ = registry_->AddStaticMesh(std::as_bytes(std::span<const renderer::mesh::QuantizedVertex>(quantized.vertices_)),
+                                         sizeof(renderer::mesh::QuantizedVertex),
+                                         imported.indices_,
+                                         lods,
+                                         bounding_sphere,
+                                         meshlets);
+    }
+    else
+    {
+        std::vector<renderer::Vertex> vertices = renderer::mesh::ToStandardVertices(imported.vertices_);
+        mesh_ = registry_->AddStaticMesh(std::as_bytes(std::span<const renderer::Vertex>(vertices)),
+                                         sizeof(renderer::Vertex),
+                                         imported.indices_,
+                                         lods,
+                                         bounding_sphere,
+                                         meshlets);
+    }
+}
+
+bool App::ShouldClose(uint32_t frame_count)
+{
+    if (settings_.frame_limit_ != 0 && frame_count >= settings_.frame_limit_)
+    {
+        return true;
+    }
+
+    return window_ && window_->ShouldClose();
 }
 
 
 void App::Render(const renderer::FrameInfo& frame_info)
 {
     // rendering quad demo
-    // bind pipeline
-    vkCmdBindPipeline(frame_info.command_buffer_, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_->GetGraphicsPipeline());
+    renderer::PipelineRecord* pipeline = registry_->GetPipeline(pipeline_);
+    renderer::MeshRecord* cube = registry_->GetMesh(mesh_);
+    if (!pipeline || !cube)
+    {
+        return;
+    }
+
+    BindPipeline(frame_info, *pipeline);
+
+    // the model matrix is identity, see UpdateUBO
+    mesh_lod_ = lod_selector_.Select(*cube, glm::mat4(1.0f), mesh_lod_);
+
+    // every static mesh shares the arena buffers, draws below only differ in offsets
+    registry_->BindGeometry(frame_info.command_buffer_);
 
-    // Binding descriptor sets
-    vkCmdBindDescriptorSets(frame_info.command_buffer_, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_->GetLayout(), 0, 1, &frame_info.global_descriptor_set_, 0, nullptr);
+    if (occlusion_culler_)
+    {
+        // the late draws follow in RenderLateDraws
+        occlusion_culler_->Record(frame_info.command_buffer_, renderer::CullPhase::Early);
+        return;
+    }
+    if (gpu_culler_)
+    {
+        gpu_culler_->Record(frame_info.command_buffer_);
+        return;
+    }
+    if (indirect_draws_)
+    {
+        // one call however many draws the list holds
+        indirect_draws_->Record(frame_info.command_buffer_);
+        return;
+    }
+
+    if (settings_.instance_count_ > 0)
+    {
+        DrawInstances(frame_info, *cube);
+        return;
+    }
+
+    // meshlets only cover the full detail level
+    if (cube->meshlets_ && mesh_lod_ == 0)
+    {
+        glm::mat4 view = camera_->GetViewMatrix();
+        glm::vec3 camera_position = glm::vec3(glm::inverse(view)[3]);
+        cube->meshlets_->Cull(camera_->GetProjMatrix() * view, camera_position, visible_meshlets_);
+        renderer::ResourceRegistry::DrawMeshRanges(frame_info.command_buffer_, *cube, visible_meshlets_);
+        return;
+    }
 
     // draw cmd for quad vertex buffer
-    vertex_buffer_->DrawBuffer(frame_info.command_buffer_);
+    renderer::ResourceRegistry::DrawBoundMesh(frame_info.command_buffer_, *cube, 1, mesh_lod_);
 }
 
 
-void App::UpdateUBO(const renderer::FrameInfo& frame_info)
+void App::DrawInstances(const renderer::FrameInfo& frame_info, const renderer::MeshRecord& mesh)
+{
+    static auto start_time = std::chrono::high_resolution_clock::now();
+    float time = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - start_time).count();
+
+    uint32_t instance_count = settings_.instance_count_;
+
+    renderer::RingAllocation allocation = frame_ring_buffer_->Allocate(instance_count * sizeof(renderer::InstanceData));
+    renderer::InstanceData* instances = static_cast<renderer::InstanceData*>(allocation.mapped_);
+
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), GetGridPosition(i, instance_count, mesh));
+        model = glm::rotate(model, time + 0.1f * static_cast<float>(i), glm::vec3(0.0f, 1.0f, 0.0f));
+
+        // one store per instance, the ring may be write combined memory
+        instances[i] = renderer::InstanceData{model, GetGridColor(i, instance_count), 0};
+    }
+
+    // the selected level was picked for the mesh at the origin and is shared by every instance
+    renderer::ResourceRegistry::DrawInstanced(frame_info.command_buffer_, mesh, frame_ring_buffer_->GetBuffer(), allocation.offset_, instance_count, mesh_lod_);
+}
+
+void App::CreateIndirectDraws()
+{
+    renderer::MeshRecord* mesh = registry_->GetMesh(mesh_);
+    if (!mesh)
+    {
+        return;
+    }
+
+    uint32_t draw_count = settings_.indirect_draw_count_;
+    indirect_draws_ = std::make_unique<renderer::IndirectDrawList>(*device_, renderer_->GetFramesInFlight(), draw_count);
+
+    // static transforms, the draw list is only rewritten when the visible set or the picked draw changes
+    std::vector<renderer::Aabb> draw_bounds(draw_count);
+    indirect_draw_data_.resize(draw_count);
+    for (uint32_t i = 0; i < draw_count; ++i)
+    {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), GetGridPosition(i, draw_count, *mesh));
+        indirect_draw_data_[i] = renderer::DrawData{model, GetGridColor(i, draw_count)};
+        draw_bounds[i] = renderer::Aabb::Transform(renderer::Aabb::FromSphere(mesh->bounding_sphere_), model);
+    }
+    visible_draws_.resize(draw_count);
+    std::iota(visible_draws_.begin(), visible_draws_.end(), 0u);
+    draw_list_dirty_ = true;
+
+    scene_bvh_.Build(draw_bounds);
+
+    std::cout << "Indirect draws: " << draw_count << " draws, " << renderer::ToString(indirect_draws_->GetMode()) << std::endl;
+    std::cout << "Scene BVH: " << scene_bvh_.GetNodeCount() << " nodes, depth " << scene_bvh_.GetDepth()
+              << ", SAH cost " << scene_bvh_.GetSahCost() << (settings_.bvh_culling_ ? ", culling draws" : "") << std::endl;
+
+    if (settings_.occlusion_culling_)
+    {
+        if (renderer::OcclusionCuller::IsSupported(*indirect_draws_, renderer_->GetDepthAttachment()))
+        {
+            depth_pyramid_ = std::make_unique<renderer::DepthPyramid>(*device_);
+            occlusion_culler_ = std::make_unique<renderer::OcclusionCuller>(*device_, *indirect_draws_, *depth_pyramid_, renderer_->GetFramesInFlight());
+            std::cout << "Occlusion culling: two phases, " << (occlusion_culler_->IsCompacting() ? "compacted draws" : "culled draws with instanceCount 0") << std::endl;
+            return;
+        }
+        std::cerr << "Occlusion culling needs drawIndirectFirstInstance and a sampled depth format, frustum culling on the GPU instead" << std::endl;
+        settings_.gpu_culling_ = true;
+    }
+
+    if (!settings_.gpu_culling_)
+    {
+        return;
+    }
+    if (!renderer::GpuDrawCuller::IsSupported(*indirect_draws_))
+    {
+        std::cerr << "GPU culling needs drawIndirectFirstInstance, drawing every indirect draw" << std::endl;
+        return;
+    }
+    gpu_culler_ = std::make_unique<renderer::GpuDrawCuller>(*device_, *indirect_draws_, renderer_->GetFramesInFlight());
+    std::cout << "GPU culling: " << (gpu_culler_->IsCompacting() ? "compacted draws" : "culled draws with instanceCount 0") << std::endl;
+}
+
+void App::PrepareDraws(const renderer::FrameInfo& frame_info)
+{
+    if (!indirect_draws_)
+    {
+        return;
+    }
+
+    glm::mat4 view_projection = camera_->GetProjMatrix() * camera_->GetViewMatrix();
+    if (input_ && input_->WasMouseButtonClicked(systems::MouseButton::LEFT))
+    {
+        PickDraw(view_projection);
+    }
+
+    if (settings_.bvh_culling_)
+    {
+        bvh_cull_stats_ = scene_bvh_.Cull(renderer::ExtractFrustumPlanes(view_projection), bvh_visible_draws_);
+        std::sort(bvh_visible_draws_.begin(), bvh_visible_draws_.end());
+        if (bvh_visible_draws_ != visible_draws_)
+        {
+            visible_draws_.swap(bvh_visible_draws_);
+            draw_list_dirty_ = true;
+        }
+    }
+
+    if (draw_list_dirty_)
+    {
+        const renderer::MeshRecord* mesh = registry_->GetMesh(mesh_);
+        indirect_draws_->Clear();
+        for (uint32_t draw : visible_draws_)
+        {
+            renderer::DrawData data = indirect_draw_data_[draw];
+            if (draw == picked_draw_)
+            {
+                data.color_ = s_picked_color;
+            }
+            indirect_draws_->AddDraw(*mesh, data);
+        }
+        draw_list_dirty_ = false;
+    }
+
+    indirect_draws_->Prepare(frame_info.frame_index_);
+    if (occlusion_culler_)
+    {
+        depth_pyramid_->Prepare(frame_info.command_buffer_, renderer_->GetDepthAttachment());
+        occlusion_culler_->CullEarly(frame_info.command_buffer_, frame_info.frame_index_, view_projection);
+    }
+    else if (gpu_culler_)
+    {
+        gpu_culler_->Cull(frame_info.command_buffer_, frame_info.frame_index_, view_projection);
+    }
+}
+
+void App::RenderLateDraws(const renderer::FrameInfo& frame_info)
+{
+    // the pyramid of the early draws, read by the late phase and by the next frame's early phase
+    depth_pyramid_->Build(frame_info.command_buffer_, renderer_->GetDepthAttachment());
+    occlusion_culler_->CullLate(frame_info.command_buffer_);
+
+    renderer::PipelineRecord* pipeline = registry_->GetPipeline(pipeline_);
+    if (!pipeline)
+    {
+        return;
+    }
+
+    renderer_->ResumeRenderPass(frame_info.command_buffer_);
+    BindPipeline(frame_info, *pipeline);
+    registry_->BindGeometry(frame_info.command_buffer_);
+    occlusion_culler_->Record(frame_info.command_buffer_, renderer::CullPhase::Late);
+    renderer_->EndRenderPass(frame_info.command_buffer_);
+}
+
+void App::BindPipeline(const renderer::FrameInfo& frame_info, renderer::PipelineRecord& pipeline)
+{
+    vkCmdBindPipeline(frame_info.command_buffer_, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.pipeline_);
+
+    // Binding descriptor sets, dynamic offsets in binding order
+    uint32_t dynamic_offsets[] = {frame_info.global_ubo_offset_, 0};
+    uint32_t dynamic_offset_count = 1;
+    if (indirect_draws_)
+    {
+        dynamic_offsets[dynamic_offset_count++] = indirect_draws_->GetRegionOffset();
+    }
+    vkCmdBindDescriptorSets(frame_info.command_buffer_, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.layout_, 0, 1, &frame_info.global_descriptor_set_, dynamic_offset_count, dynamic_offsets);
+
+    if (settings_.quantized_vertices_)
+    {
+        vkCmdPushConstants(frame_info.command_buffer_, pipeline.layout_, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mesh_dequantization_), &mesh_dequantization_);
+    }
+}
+
+void App::PickDraw(const glm::mat4& view_projection)
+{
+    auto [mouse_x, mouse_y] = input_->GetMousePosition();
+    VkExtent2D extent = window_->GetExtent();
+    renderer::Ray ray = renderer::ScreenPointToRay(glm::vec2(mouse_x, mouse_y), glm::vec2(extent.width, extent.height), view_projection);
+
+    renderer::RayHit hit = scene_bvh_.Raycast(ray);
+    if (hit.IsHit())
+    {
+        std::cout << "Picked draw " << hit.object_ << " at distance " << hit.distance_ << std::endl;
+    }
+    if (hit.object_ != picked_draw_)
+    {
+        picked_draw_ = hit.object_;
+        draw_list_dirty_ = true;
+    }
+}
+
+void App::UpdateUBO(renderer::FrameInfo& frame_info)
 {
     static auto start_time = std::chrono::high_resolution_clock::now();
 
     auto current_time = std::chrono::high_resolution_clock::now();
     float time = std::chrono::duration<float, std::chrono::seconds::period>(current_time - start_time).count();
     
-    controller_.MoveCammera(*camera_, input_);
+    if (input_)
+    {
+        controller_.MoveCammera(*camera_, *input_);
+    }
     
     renderer::UBO ubo;
     // ubo.model_ = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
@@ -221,11 +700,12 @@ void App::UpdateUBO(const renderer::FrameInfo& frame_info)
     // ubo.view_  = glm::lookAt(glm::vec3(.0f, -1.0f, -1.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)); 
     ubo.view_ = camera_->GetViewMatrix();
     ubo.proj_ = camera_->GetProjMatrix();
+    lod_selector_.Update(ubo.view_, ubo.proj_, static_cast<float>(renderer_->GetSwapChainExtent().height));
     // ubo.proj_  = glm::perspective(glm::radians(45.0f), renderer_.GetSwapChainExtent().width / static_cast<float>(renderer_.GetSwapChainExtent().height), 0.1f, 10.0f);
     // ubo.proj_[1][1] *= -1;
 
-    ubo_buffers[frame_info.frame_index_]->WriteToBuffer(&ubo);
-    ubo_buffers[frame_info.frame_index_]->Flush(); // TODO: try to comment this line when rendering
+    // host coherent memory, no flush needed
+    frame_info.global_ubo_offset_ = frame_ring_buffer_->Push(ubo).offset_;
 }
 
 
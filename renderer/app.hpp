@@ -2,6 +2,8 @@
 
 // std
 #include <memory>
+#include <string>
+#include <vector>
 
 // vulkan
 #include <vulkan/vulkan.h>
@@ -13,6 +15,15 @@
 #include <renderer/renderer/renderer.hpp>
 #include <renderer/renderer/pipeline.hpp>
 #include <renderer/renderer/frame_utility.hpp>
+#include <renderer/renderer/frame_ring_buffer.hpp>
+#include <renderer/renderer/resource_registry.hpp>
+#include <renderer/renderer/lod_selector.hpp>
+#include <renderer/renderer/indirect_draw_list.hpp>
+#include <renderer/renderer/gpu_draw_culler.hpp>
+#include <renderer/renderer/depth_pyramid.hpp>
+#include <renderer/renderer/occlusion_culler.hpp>
+#include <renderer/renderer/bvh.hpp>
+#include <renderer/renderer/mesh/vertex_quantization.hpp>
 
 // systems
 #include <renderer/input/input.hpp>
@@ -23,10 +34,49 @@
 
 namespace engine {
 
+struct AppSettings
+{
+    // render into offscreen images without a window or surface (CI, render farm nodes)
+    bool headless_ = false;
+
+    uint32_t width_ = 1920;
+    uint32_t height_ = 1080;
+
+    // number of frames to render before exiting, 0 runs until the window is closed.
+    // Headless runs always need a limit, s_default_headless_frames_ is used when it is 0
+    uint32_t frame_limit_ = 0;
+
+    // frames the CPU may record ahead of the GPU, clamped to [1, 4]
+    uint32_t frames_in_flight_ = renderer::SwapChain::DEFAULT_FRAMES_IN_FLIGHT;
+
+    // draw meshes with the 24 byte quantized vertex format (shaders/quantized.vert)
+    bool quantized_vertices_ = false;
+
+    // cooked .rmesh file or .obj/.gltf/.glb source drawn instead of the built-in cube
+    std::string mesh_path_;
+
+    // copies of the mesh drawn on a grid with one instanced draw (shaders/instanced.vert),
+    // 0 draws the mesh once. Not available with quantized vertices
+    uint32_t instance_count_ = 0;
+
+    // copies of the mesh drawn on a grid as separate draws, all submitted with one indirect call
+    // (shaders/indirect.vert). Takes precedence over instance_count_, not available with
+    // quantized vertices
+    uint32_t indirect_draw_count_ = 0;
+    // frustum cull the indirect draws in a compute pass (shaders/cull.comp)
+    bool gpu_culling_ = false;
+    // two phase occlusion culling of the indirect draws against a depth pyramid
+    // (shaders/occlusion_cull.comp), frustum culling included. Takes precedence over gpu_culling_
+    bool occlusion_culling_ = false;
+    // frustum cull the indirect draws on the CPU with the scene BVH, only the visible draws are
+    // written to the draw list. Picking with the left mouse button works without it
+    bool bvh_culling_ = false;
+};
+
 class App
 {
 public:
-    App();
+    App(AppSettings settings = {});
 
     void Run();
 
@@ -34,25 +84,71 @@ public:
 
 
 private:
-    void UpdateUBO(const renderer::FrameInfo& frame_info);
+    void LoadMesh(const std::string& path);
+    void ImportMesh(const std::string& path);
+    void UpdateUBO(renderer::FrameInfo& frame_info);
+    // fills indirect_draws_ with a grid of settings_.indirect_draw_count_ copies of the mesh
+    void CreateIndirectDraws();
+    // work recorded before the render pass: picking, indirect draw buffers and culling
+    void PrepareDraws(const renderer::FrameInfo& frame_info);
+    // highlights the indirect draw under the mouse cursor
+    void PickDraw(const glm::mat4& view_projection);
+    // second render pass of occlusion culling: the draws the rebuilt depth pyramid shows
+    void RenderLateDraws(const renderer::FrameInfo& frame_info);
+    // pipeline, descriptor sets and push constants of the scene draws
+    void BindPipeline(const renderer::FrameInfo& frame_info, renderer::PipelineRecord& pipeline);
+    // fills this frame's instance stream and draws every instance of mesh with one call
+    void DrawInstances(const renderer::FrameInfo& frame_info, const renderer::MeshRecord& mesh);
+    bool ShouldClose(uint32_t frame_count);
 
 private:
+    static constexpr uint32_t s_default_headless_frames_ = 1000;
+
     bool running_{true};
+    AppSettings settings_;
 
-    engine::Window window_{"Triangle", 1920, 1080};
-    renderer::Device device_{window_};
-    renderer::Renderer renderer_{device_, window_};
+    std::unique_ptr<engine::Window> window_ = nullptr; // nullptr in headless mode
+    std::unique_ptr<renderer::Device> device_ = nullptr;
+    std::unique_ptr<renderer::Renderer> renderer_ = nullptr;
 
     std::unique_ptr<renderer::DescriptorPool> global_descriptor_pool_ = nullptr;
-    // for rendering once quad. For demo only
-    std::unique_ptr<renderer::Pipeline> pipeline_ = nullptr; // triangle pipeline
-    std::unique_ptr<renderer::VertexBuffer> vertex_buffer_ = nullptr;
+    // owns pipelines, meshes and other GPU resources, addressed by handles
+    std::unique_ptr<renderer::ResourceRegistry> registry_ = nullptr;
 
-    std::vector<std::unique_ptr<renderer::Buffer>> ubo_buffers;
+    // for rendering once quad. For demo only
+    renderer::PipelineHandle pipeline_; // triangle pipeline
+    renderer::MeshHandle mesh_;
+    // pushed with the mesh when it is quantized
+    renderer::mesh::DequantizationConstants mesh_dequantization_;
+    // detail level drawn last frame, for the selector's hysteresis
+    uint32_t mesh_lod_ = 0;
+    renderer::LodSelector lod_selector_;
+    // index ranges of the meshlets that passed culling this frame, reused across frames
+    std::vector<renderer::IndexRange> visible_meshlets_;
+    // static draws of --indirect, recorded with one call per frame
+    std::unique_ptr<renderer::IndirectDrawList> indirect_draws_ = nullptr;
+    // culls indirect_draws_ on the GPU when settings_.gpu_culling_ is set
+    std::unique_ptr<renderer::GpuDrawCuller> gpu_culler_ = nullptr;
+    // cull indirect_draws_ in two phases when settings_.occlusion_culling_ is set
+    std::unique_ptr<renderer::DepthPyramid> depth_pyramid_ = nullptr;
+    std::unique_ptr<renderer::OcclusionCuller> occlusion_culler_ = nullptr;
+    // world bounds of the indirect draws, object ids are draw ids of indirect_draw_data_
+    renderer::Bvh scene_bvh_;
+    std::vector<renderer::DrawData> indirect_draw_data_;
+    // draws written to indirect_draws_ in ascending order, every draw without BVH culling
+    std::vector<uint32_t> visible_draws_;
+    std::vector<uint32_t> bvh_visible_draws_;
+    renderer::BvhCullStats bvh_cull_stats_;
+    uint32_t picked_draw_ = renderer::RayHit::s_no_object_;
+    // indirect_draws_ needs rewriting from visible_draws_
+    bool draw_list_dirty_ = false;
+
+    // transient per frame data (UBOs, per object data), bound with dynamic offsets
+    std::unique_ptr<renderer::FrameRingBuffer> frame_ring_buffer_ = nullptr;
     std::unique_ptr<renderer::DescriptorSetLayout> global_descriptor_set_layout_ = nullptr;
-    std::vector<VkDescriptorSet> global_descriptor_sets_;
+    VkDescriptorSet global_descriptor_set_;
 
-    systems::GLFWInput input_{window_};
+    std::unique_ptr<systems::GLFWInput> input_ = nullptr; // nullptr in headless mode
     std::unique_ptr<Camera> camera_ = nullptr;
     CameraController controller_;
 
@@ -1,5 +1,8 @@
 #include <renderer/input/input.hpp>
 
+// std
+#include <iterator>
+
 // glfw
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
@@ -20,6 +23,12 @@ void GLFWInput::Update()
             pressed_buttons_[key] = false;
         }
     }
+
+    for (uint32_t button = 0; button < std::size(mouse_buttons_); ++button)
+    {
+        previous_mouse_buttons_[button] = mouse_buttons_[button];
+        mouse_buttons_[button] = glfwGetMouseButton(window_.GetNativeWindow(), static_cast<int>(button)) == GLFW_PRESS;
+    }
 }
 
 bool GLFWInput::IsKeyPressed(Key keycode)
@@ -32,28 +41,32 @@ bool GLFWInput::IsKeyPressed(Key keycode)
     return false;
 }
 
-bool GLFWInput::IsMouseButtonPressed(Key button)
+bool GLFWInput::IsMouseButtonPressed(MouseButton button)
 {
-    // Not implemented
-    return false;
+    return mouse_buttons_[static_cast<uint32_t>(button)];
+}
+
+bool GLFWInput::WasMouseButtonClicked(MouseButton button)
+{
+    return mouse_buttons_[static_cast<uint32_t>(button)] && !previous_mouse_buttons_[static_cast<uint32_t>(button)];
 }
 
 std::pair<float, float> GLFWInput::GetMousePosition()
 {
-    // Not implemented
-    return {};
+    double x = 0.0;
+    double y = 0.0;
+    glfwGetCursorPos(window_.GetNativeWindow(), &x, &y);
+    return {static_cast<float>(x), static_cast<float>(y)};
 }
 
 float GLFWInput::GetMouseX()
 {
-    // Not implemented
-    return {};
+    return GetMousePosition().first;
 }
 
 float GLFWInput::GetMouseY()
 {
-    // Not implemented
-    return {};
+    return GetMousePosition().second;
 }
 
 } // namespace systems
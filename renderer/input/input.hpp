@@ -47,8 +47,10 @@ public:
     void Update();
     bool IsKeyPressed(Key keycode);
 
-private:
-    bool IsMouseButtonPressed(Key button);
+    bool IsMouseButtonPressed(MouseButton button);
+    // pressed at this Update but not at the previous one, e.g. a click to pick with
+    bool WasMouseButtonClicked(MouseButton button);
+    // cursor in window coordinates, origin at the top left
     std::pair<float, float> GetMousePosition();
     float GetMouseX();
     float GetMouseY();
@@ -59,6 +61,10 @@ private:
     // for currrent implementation
     std::unordered_map<Key, bool> pressed_buttons_;
 
+    // indexed by MouseButton, state of the last and the previous Update
+    bool mouse_buttons_[3]{};
+    bool previous_mouse_buttons_[3]{};
+
 };
 
 } // namespace engine::systems
\ No newline at end of file
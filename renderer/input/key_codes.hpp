@@ -131,6 +131,14 @@ enum class Key : uint32_t
     MENU               = 348
 };
 
+enum class MouseButton : uint32_t
+{
+    // From glfw3.h
+    LEFT               = 0,
+    RIGHT              = 1,
+    MIDDLE             = 2
+};
+
 
 } // namespace engine::system
 
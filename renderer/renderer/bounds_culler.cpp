@@ -0,0 +1,470 @@
+#include <renderer/renderer/bounds_culler.hpp>
+
+// std
+#include <array>
+#include <bit>
+
+// x86 kernels are compiled per function (target attributes), the library needs no -m flags and
+// picks the kernel at run time. Other architectures and compilers only have the scalar kernel.
+#if defined(__x86_64__) || defined(__i386__)
+#define RENDERER_X86_CULL_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace renderer {
+
+namespace {
+
+// widest kernel, the output needs this much slack for its full width stores
+constexpr size_t s_max_lanes = 8;
+
+// a plane with the streams of the AABB corner furthest along its normal: the box is outside
+// when that corner is
+struct AabbPlane
+{
+    glm::vec4 plane_;
+    const float* x_;
+    const float* y_;
+    const float* z_;
+};
+
+std::array<AabbPlane, 6> SelectPositiveCorners(const FrustumPlanes& planes, const AabbBounds& bounds)
+{
+    std::array<AabbPlane, 6> selected;
+    for (size_t p = 0; p < planes.size(); ++p)
+    {
+        const glm::vec4& plane = planes[p];
+        selected[p].plane_ = plane;
+        selected[p].x_ = plane.x >= 0.0f ? bounds.max_x_.data() : bounds.min_x_.data();
+        selected[p].y_ = plane.y >= 0.0f ? bounds.max_y_.data() : bounds.min_y_.data();
+        selected[p].z_ = plane.z >= 0.0f ? bounds.max_z_.data() : bounds.min_z_.data();
+    }
+    return selected;
+}
+
+// The scalar kernels also finish the tails of the SIMD ones, so the distance is evaluated in the
+// same order everywhere and every kernel agrees on objects touching a plane. Compaction is
+// branch free: the index is always stored and the slot reused when the object is culled.
+size_t CullSpheresScalar(const FrustumPlanes& planes, const SphereBounds& bounds, size_t begin, size_t end, uint32_t* visible)
+{
+    size_t visible_count = 0;
+    for (size_t i = begin; i < end; ++i)
+    {
+        float x = bounds.center_x_[i];
+        float y = bounds.center_y_[i];
+        float z = bounds.center_z_[i];
+        float r = bounds.radius_[i];
+
+        bool inside = true;
+        for (const glm::vec4& plane : planes)
+        {
+            inside &= plane.x * x + plane.y * y + plane.z * z + plane.w >= -r;
+        }
+
+        visible[visible_count] = static_cast<uint32_t>(i);
+        visible_count += inside ? 1 : 0;
+    }
+    return visible_count;
+}
+
+size_t CullAabbsScalar(const std::array<AabbPlane, 6>& planes, size_t begin, size_t end, uint32_t* visible)
+{
+    size_t visible_count = 0;
+    for (size_t i = begin; i < end; ++i)
+    {
+        bool inside = true;
+        for (const AabbPlane& plane : planes)
+        {
+            inside &= plane.plane_.x * plane.x_[i] + plane.plane_.y * plane.y_[i] + plane.plane_.z * plane.z_[i] + plane.plane_.w >= 0.0f;
+        }
+
+        visible[visible_count] = static_cast<uint32_t>(i);
+        visible_count += inside ? 1 : 0;
+    }
+    return visible_count;
+}
+
+#ifdef RENDERER_X86_CULL_KERNELS
+
+// lanes of every visibility mask, packed to the front: the permutation compacting 8 indices
+constexpr std::array<std::array<uint8_t, 8>, 256> MakeLanePermutations()
+{
+    std::array<std::array<uint8_t, 8>, 256> table{};
+    for (uint32_t mask = 0; mask < 256; ++mask)
+    {
+        uint32_t packed = 0;
+        for (uint8_t lane = 0; lane < 8; ++lane)
+        {
+            if (mask & (1u << lane))
+            {
+                table[mask][packed++] = lane;
+            }
+        }
+    }
+    return table;
+}
+
+// the same for 4 lanes of 32-bit indices, as byte shuffles
+constexpr std::array<std::array<uint8_t, 16>, 16> MakeLaneShuffles()
+{
+    std::array<std::array<uint8_t, 16>, 16> table{};
+    for (uint32_t mask = 0; mask < 16; ++mask)
+    {
+        uint32_t packed = 0;
+        for (uint8_t lane = 0; lane < 4; ++lane)
+        {
+            if (mask & (1u << lane))
+            {
+                for (uint8_t byte = 0; byte < 4; ++byte)
+                {
+                    table[mask][packed * 4 + byte] = static_cast<uint8_t>(lane * 4 + byte);
+                }
+                ++packed;
+            }
+        }
+        // unused lanes are zeroed, they are overwritten by the next store
+        for (uint32_t byte = packed * 4; byte < 16; ++byte)
+        {
+            table[mask][byte] = 0x80;
+        }
+    }
+    return table;
+}
+
+alignas(16) constexpr auto s_lane_permutations = MakeLanePermutations();
+alignas(16) constexpr auto s_lane_shuffles = MakeLaneShuffles();
+
+// ---- SSE4.1, 4 objects per instruction ---- //
+
+__attribute__((target("sse4.1")))
+inline size_t StoreVisibleSse41(__m128 inside, size_t first, uint32_t* visible)
+{
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(inside));
+    __m128i indices = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(first)), _mm_setr_epi32(0, 1, 2, 3));
+    __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(s_lane_shuffles[mask].data()));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(visible), _mm_shuffle_epi8(indices, shuffle));
+    return std::popcount(mask);
+}
+
+__attribute__((target("sse4.1")))
+size_t CullSpheresSse41(const FrustumPlanes& planes, const SphereBounds& bounds, uint32_t* visible)
+{
+    const size_t count = bounds.Size();
+    const size_t simd_end = count / 4 * 4;
+
+    __m128 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+    for (size_t p = 0; p < 6; ++p)
+    {
+        plane_x[p] = _mm_set1_ps(planes[p].x);
+        plane_y[p] = _mm_set1_ps(planes[p].y);
+        plane_z[p] = _mm_set1_ps(planes[p].z);
+        plane_w[p] = _mm_set1_ps(planes[p].w);
+    }
+
+    size_t visible_count = 0;
+    for (size_t i = 0; i < simd_end; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(bounds.center_x_.data() + i);
+        __m128 y = _mm_loadu_ps(bounds.center_y_.data() + i);
+        __m128 z = _mm_loadu_ps(bounds.center_z_.data() + i);
+        __m128 negative_r = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(bounds.radius_.data() + i));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (size_t p = 0; p < 6; ++p)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(plane_x[p], x), _mm_mul_ps(plane_y[p], y)), _mm_mul_ps(plane_z[p], z)), plane_w[p]);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negative_r));
+        }
+
+        visible_count += StoreVisibleSse41(inside, i, visible + visible_count);
+    }
+
+    return visible_count + CullSpheresScalar(planes, bounds, simd_end, count, visible + visible_count);
+}
+
+__attribute__((target("sse4.1")))
+size_t CullAabbsSse41(const std::array<AabbPlane, 6>& planes, size_t count, uint32_t* visible)
+{
+    const size_t simd_end = count / 4 * 4;
+
+    __m128 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+    for (size_t p = 0; p < 6; ++p)
+    {
+        plane_x[p] = _mm_set1_ps(planes[p].plane_.x);
+        plane_y[p] = _mm_set1_ps(planes[p].plane_.y);
+        plane_z[p] = _mm_set1_ps(planes[p].plane_.z);
+        plane_w[p] = _mm_set1_ps(planes[p].plane_.w);
+    }
+
+    size_t visible_count = 0;
+    for (size_t i = 0; i < simd_end; i += 4)
+    {
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (size_t p = 0; p < 6; ++p)
+        {
+            __m128 x = _mm_loadu_ps(planes[p].x_ + i);
+            __m128 y = _mm_loadu_ps(planes[p].y_ + i);
+            __m128 z = _mm_loadu_ps(planes[p].z_ + i);
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(plane_x[p], x), _mm_mul_ps(plane_y[p], y)), _mm_mul_ps(plane_z[p], z)), plane_w[p]);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+        }
+
+        visible_count += StoreVisibleSse41(inside, i, visible + visible_count);
+    }
+
+    return visible_count + CullAabbsScalar(planes, simd_end, count, visible + visible_count);
+}
+
+// ---- AVX2, 8 objects per instruction ---- //
+
+__attribute__((target("avx2")))
+inline size_t StoreVisibleAvx2(__m256 inside, size_t first, uint32_t* visible)
+{
+    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+    __m256i indices = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(first)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i permutation = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(s_lane_permutations[mask].data())));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(visible), _mm256_permutevar8x32_epi32(indices, permutation));
+    return std::popcount(mask);
+}
+
+__attribute__((target("avx2")))
+size_t CullSpheresAvx2(const FrustumPlanes& planes, const SphereBounds& bounds, uint32_t* visible)
+{
+    const size_t count = bounds.Size();
+    const size_t simd_end = count / 8 * 8;
+
+    __m256 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+    for (size_t p = 0; p < 6; ++p)
+    {
+        plane_x[p] = _mm256_set1_ps(planes[p].x);
+        plane_y[p] = _mm256_set1_ps(planes[p].y);
+        plane_z[p] = _mm256_set1_ps(planes[p].z);
+        plane_w[p] = _mm256_set1_ps(planes[p].w);
+    }
+
+    size_t visible_count = 0;
+    for (size_t i = 0; i < simd_end; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(bounds.center_x_.data() + i);
+        __m256 y = _mm256_loadu_ps(bounds.center_y_.data() + i);
+        __m256 z = _mm256_loadu_ps(bounds.center_z_.data() + i);
+        __m256 negative_r = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(bounds.radius_.data() + i));
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (size_t p = 0; p < 6; ++p)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(plane_x[p], x), _mm256_mul_ps(plane_y[p], y)), _mm256_mul_ps(plane_z[p], z)), plane_w[p]);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negative_r, _CMP_GE_OQ));
+        }
+
+        visible_count += StoreVisibleAvx2(inside, i, visible + visible_count);
+    }
+
+    return visible_count + CullSpheresScalar(planes, bounds, simd_end, count, visible + visible_count);
+}
+
+__attribute__((target("avx2")))
+size_t CullAabbsAvx2(const std::array<AabbPlane, 6>& planes, size_t count, uint32_t* visible)
+{
+    const size_t simd_end = count / 8 * 8;
+
+    __m256 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+    for (size_t p = 0; p < 6; ++p)
+    {
+        plane_x[p] = _mm256_set1_ps(planes[p].plane_.x);
+        plane_y[p] = _mm256_set1_ps(planes[p].plane_.y);
+        plane_z[p] = _mm256_set1_ps(planes[p].plane_.z);
+        plane_w[p] = _mm256_set1_ps(planes[p].plane_.w);
+    }
+
+    size_t visible_count = 0;
+    for (size_t i = 0; i < simd_end; i += 8)
+    {
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (size_t p = 0; p < 6; ++p)
+        {
+            __m256 x = _mm256_loadu_ps(planes[p].x_ + i);
+            __m256 y = _mm256_loadu_ps(planes[p].y_ + i);
+            __m256 z = _mm256_loadu_ps(planes[p].z_ + i);
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(plane_x[p], x), _mm256_mul_ps(plane_y[p], y)), _mm256_mul_ps(plane_z[p], z)), plane_w[p]);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+
+        visible_count += StoreVisibleAvx2(inside, i, visible + visible_count);
+    }
+
+    return visible_count + CullAabbsScalar(planes, simd_end, count, visible + visible_count);
+}
+
+#endif // RENDERER_X86_CULL_KERNELS
+
+} // namespace
+
+void SphereBounds::Add(const glm::vec4& sphere)
+{
+    center_x_.push_back(sphere.x);
+    center_y_.push_back(sphere.y);
+    center_z_.push_back(sphere.z);
+    radius_.push_back(sphere.w);
+}
+
+void SphereBounds::Reserve(size_t count)
+{
+    center_x_.reserve(count);
+    center_y_.reserve(count);
+    center_z_.reserve(count);
+    radius_.reserve(count);
+}
+
+void SphereBounds::Clear()
+{
+    center_x_.clear();
+    center_y_.clear();
+    center_z_.clear();
+    radius_.clear();
+}
+
+void AabbBounds::Add(const glm::vec3& min, const glm::vec3& max)
+{
+    min_x_.push_back(min.x);
+    min_y_.push_back(min.y);
+    min_z_.push_back(min.z);
+    max_x_.push_back(max.x);
+    max_y_.push_back(max.y);
+    max_z_.push_back(max.z);
+}
+
+void AabbBounds::Reserve(size_t count)
+{
+    min_x_.reserve(count);
+    min_y_.reserve(count);
+    min_z_.reserve(count);
+    max_x_.reserve(count);
+    max_y_.reserve(count);
+    max_z_.reserve(count);
+}
+
+void AabbBounds::Clear()
+{
+    min_x_.clear();
+    min_y_.clear();
+    min_z_.clear();
+    max_x_.clear();
+    max_y_.clear();
+    max_z_.clear();
+}
+
+const char* ToString(CullKernel kernel)
+{
+    switch (kernel)
+    {
+    case CullKernel::Scalar:
+        return "scalar";
+    case CullKernel::Sse41:
+        return "SSE4.1";
+    case CullKernel::Avx2:
+        return "AVX2";
+    }
+    return "unknown";
+}
+
+bool IsCullKernelSupported(CullKernel kernel)
+{
+    switch (kernel)
+    {
+    case CullKernel::Scalar:
+        return true;
+#ifdef RENDERER_X86_CULL_KERNELS
+    case CullKernel::Sse41:
+        return __builtin_cpu_supports("sse4.1");
+    case CullKernel::Avx2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+CullKernel GetBestCullKernel()
+{
+    static const CullKernel s_best_kernel = []()
+    {
+        for (CullKernel kernel : {CullKernel::Avx2, CullKernel::Sse41})
+        {
+            if (IsCullKernelSupported(kernel))
+            {
+                return kernel;
+            }
+        }
+        return CullKernel::Scalar;
+    }();
+    return s_best_kernel;
+}
+
+std::span<const uint32_t> CullSpheres(const FrustumPlanes& planes, const SphereBounds& bounds, std::vector<uint32_t>& storage, CullKernel kernel)
+{
+    const size_t count = bounds.Size();
+    if (storage.size() < count + s_max_lanes)
+    {
+        storage.resize(count + s_max_lanes);
+    }
+
+    if (!IsCullKernelSupported(kernel))
+    {
+        kernel = CullKernel::Scalar;
+    }
+
+    size_t visible_count = 0;
+    switch (kernel)
+    {
+#ifdef RENDERER_X86_CULL_KERNELS
+    case CullKernel::Avx2:
+        visible_count = CullSpheresAvx2(planes, bounds, storage.data());
+        break;
+    case CullKernel::Sse41:
+        visible_count = CullSpheresSse41(planes, bounds, storage.data());
+        break;
+#endif
+    default:
+        visible_count = CullSpheresScalar(planes, bounds, 0, count, storage.data());
+        break;
+    }
+
+    return std::span<const uint32_t>(storage.data(), visible_count);
+}
+
+std::span<const uint32_t> CullAabbs(const FrustumPlanes& planes, const AabbBounds& bounds, std::vector<uint32_t>& storage, CullKernel kernel)
+{
+    const size_t count = bounds.Size();
+    if (storage.size() < count + s_max_lanes)
+    {
+        storage.resize(count + s_max_lanes);
+    }
+
+    if (!IsCullKernelSupported(kernel))
+    {
+        kernel = CullKernel::Scalar;
+    }
+
+    std::array<AabbPlane, 6> selected = SelectPositiveCorners(planes, bounds);
+
+    size_t visible_count = 0;
+    switch (kernel)
+    {
+#ifdef RENDERER_X86_CULL_KERNELS
+    case CullKernel::Avx2:
+        visible_count = CullAabbsAvx2(selected, count, storage.data());
+        break;
+    case CullKernel::Sse41:
+        visible_count = CullAabbsSse41(selected, count, storage.data());
+        break;
+#endif
+    default:
+        visible_count = CullAabbsScalar(selected, 0, count, storage.data());
+        break;
+    }
+
+    return std::span<const uint32_t>(storage.data(), visible_count);
+}
+
+} // namespace renderer
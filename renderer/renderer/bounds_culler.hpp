@@ -0,0 +1,74 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// glm
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// renderer includes
+#include <renderer/renderer/frustum.hpp>
+
+namespace renderer {
+
+// Scene bounds as structures of arrays, a kernel lane reads one object's field from each stream
+struct SphereBounds
+{
+    std::vector<float> center_x_;
+    std::vector<float> center_y_;
+    std::vector<float> center_z_;
+    std::vector<float> radius_;
+
+    // (center, radius)
+    void Add(const glm::vec4& sphere);
+    void Reserve(size_t count);
+    void Clear();
+    size_t Size() const { return radius_.size(); }
+};
+
+struct AabbBounds
+{
+    std::vector<float> min_x_;
+    std::vector<float> min_y_;
+    std::vector<float> min_z_;
+    std::vector<float> max_x_;
+    std::vector<float> max_y_;
+    std::vector<float> max_z_;
+
+    void Add(const glm::vec3& min, const glm::vec3& max);
+    void Reserve(size_t count);
+    void Clear();
+    size_t Size() const { return min_x_.size(); }
+};
+
+enum class CullKernel
+{
+    Scalar,  // one object per iteration, any CPU
+    Sse41,   // 4 objects per instruction
+    Avx2,    // 8 objects per instruction
+};
+
+const char* ToString(CullKernel kernel);
+bool IsCullKernelSupported(CullKernel kernel);
+// widest kernel the CPU runs, detected once
+CullKernel GetBestCullKernel();
+
+// Frustum culling of scene bounds on the CPU. planes come from ExtractFrustumPlanes, e.g. of
+// Camera::GetProjMatrix() * GetViewMatrix() for world space bounds. Returns the indices of the
+// bounds touching the frustum in ascending order, a view into storage. storage only grows, so
+// reusing it between frames allocates nothing. Bounds straddling a plane count as visible. Every
+// kernel gives the same result, unsupported kernels fall back to the scalar one.
+std::span<const uint32_t> CullSpheres(const FrustumPlanes& planes,
+                                      const SphereBounds& bounds,
+                                      std::vector<uint32_t>& storage,
+                                      CullKernel kernel = GetBestCullKernel());
+std::span<const uint32_t> CullAabbs(const FrustumPlanes& planes,
+                                    const AabbBounds& bounds,
+                                    std::vector<uint32_t>& storage,
+                                    CullKernel kernel = GetBestCullKernel());
+
+} // namespace renderer
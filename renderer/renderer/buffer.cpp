@@ -13,61 +13,66 @@ Buffer::Buffer(Device& device,
         VkDeviceSize instance_size, 
         uint32_t instance_count,
         VkBufferUsageFlags usage, 
-        VkMemoryPropertyFlags properties)
+        VkMemoryPropertyFlags properties,
+        VkSharingMode sharing_mode)
         : device_{device}
         , instance_size_{instance_size}
         , instance_count_{instance_count}
 {
     buffer_size_ = instance_count_ * instance_size_;
-    CreateBuffer(buffer_size_, usage, properties);
+    CreateBuffer(buffer_size_, usage, properties, sharing_mode);
 }
 
 Buffer::~Buffer()
 {
     Unmap();
-    vkDestroyBuffer(device_.GetDevice(), buffer_, nullptr);
-    vkFreeMemory(device_.GetDevice(), memory_, nullptr);
+
+    // in flight frames may still read the buffer
+    device_.Retire([device = device_.GetDevice(), buffer = buffer_, allocation = allocation_, &allocator = device_.GetAllocator()]() mutable
+    {
+        vkDestroyBuffer(device, buffer, nullptr);
+        allocator.Free(allocation);
+    });
 }
 
-VkResult Buffer::Map(VkDeviceSize size, VkDeviceSize offset)
+VkResult Buffer::Map([[maybe_unused]] VkDeviceSize size, VkDeviceSize offset)
 {
-    return vkMapMemory(device_.GetDevice(), memory_, offset, size, 0, &mapped_);
+    // host visible blocks stay mapped for their whole lifetime, mapping only hands out the
+    // pointer, so size has nothing left to limit
+    if (allocation_.mapped_ == nullptr)
+    {
+        return VK_ERROR_MEMORY_MAP_FAILED;
+    }
+
+    mapped_ = static_cast<char*>(allocation_.mapped_) + offset;
+    return VK_SUCCESS;
 }
 
 void Buffer::Unmap()
 {
-    if (mapped_)
-    {
-        vkUnmapMemory(device_.GetDevice(), memory_);
-        mapped_ = nullptr;
-    }
+    mapped_ = nullptr;
 }
 
-void Buffer::WriteToBuffer(void* data, VkDeviceSize size, VkDeviceSize offset)
+void Buffer::WriteToBuffer(const void* data, VkDeviceSize size, VkDeviceSize offset)
 {
     assert(mapped_ && "Cannot copy to unmapped buffer");
 
     if (size == VK_WHOLE_SIZE)
     {
-        std::memcpy(mapped_, data, buffer_size_);
+        size = buffer_size_ - offset;
     }
-    else
+
+    if (offset + size > buffer_size_)
     {
-        char* mem_offset = reinterpret_cast<char*>(mapped_);
-        mem_offset += offset;
-        std::memcpy(mem_offset, data, size);
+        throw std::out_of_range("Buffer write out of range!");
     }
+
+    std::memcpy(static_cast<char*>(mapped_) + offset, data, size);
 }
 
 VkResult Buffer::Flush(VkDeviceSize size, VkDeviceSize offset)
 {
-    VkMappedMemoryRange mapped_range = {};
-    mapped_range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-    mapped_range.memory = memory_;
-    mapped_range.offset = offset;
-    mapped_range.size = size;
-
-    return vkFlushMappedMemoryRanges(device_.GetDevice(), 1, &mapped_range);
+    return device_.GetAllocator().Flush(allocation_, size, offset);
 }
 
 VkDescriptorBufferInfo Buffer::DescriptorInfo(VkDeviceSize size, VkDeviceSize offset)
@@ -80,7 +85,7 @@ VkDescriptorBufferInfo Buffer::DescriptorInfo(VkDeviceSize size, VkDeviceSize of
 }
 
 
-void Buffer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+void Buffer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkSharingMode sharing_mode)
 {
     VkBufferCreateInfo buffer_info{};
     buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -88,6 +93,16 @@ void Buffer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryP
     buffer_info.usage = usage;
     buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+    // concurrent sharing only means something with a dedicated transfer family
+    uint32_t families[] = {device_.GetGraphicsFamily(), device_.GetTransferFamily()};
+    if (sharing_mode == VK_SHARING_MODE_CONCURRENT && families[0] != families[1])
+    {
+        buffer_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        buffer_info.queueFamilyIndexCount = 2;
+        buffer_info.pQueueFamilyIndices = families;
+        concurrent_ = true;
+    }
+
     if (vkCreateBuffer(device_.GetDevice(), &buffer_info, nullptr, &buffer_) != VK_SUCCESS)
     {
         throw std::runtime_error("Failed to create buffer!");
@@ -96,35 +111,9 @@ void Buffer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryP
     VkMemoryRequirements mem_requirements;
     vkGetBufferMemoryRequirements(device_.GetDevice(), buffer_, &mem_requirements);
 
-    VkMemoryAllocateInfo alloc_info{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    alloc_info.allocationSize = mem_requirements.size;
-    alloc_info.memoryTypeIndex = FindMemoryType(mem_requirements.memoryTypeBits, properties);
-
-    if (vkAllocateMemory(device_.GetDevice(), &alloc_info, nullptr, &memory_) != VK_SUCCESS)
-    {
-        throw std::runtime_error("Failed to allocate buffer memory!");
-    }
-
-    vkBindBufferMemory(device_.GetDevice(), buffer_, memory_, 0);
-}
+    allocation_ = device_.GetAllocator().Allocate(mem_requirements, properties, AllocationKind::Linear);
 
-uint32_t Buffer::FindMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties)
-{
-    VkPhysicalDeviceMemoryProperties mem_properties;
-    vkGetPhysicalDeviceMemoryProperties(device_.GetPhysicalDevice(), &mem_properties);
-    
-    std::cout << "mem_properties.memoryTypeCount=" << mem_properties.memoryTypeCount << std::endl;
-    std::cout << "type_filter=" << type_filter << std::endl;
-    for (uint32_t i = 0; i < mem_properties.memoryTypeCount; ++i)
-    {
-        if ((type_filter & (1 << i)) && (mem_properties.memoryTypes[i].propertyFlags & properties) == properties)
-        {
-            return i;
-        }
-    }
-    
-    throw std::runtime_error("Failed to find suitable memory type!");
+    vkBindBufferMemory(device_.GetDevice(), buffer_, allocation_.memory_, allocation_.offset_);
 }
 
 
@@ -18,31 +18,45 @@ public:
            VkDeviceSize instance_size,
            uint32_t  instance_count,
            VkBufferUsageFlags usage, 
-           VkMemoryPropertyFlags properties);
+           VkMemoryPropertyFlags properties,
+           VkSharingMode sharing_mode = VK_SHARING_MODE_EXCLUSIVE);
 
-    ~Buffer();
+    // TypedBuffer<T> instances are owned through Buffer pointers
+    virtual ~Buffer();
 
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+
+    // the whole block stays mapped, size is kept for the call sites and ignored
     VkResult Map(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
     void Unmap();
-    void WriteToBuffer(void* data, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+    // VK_WHOLE_SIZE reads the remaining buffer size from data, prefer TypedBuffer::Write
+    void WriteToBuffer(const void* data, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
     VkResult Flush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
     // Getters
 
     VkBuffer GetBuffer() { return buffer_; }
+    void* GetMappedMemory(VkDeviceSize offset = 0) { return static_cast<char*>(mapped_) + offset; }
     uint32_t GetInstanceCount() { return instance_count_; }
+    VkDeviceSize GetSize() { return buffer_size_; }
+    // shared by the graphics and transfer families, uploads need no ownership transfer
+    bool IsConcurrent() { return concurrent_; }
     VkDescriptorBufferInfo DescriptorInfo(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+protected:
+    Device& GetDevice() { return device_; }
+
 private:
-    void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
-    uint32_t FindMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties);
+    void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkSharingMode sharing_mode);
 
 private:
     Device& device_;
 
     VkBuffer buffer_;
-    VkDeviceMemory memory_;
+    Allocation allocation_;
     VkDeviceSize buffer_size_;
     VkDeviceSize instance_size_;
     uint32_t instance_count_;
+    bool concurrent_ = false;
 
 
     void* mapped_ = nullptr;
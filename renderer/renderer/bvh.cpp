@@ -0,0 +1,573 @@
+#include <renderer/renderer/bvh.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace renderer {
+
+namespace {
+
+// cost of visiting an inner node relative to testing one object
+constexpr float s_traversal_cost = 1.0f;
+
+// entry distance of the ray into box, clamped to 0 for rays starting inside; infinity on a miss
+float IntersectRay(const Aabb& box, const glm::vec3& origin, const glm::vec3& inverse_direction, float max_distance)
+{
+    glm::vec3 t0 = (box.min_ - origin) * inverse_direction;
+    glm::vec3 t1 = (box.max_ - origin) * inverse_direction;
+    glm::vec3 t_near = glm::min(t0, t1);
+    glm::vec3 t_far = glm::max(t0, t1);
+
+    float enter = std::max(std::max(t_near.x, t_near.y), std::max(t_near.z, 0.0f));
+    float exit = std::min(std::min(t_far.x, t_far.y), std::min(t_far.z, max_distance));
+    return enter <= exit ? enter : std::numeric_limits<float>::infinity();
+}
+
+} // namespace
+
+// =================== Aabb =================== //
+void Aabb::Grow(const glm::vec3& point)
+{
+    min_ = glm::min(min_, point);
+    max_ = glm::max(max_, point);
+}
+
+void Aabb::Grow(const Aabb& box)
+{
+    min_ = glm::min(min_, box.min_);
+    max_ = glm::max(max_, box.max_);
+}
+
+float Aabb::GetSurfaceArea() const
+{
+    if (IsEmpty())
+    {
+        return 0.0f;
+    }
+    glm::vec3 size = max_ - min_;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+Aabb Aabb::FromSphere(const glm::vec4& sphere)
+{
+    glm::vec3 center(sphere);
+    return Aabb{center - glm::vec3(sphere.w), center + glm::vec3(sphere.w)};
+}
+
+Aabb Aabb::Transform(const Aabb& box, const glm::mat4& matrix)
+{
+    if (box.IsEmpty())
+    {
+        return box;
+    }
+
+    // center and half extents, the extents go through the absolute linear part
+    glm::vec3 center = glm::vec3(matrix * glm::vec4(box.GetCenter(), 1.0f));
+    glm::vec3 half_extent = (box.max_ - box.min_) * 0.5f;
+    glm::vec3 extent(0.0f);
+    for (int column = 0; column < 3; ++column)
+    {
+        extent += glm::abs(glm::vec3(matrix[column])) * half_extent[column];
+    }
+    return Aabb{center - extent, center + extent};
+}
+
+Ray ScreenPointToRay(const glm::vec2& pixel, const glm::vec2& window_size, const glm::mat4& view_projection)
+{
+    // Vulkan NDC: y points down like window coordinates, the near plane is at z = 0
+    glm::vec2 ndc = pixel / window_size * 2.0f - 1.0f;
+    glm::mat4 inverse = glm::inverse(view_projection);
+
+    glm::vec4 near_point = inverse * glm::vec4(ndc.x, ndc.y, 0.0f, 1.0f);
+    glm::vec4 far_point = inverse * glm::vec4(ndc.x, ndc.y, 1.0f, 1.0f);
+    glm::vec3 origin = glm::vec3(near_point) / near_point.w;
+    glm::vec3 target = glm::vec3(far_point) / far_point.w;
+
+    return Ray{origin, glm::normalize(target - origin)};
+}
+
+// =================== Bvh =================== //
+Bvh::Bvh(const BvhSettings& settings)
+    : settings_{settings}
+{
+    if (settings_.bin_count_ < 2 || settings_.max_leaf_size_ == 0)
+    {
+        throw std::runtime_error("BVH needs at least 2 bins and leaves of at least 1 object");
+    }
+}
+
+void Bvh::Build(std::span<const Aabb> bounds)
+{
+    nodes_.clear();
+    free_pairs_.clear();
+    has_dirty_ = false;
+
+    object_bounds_.assign(bounds.begin(), bounds.end());
+    object_centers_.resize(object_bounds_.size());
+    for (size_t i = 0; i < object_bounds_.size(); ++i)
+    {
+        object_centers_[i] = object_bounds_[i].GetCenter();
+    }
+    object_indices_.resize(object_bounds_.size());
+    std::iota(object_indices_.begin(), object_indices_.end(), 0u);
+    object_leaves_.assign(object_bounds_.size(), s_invalid_node_);
+
+    if (object_bounds_.empty())
+    {
+        return;
+    }
+
+    Node root{};
+    root.object_count_ = GetObjectCount();
+    nodes_.push_back(root);
+    BuildNode(0);
+}
+
+void Bvh::BuildNode(uint32_t root)
+{
+    const uint32_t bin_count = settings_.bin_count_;
+    std::vector<Aabb> bin_bounds(bin_count);
+    std::vector<uint32_t> bin_counts(bin_count);
+    std::vector<float> right_areas(bin_count);
+    std::vector<uint32_t> right_counts(bin_count);
+
+    std::vector<uint32_t> stack = {root};
+    while (!stack.empty())
+    {
+        uint32_t node = stack.back();
+        stack.pop_back();
+
+        // nodes_ may grow below, index instead of holding references
+        const uint32_t first = nodes_[node].first_object_;
+        const uint32_t count = nodes_[node].object_count_;
+
+        Aabb bounds;
+        Aabb centroid_bounds;
+        for (uint32_t i = first; i < first + count; ++i)
+        {
+            bounds.Grow(object_bounds_[object_indices_[i]]);
+            centroid_bounds.Grow(object_centers_[object_indices_[i]]);
+        }
+        nodes_[node].bounds_ = bounds;
+        nodes_[node].build_area_ = bounds.GetSurfaceArea();
+        nodes_[node].left_ = s_invalid_node_;
+        nodes_[node].dirty_ = false;
+
+        // binned SAH over every axis, costs relative to the node's area
+        float best_cost = std::numeric_limits<float>::max();
+        int best_axis = -1;
+        uint32_t best_split = 0;
+        float area = std::max(bounds.GetSurfaceArea(), std::numeric_limits<float>::min());
+
+        glm::vec3 extent = centroid_bounds.max_ - centroid_bounds.min_;
+        for (int axis = 0; count > 1 && axis < 3; ++axis)
+        {
+            if (extent[axis] <= 0.0f)
+            {
+                continue;
+            }
+            float scale = static_cast<float>(bin_count) / extent[axis];
+
+            std::fill(bin_bounds.begin(), bin_bounds.end(), Aabb{});
+            std::fill(bin_counts.begin(), bin_counts.end(), 0u);
+            for (uint32_t i = first; i < first + count; ++i)
+            {
+                uint32_t object = object_indices_[i];
+                uint32_t bin = std::min(static_cast<uint32_t>((object_centers_[object][axis] - centroid_bounds.min_[axis]) * scale), bin_count - 1);
+                bin_bounds[bin].Grow(object_bounds_[object]);
+                ++bin_counts[bin];
+            }
+
+            // sweep from the right, then evaluate every split from the left
+            Aabb right;
+            uint32_t right_count = 0;
+            for (uint32_t bin = bin_count - 1; bin > 0; --bin)
+            {
+                right.Grow(bin_bounds[bin]);
+                right_count += bin_counts[bin];
+                right_areas[bin] = right.GetSurfaceArea();
+                right_counts[bin] = right_count;
+            }
+
+            Aabb left;
+            uint32_t left_count = 0;
+            for (uint32_t split = 1; split < bin_count; ++split)
+            {
+                left.Grow(bin_bounds[split - 1]);
+                left_count += bin_counts[split - 1];
+                if (left_count == 0 || right_counts[split] == 0)
+                {
+                    continue;
+                }
+
+                float cost = s_traversal_cost + (left.GetSurfaceArea() * left_count + right_areas[split] * right_counts[split]) / area;
+                if (cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_split = split;
+                }
+            }
+        }
+
+        bool fits_leaf = count <= settings_.max_leaf_size_;
+        if (count == 1 || (fits_leaf && static_cast<float>(count) <= best_cost))
+        {
+            for (uint32_t i = first; i < first + count; ++i)
+            {
+                object_leaves_[object_indices_[i]] = node;
+            }
+            continue;
+        }
+
+        uint32_t* range_begin = object_indices_.data() + first;
+        uint32_t* range_end = range_begin + count;
+        uint32_t left_count = count / 2;
+        if (best_axis >= 0)
+        {
+            float scale = static_cast<float>(bin_count) / extent[best_axis];
+            float min = centroid_bounds.min_[best_axis];
+            uint32_t* middle = std::partition(range_begin, range_end, [&](uint32_t object)
+            {
+                return std::min(static_cast<uint32_t>((object_centers_[object][best_axis] - min) * scale), bin_count - 1) < best_split;
+            });
+            left_count = static_cast<uint32_t>(middle - range_begin);
+        }
+        else
+        {
+            // coincident centroids, too many for one leaf: halve the range
+            left_count = count / 2;
+        }
+
+        uint32_t left = AllocatePair();
+        nodes_[node].left_ = left;
+        for (uint32_t child = 0; child < 2; ++child)
+        {
+            Node& child_node = nodes_[left + child];
+            child_node = Node{};
+            child_node.first_object_ = child == 0 ? first : first + left_count;
+            child_node.object_count_ = child == 0 ? left_count : count - left_count;
+            child_node.parent_ = node;
+            stack.push_back(left + child);
+        }
+    }
+}
+
+uint32_t Bvh::AllocatePair()
+{
+    if (!free_pairs_.empty())
+    {
+        uint32_t pair = free_pairs_.back();
+        free_pairs_.pop_back();
+        return pair;
+    }
+
+    uint32_t pair = static_cast<uint32_t>(nodes_.size());
+    nodes_.resize(nodes_.size() + 2);
+    return pair;
+}
+
+void Bvh::FreeChildren(uint32_t node)
+{
+    std::vector<uint32_t> stack = {node};
+    while (!stack.empty())
+    {
+        uint32_t current = stack.back();
+        stack.pop_back();
+
+        uint32_t left = nodes_[current].left_;
+        if (left == s_invalid_node_)
+        {
+            continue;
+        }
+        nodes_[current].left_ = s_invalid_node_;
+        free_pairs_.push_back(left);
+        stack.push_back(left);
+        stack.push_back(left + 1);
+    }
+}
+
+void Bvh::UpdateObject(uint32_t object, const Aabb& bounds)
+{
+    object_bounds_.at(object) = bounds;
+    object_centers_[object] = bounds.GetCenter();
+
+    // mark the path to the root, up to the first node already marked
+    for (uint32_t node = object_leaves_[object]; node != s_invalid_node_ && !nodes_[node].dirty_; node = nodes_[node].parent_)
+    {
+        nodes_[node].dirty_ = true;
+    }
+    has_dirty_ = true;
+}
+
+BvhRefitStats Bvh::Refit()
+{
+    BvhRefitStats stats{};
+    if (!has_dirty_ || nodes_.empty())
+    {
+        return stats;
+    }
+
+    RefitNode(0, stats);
+    RebuildDegraded(0, stats);
+    has_dirty_ = false;
+    return stats;
+}
+
+void Bvh::RefitNode(uint32_t node, BvhRefitStats& stats)
+{
+    if (!nodes_[node].dirty_)
+    {
+        return;
+    }
+
+    Aabb bounds;
+    if (nodes_[node].IsLeaf())
+    {
+        for (uint32_t i = nodes_[node].first_object_; i < nodes_[node].first_object_ + nodes_[node].object_count_; ++i)
+        {
+            bounds.Grow(object_bounds_[object_indices_[i]]);
+        }
+    }
+    else
+    {
+        uint32_t left = nodes_[node].left_;
+        RefitNode(left, stats);
+        RefitNode(left + 1, stats);
+        bounds = nodes_[left].bounds_;
+        bounds.Grow(nodes_[left + 1].bounds_);
+    }
+
+    nodes_[node].bounds_ = bounds;
+    ++stats.nodes_refit_;
+}
+
+void Bvh::RebuildDegraded(uint32_t node, BvhRefitStats& stats)
+{
+    if (!nodes_[node].dirty_)
+    {
+        return;
+    }
+
+    // topmost degraded subtree only, its rebuild covers every node below
+    const Node& current = nodes_[node];
+    if (current.object_count_ > 1 && current.bounds_.GetSurfaceArea() > settings_.rebuild_area_ratio_ * current.build_area_)
+    {
+        FreeChildren(node);
+        BuildNode(node);
+        ++stats.subtrees_rebuilt_;
+        stats.objects_rebuilt_ += nodes_[node].object_count_;
+        return;
+    }
+
+    if (!current.IsLeaf())
+    {
+        uint32_t left = current.left_;
+        RebuildDegraded(left, stats);
+        RebuildDegraded(left + 1, stats);
+    }
+    nodes_[node].dirty_ = false;
+}
+
+BvhCullStats Bvh::Cull(const FrustumPlanes& planes, std::vector<uint32_t>& visible) const
+{
+    BvhCullStats stats{};
+    visible.clear();
+    if (nodes_.empty())
+    {
+        return stats;
+    }
+
+    // planes the box is not yet known to be inside of
+    constexpr uint32_t s_all_planes = (1u << 6) - 1;
+    auto classify = [&planes](const Aabb& box, uint32_t& plane_mask)
+    {
+        for (uint32_t p = 0; p < 6; ++p)
+        {
+            if (!(plane_mask & (1u << p)))
+            {
+                continue;
+            }
+            const glm::vec4& plane = planes[p];
+            glm::vec3 positive(plane.x >= 0.0f ? box.max_.x : box.min_.x,
+                               plane.y >= 0.0f ? box.max_.y : box.min_.y,
+                               plane.z >= 0.0f ? box.max_.z : box.min_.z);
+            glm::vec3 negative(plane.x >= 0.0f ? box.min_.x : box.max_.x,
+                               plane.y >= 0.0f ? box.min_.y : box.max_.y,
+                               plane.z >= 0.0f ? box.min_.z : box.max_.z);
+            if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f)
+            {
+                return false;
+            }
+            if (glm::dot(glm::vec3(plane), negative) + plane.w >= 0.0f)
+            {
+                plane_mask &= ~(1u << p);
+            }
+        }
+        return true;
+    };
+
+    struct Entry
+    {
+        uint32_t node_;
+        uint32_t plane_mask_;
+    };
+    std::vector<Entry> stack = {{0, s_all_planes}};
+    while (!stack.empty())
+    {
+        Entry entry = stack.back();
+        stack.pop_back();
+        ++stats.nodes_visited_;
+
+        const Node& node = nodes_[entry.node_];
+        uint32_t plane_mask = entry.plane_mask_;
+        if (!classify(node.bounds_, plane_mask))
+        {
+            continue;
+        }
+
+        const uint32_t* objects = object_indices_.data() + node.first_object_;
+        if (plane_mask == 0)
+        {
+            // inside every plane: the whole contiguous range, no test below this node
+            visible.insert(visible.end(), objects, objects + node.object_count_);
+            ++stats.subtrees_inside_;
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            for (uint32_t i = 0; i < node.object_count_; ++i)
+            {
+                uint32_t object_mask = plane_mask;
+                ++stats.objects_tested_;
+                if (classify(object_bounds_[objects[i]], object_mask))
+                {
+                    visible.push_back(objects[i]);
+                }
+            }
+            continue;
+        }
+
+        stack.push_back({node.left_, plane_mask});
+        stack.push_back({node.left_ + 1, plane_mask});
+    }
+
+    return stats;
+}
+
+RayHit Bvh::Raycast(const Ray& ray, float max_distance) const
+{
+    RayHit hit{};
+    hit.distance_ = max_distance;
+    if (nodes_.empty())
+    {
+        return hit;
+    }
+
+    glm::vec3 inverse_direction = 1.0f / ray.direction_;
+    if (IntersectRay(nodes_[0].bounds_, ray.origin_, inverse_direction, hit.distance_) == std::numeric_limits<float>::infinity())
+    {
+        return hit;
+    }
+
+    std::vector<uint32_t> stack = {0};
+    while (!stack.empty())
+    {
+        const Node& node = nodes_[stack.back()];
+        stack.pop_back();
+
+        if (node.IsLeaf())
+        {
+            for (uint32_t i = node.first_object_; i < node.first_object_ + node.object_count_; ++i)
+            {
+                uint32_t object = object_indices_[i];
+                float distance = IntersectRay(object_bounds_[object], ray.origin_, inverse_direction, hit.distance_);
+                if (distance < hit.distance_ || (distance == hit.distance_ && !hit.IsHit()))
+                {
+                    hit.object_ = object;
+                    hit.distance_ = distance;
+                }
+            }
+            continue;
+        }
+
+        // nearer child on top of the stack, children beyond the closest hit are skipped
+        float left_distance = IntersectRay(nodes_[node.left_].bounds_, ray.origin_, inverse_direction, hit.distance_);
+        float right_distance = IntersectRay(nodes_[node.left_ + 1].bounds_, ray.origin_, inverse_direction, hit.distance_);
+        uint32_t near_child = left_distance <= right_distance ? node.left_ : node.left_ + 1;
+        uint32_t far_child = left_distance <= right_distance ? node.left_ + 1 : node.left_;
+        float far_distance = std::max(left_distance, right_distance);
+        float near_distance = std::min(left_distance, right_distance);
+
+        if (far_distance != std::numeric_limits<float>::infinity())
+        {
+            stack.push_back(far_child);
+        }
+        if (near_distance != std::numeric_limits<float>::infinity())
+        {
+            stack.push_back(near_child);
+        }
+    }
+
+    if (!hit.IsHit())
+    {
+        hit.distance_ = std::numeric_limits<float>::max();
+    }
+    return hit;
+}
+
+uint32_t Bvh::GetDepth() const
+{
+    if (nodes_.empty())
+    {
+        return 0;
+    }
+
+    uint32_t depth = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> stack = {{0, 1}};
+    while (!stack.empty())
+    {
+        auto [node, node_depth] = stack.back();
+        stack.pop_back();
+        depth = std::max(depth, node_depth);
+        if (!nodes_[node].IsLeaf())
+        {
+            stack.push_back({nodes_[node].left_, node_depth + 1});
+            stack.push_back({nodes_[node].left_ + 1, node_depth + 1});
+        }
+    }
+    return depth;
+}
+
+float Bvh::GetSahCost() const
+{
+    if (nodes_.empty())
+    {
+        return 0.0f;
+    }
+
+    float cost = 0.0f;
+    std::vector<uint32_t> stack = {0};
+    while (!stack.empty())
+    {
+        const Node& node = nodes_[stack.back()];
+        stack.pop_back();
+        if (node.IsLeaf())
+        {
+            cost += node.bounds_.GetSurfaceArea() * node.object_count_;
+            continue;
+        }
+        cost += s_traversal_cost * node.bounds_.GetSurfaceArea();
+        stack.push_back(node.left_);
+        stack.push_back(node.left_ + 1);
+    }
+
+    float single_leaf = nodes_[0].bounds_.GetSurfaceArea() * GetObjectCount();
+    return single_leaf > 0.0f ? cost / single_leaf : 0.0f;
+}
+
+} // namespace renderer
@@ -0,0 +1,156 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+// glm
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// renderer includes
+#include <renderer/renderer/frustum.hpp>
+
+namespace renderer {
+
+struct Aabb
+{
+    glm::vec3 min_{std::numeric_limits<float>::max()};
+    glm::vec3 max_{std::numeric_limits<float>::lowest()};
+
+    void Grow(const glm::vec3& point);
+    void Grow(const Aabb& box);
+    bool IsEmpty() const { return min_.x > max_.x; }
+    glm::vec3 GetCenter() const { return (min_ + max_) * 0.5f; }
+    // 0 for empty boxes
+    float GetSurfaceArea() const;
+
+    // box of a (center, radius) sphere
+    static Aabb FromSphere(const glm::vec4& sphere);
+    // box around box transformed by matrix, e.g. an object's world bounds
+    static Aabb Transform(const Aabb& box, const glm::mat4& matrix);
+};
+
+struct Ray
+{
+    glm::vec3 origin_;
+    // normalized
+    glm::vec3 direction_;
+};
+
+// World space ray through a window pixel (origin at the top left), starting at the near plane.
+// view_projection is the Vulkan clip space matrix of Camera::GetProjMatrix() * GetViewMatrix()
+Ray ScreenPointToRay(const glm::vec2& pixel, const glm::vec2& window_size, const glm::mat4& view_projection);
+
+struct RayHit
+{
+    static constexpr uint32_t s_no_object_ = UINT32_MAX;
+
+    uint32_t object_ = s_no_object_;
+    float distance_ = std::numeric_limits<float>::max();
+
+    bool IsHit() const { return object_ != s_no_object_; }
+};
+
+struct BvhSettings
+{
+    // SAH candidates per axis
+    uint32_t bin_count_ = 16;
+    uint32_t max_leaf_size_ = 4;
+    // Refit rebuilds the topmost subtrees whose surface area grew by this factor since their build
+    float rebuild_area_ratio_ = 2.0f;
+};
+
+struct BvhCullStats
+{
+    uint32_t nodes_visited_ = 0;
+    // subtrees accepted without visiting their children
+    uint32_t subtrees_inside_ = 0;
+    uint32_t objects_tested_ = 0;
+};
+
+struct BvhRefitStats
+{
+    uint32_t nodes_refit_ = 0;
+    uint32_t subtrees_rebuilt_ = 0;
+    uint32_t objects_rebuilt_ = 0;
+};
+
+// Bounding volume hierarchy over scene object bounds, object ids are indices into the bounds
+// passed to Build. Built top down with a binned surface area heuristic. Moving objects are
+// handled with UpdateObject followed by Refit, which only touches the paths above moved objects
+// and rebuilds the subtrees the movement degraded. Frustum culling accepts subtrees entirely
+// inside the frustum without visiting them, ray queries visit the nearer child first, so both
+// scale with the depth of the tree rather than the object count.
+class Bvh
+{
+public:
+    Bvh(const BvhSettings& settings = BvhSettings{});
+
+    Bvh(const Bvh&) = delete;
+    Bvh& operator=(const Bvh&) = delete;
+
+    void Build(std::span<const Aabb> bounds);
+
+    void UpdateObject(uint32_t object, const Aabb& bounds);
+    // brings the tree up to date with the objects updated since the last Build or Refit
+    BvhRefitStats Refit();
+
+    // visible is overwritten with the objects touching the frustum, in no particular order
+    BvhCullStats Cull(const FrustumPlanes& planes, std::vector<uint32_t>& visible) const;
+    // closest object box the ray enters (or starts in) within max_distance
+    RayHit Raycast(const Ray& ray, float max_distance = std::numeric_limits<float>::max()) const;
+
+    uint32_t GetObjectCount() const { return static_cast<uint32_t>(object_bounds_.size()); }
+    const Aabb& GetObjectBounds(uint32_t object) const { return object_bounds_[object]; }
+    uint32_t GetNodeCount() const { return static_cast<uint32_t>(nodes_.size() - 2 * free_pairs_.size()); }
+    uint32_t GetDepth() const;
+    // SAH cost of the tree, relative to a single leaf holding every object
+    float GetSahCost() const;
+
+private:
+    static constexpr uint32_t s_invalid_node_ = UINT32_MAX;
+
+    // Every node covers a contiguous range of object_indices_. Children are allocated in pairs:
+    // an inner node's children are left_ and left_ + 1.
+    struct Node
+    {
+        Aabb bounds_;
+        uint32_t first_object_ = 0;
+        uint32_t object_count_ = 0;
+        uint32_t left_ = s_invalid_node_;
+        uint32_t parent_ = s_invalid_node_;
+        // surface area at (re)build, the reference for the refit quality check
+        float build_area_ = 0.0f;
+        bool dirty_ = false;
+
+        bool IsLeaf() const { return left_ == s_invalid_node_; }
+    };
+
+    // builds the subtree of node over its object range
+    void BuildNode(uint32_t node);
+    uint32_t AllocatePair();
+    void FreeChildren(uint32_t node);
+
+    void RefitNode(uint32_t node, BvhRefitStats& stats);
+    // also clears the dirty marks
+    void RebuildDegraded(uint32_t node, BvhRefitStats& stats);
+
+private:
+    BvhSettings settings_;
+
+    std::vector<Node> nodes_;
+    // first node of every released child pair
+    std::vector<uint32_t> free_pairs_;
+
+    std::vector<Aabb> object_bounds_;
+    std::vector<glm::vec3> object_centers_;
+    std::vector<uint32_t> object_indices_;
+    // leaf holding each object
+    std::vector<uint32_t> object_leaves_;
+    bool has_dirty_ = false;
+};
+
+} // namespace renderer
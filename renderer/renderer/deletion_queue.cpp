@@ -0,0 +1,61 @@
+#include <renderer/renderer/deletion_queue.hpp>
+
+// std
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace renderer {
+
+DeletionQueue::~DeletionQueue()
+{
+    Flush();
+}
+
+void DeletionQueue::Retire(uint64_t timeline_value, std::function<void()> deleter)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // keep the queue sorted even if a caller retires with an older value
+    if (!entries_.empty())
+    {
+        timeline_value = std::max(timeline_value, entries_.back().timeline_value_);
+    }
+
+    entries_.push_back(Entry{timeline_value, std::move(deleter)});
+}
+
+void DeletionQueue::Collect(uint64_t completed_value)
+{
+    // deleters run outside the lock, they may retire further objects (e.g. a buffer owning buffers)
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!entries_.empty() && entries_.front().timeline_value_ <= completed_value)
+        {
+            ready.push_back(std::move(entries_.front().deleter_));
+            entries_.pop_front();
+        }
+    }
+
+    for (auto& deleter : ready)
+    {
+        deleter();
+    }
+}
+
+void DeletionQueue::Flush()
+{
+    while (GetPendingCount() != 0)
+    {
+        Collect(UINT64_MAX);
+    }
+}
+
+size_t DeletionQueue::GetPendingCount()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+} // namespace renderer
@@ -0,0 +1,42 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace renderer {
+
+// Defers destruction of GPU objects until the GPU has passed the timeline value they were
+// retired with. Values are retired in non decreasing order, so collecting only looks at the front.
+class DeletionQueue
+{
+public:
+    DeletionQueue() = default;
+    ~DeletionQueue();
+
+    DeletionQueue(const DeletionQueue&) = delete;
+    DeletionQueue& operator=(const DeletionQueue&) = delete;
+
+    void Retire(uint64_t timeline_value, std::function<void()> deleter);
+
+    // runs the deleters of every entry retired with a value <= completed_value
+    void Collect(uint64_t completed_value);
+    // runs every deleter, only valid once the device is idle
+    void Flush();
+
+    size_t GetPendingCount();
+
+private:
+    struct Entry
+    {
+        uint64_t timeline_value_;
+        std::function<void()> deleter_;
+    };
+
+    std::deque<Entry> entries_;
+    std::mutex mutex_;
+};
+
+} // namespace renderer
@@ -0,0 +1,321 @@
+#include <renderer/renderer/depth_pyramid.hpp>
+
+// std
+#include <algorithm>
+#include <stdexcept>
+
+namespace renderer {
+
+namespace {
+
+bool HasStencil(VkFormat format)
+{
+    return format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+}
+
+VkImageMemoryBarrier MakeDepthBarrier(const DepthAttachment& depth, VkImageLayout old_layout, VkImageLayout new_layout)
+{
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = old_layout;
+    barrier.newLayout = new_layout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = depth.image_;
+    // layout transitions cover every aspect of the image
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | (HasStencil(depth.format_) ? VK_IMAGE_ASPECT_STENCIL_BIT : 0);
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    return barrier;
+}
+
+} // namespace
+
+DepthPyramid::DepthPyramid(Device& device)
+    : device_{device}
+{
+    VkSamplerCreateInfo sampler_info{};
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.magFilter = VK_FILTER_NEAREST;
+    sampler_info.minFilter = VK_FILTER_NEAREST;
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.minLod = 0.0f;
+    sampler_info.maxLod = VK_LOD_CLAMP_NONE;
+
+    if (vkCreateSampler(device_.GetDevice(), &sampler_info, nullptr, &sampler_) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create the depth pyramid sampler!");
+    }
+
+    // source level (or depth attachment) and destination level
+    descriptor_set_layout_ = DescriptorSetLayout::Builder(device_)
+                                 .AddBindings(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+                                 .AddBindings(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+                                 .Build();
+
+    ComputePipelineConfig pipeline_config{};
+    pipeline_config.compute_shader_ = "shaders/depth_pyramid_comp.spv";
+    pipeline_ = std::make_unique<ComputePipeline>(device_, descriptor_set_layout_->GetDescriptorSetLayout(), pipeline_config);
+}
+
+DepthPyramid::~DepthPyramid()
+{
+    Release();
+    device_.Retire([device = device_.GetDevice(), sampler = sampler_]()
+    {
+        vkDestroySampler(device, sampler, nullptr);
+    });
+}
+
+void DepthPyramid::Prepare(VkCommandBuffer command_buffer, const DepthAttachment& depth)
+{
+    VkExtent2D extent{std::max(depth.extent_.width / 2, 1u), std::max(depth.extent_.height / 2, 1u)};
+    if (image_ != VK_NULL_HANDLE && depth.version_ == depth_version_ && extent.width == extent_.width && extent.height == extent_.height)
+    {
+        return;
+    }
+
+    Release();
+    Create(command_buffer, depth);
+}
+
+void DepthPyramid::Create(VkCommandBuffer command_buffer, const DepthAttachment& depth)
+{
+    depth_version_ = depth.version_;
+    extent_ = VkExtent2D{std::max(depth.extent_.width / 2, 1u), std::max(depth.extent_.height / 2, 1u)};
+    level_count_ = 1;
+    for (uint32_t size = std::max(extent_.width, extent_.height); size > 1; size /= 2)
+    {
+        ++level_count_;
+    }
+
+    VkImageCreateInfo image_info{};
+    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.extent.width = extent_.width;
+    image_info.extent.height = extent_.height;
+    image_info.extent.depth = 1;
+    image_info.mipLevels = level_count_;
+    image_info.arrayLayers = 1;
+    image_info.format = VK_FORMAT_R32_SFLOAT;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    image_info.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    device_.CreateImageWithInfo(image_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image_, allocation_);
+
+    VkImageViewCreateInfo view_info{};
+    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view_info.image = image_;
+    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view_info.format = VK_FORMAT_R32_SFLOAT;
+    view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    view_info.subresourceRange.baseMipLevel = 0;
+    view_info.subresourceRange.levelCount = level_count_;
+    view_info.subresourceRange.baseArrayLayer = 0;
+    view_info.subresourceRange.layerCount = 1;
+
+    if (vkCreateImageView(device_.GetDevice(), &view_info, nullptr, &view_) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create the depth pyramid view!");
+    }
+
+    level_views_.resize(level_count_);
+    for (uint32_t level = 0; level < level_count_; ++level)
+    {
+        view_info.subresourceRange.baseMipLevel = level;
+        view_info.subresourceRange.levelCount = 1;
+        if (vkCreateImageView(device_.GetDevice(), &view_info, nullptr, &level_views_[level]) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create a depth pyramid level view!");
+        }
+    }
+
+    uint32_t max_sets = level_count_ + depth.image_count_;
+    descriptor_pool_ = DescriptorPool::Builder(device_)
+                           .SetMaxSets(max_sets)
+                           .AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, max_sets)
+                           .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, max_sets)
+                           .Build();
+
+    level_sets_.assign(level_count_, VK_NULL_HANDLE);
+    for (uint32_t level = 1; level < level_count_; ++level)
+    {
+        VkDescriptorImageInfo source_info{sampler_, level_views_[level - 1], VK_IMAGE_LAYOUT_GENERAL};
+        VkDescriptorImageInfo destination_info{VK_NULL_HANDLE, level_views_[level], VK_IMAGE_LAYOUT_GENERAL};
+        bool built = DescriptorWriter(*descriptor_set_layout_, *descriptor_pool_)
+                         .WriteImage(0, &source_info)
+                         .WriteImage(1, &destination_info)
+                         .Build(level_sets_[level]);
+        if (!built)
+        {
+            throw std::runtime_error("Failed to allocate a depth pyramid descriptor set!");
+        }
+    }
+
+    // Every descriptor reads the image in VK_IMAGE_LAYOUT_GENERAL, the early phase included,
+    // so it is transitioned before anything of this frame reads it
+    VkImageMemoryBarrier to_general{};
+    to_general.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    to_general.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    to_general.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    to_general.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    to_general.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    to_general.image = image_;
+    to_general.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, level_count_, 0, 1};
+    to_general.srcAccessMask = 0;
+    to_general.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &to_general);
+
+    ++version_;
+    has_depth_ = false;
+}
+
+void DepthPyramid::Release()
+{
+    if (image_ == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    // frames in flight may still read the pyramid or use its descriptor sets
+    device_.Retire([&device = device_, image = image_, allocation = allocation_, view = view_, level_views = level_views_,
+                    pool = std::shared_ptr<DescriptorPool>(std::move(descriptor_pool_))]() mutable
+    {
+        for (VkImageView level_view : level_views)
+        {
+            vkDestroyImageView(device.GetDevice(), level_view, nullptr);
+        }
+        vkDestroyImageView(device.GetDevice(), view, nullptr);
+        device.DestroyImage(image, allocation);
+        pool.reset();
+    });
+
+    image_ = VK_NULL_HANDLE;
+    view_ = VK_NULL_HANDLE;
+    level_views_.clear();
+    level_sets_.clear();
+    depth_sets_.clear();
+    has_depth_ = false;
+}
+
+VkDescriptorSet DepthPyramid::GetDepthDescriptorSet(VkImageView depth_view)
+{
+    for (const auto& [view, set] : depth_sets_)
+    {
+        if (view == depth_view)
+        {
+            return set;
+        }
+    }
+
+    VkDescriptorImageInfo source_info{sampler_, depth_view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    VkDescriptorImageInfo destination_info{VK_NULL_HANDLE, level_views_[0], VK_IMAGE_LAYOUT_GENERAL};
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    bool built = DescriptorWriter(*descriptor_set_layout_, *descriptor_pool_)
+                     .WriteImage(0, &source_info)
+                     .WriteImage(1, &destination_info)
+                     .Build(set);
+    if (!built)
+    {
+        throw std::runtime_error("Failed to allocate a depth pyramid descriptor set!");
+    }
+
+    depth_sets_.emplace_back(depth_view, set);
+    return set;
+}
+
+void DepthPyramid::Build(VkCommandBuffer command_buffer, const DepthAttachment& depth)
+{
+    if (image_ == VK_NULL_HANDLE || depth.version_ != depth_version_)
+    {
+        throw std::runtime_error("Depth pyramid built without Prepare for this depth attachment!");
+    }
+
+    // depth writes and earlier pyramid reads come before the pyramid is written
+    VkImageMemoryBarrier to_read[2] = {};
+    to_read[0] = MakeDepthBarrier(depth, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    to_read[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    to_read[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    to_read[1].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    to_read[1].oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    to_read[1].newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    to_read[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    to_read[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    to_read[1].image = image_;
+    to_read[1].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, level_count_, 0, 1};
+    to_read[1].srcAccessMask = 0;
+    to_read[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         2, to_read);
+
+    pipeline_->Bind(command_buffer);
+
+    VkMemoryBarrier level_barrier{};
+    level_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    level_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    level_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    VkExtent2D level_extent = extent_;
+    for (uint32_t level = 0; level < level_count_; ++level)
+    {
+        VkDescriptorSet set = level == 0 ? GetDepthDescriptorSet(depth.view_) : level_sets_[level];
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_->GetLayout(), 0, 1, &set, 0, nullptr);
+        vkCmdDispatch(command_buffer,
+                      (level_extent.width + s_group_size_ - 1) / s_group_size_,
+                      (level_extent.height + s_group_size_ - 1) / s_group_size_,
+                      1);
+
+        // the next level reads this one, readers after Build read every level
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0,
+                             1, &level_barrier,
+                             0, nullptr,
+                             0, nullptr);
+
+        level_extent = VkExtent2D{std::max(level_extent.width / 2, 1u), std::max(level_extent.height / 2, 1u)};
+    }
+
+    // back to the attachment layout for the next render pass
+    VkImageMemoryBarrier to_attachment = MakeDepthBarrier(depth, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    to_attachment.srcAccessMask = 0;
+    to_attachment.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &to_attachment);
+
+    has_depth_ = true;
+}
+
+VkDescriptorImageInfo DepthPyramid::DescriptorInfo() const
+{
+    return VkDescriptorImageInfo{sampler_, view_, VK_IMAGE_LAYOUT_GENERAL};
+}
+
+} // namespace renderer
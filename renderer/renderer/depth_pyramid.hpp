@@ -0,0 +1,91 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// vulkan
+#include <vulkan/vulkan.h>
+
+// renderer includes
+#include <renderer/renderer/device.hpp>
+#include <renderer/renderer/descriptors.hpp>
+#include <renderer/renderer/pipeline.hpp>
+#include <renderer/renderer/swap_chain.hpp>
+
+namespace renderer {
+
+// Hierarchical depth (HiZ) of the swap chain depth attachment, built with compute
+// (shaders/depth_pyramid.comp). Level 0 has half the attachment's resolution, every further
+// level halves again down to 1x1, and every texel holds the farthest depth of the texels it
+// covers, so a box whose nearest depth is farther than the few texels under its screen rect is
+// hidden. One R32_SFLOAT image kept in VK_IMAGE_LAYOUT_GENERAL, rebuilt every frame: readers
+// between two builds see the previous frame's depth.
+class DepthPyramid
+{
+public:
+    static constexpr uint32_t s_group_size_ = 8;
+
+public:
+    DepthPyramid(Device& device);
+    ~DepthPyramid();
+
+    DepthPyramid(const DepthPyramid&) = delete;
+    DepthPyramid& operator=(const DepthPyramid&) = delete;
+
+    // the depth attachment has to be sampled, see DepthAttachment::sampled_
+    static bool IsSupported(const DepthAttachment& depth) { return depth.sampled_; }
+
+    // Once per frame before reading the pyramid, outside a render pass: recreates it when the
+    // swap chain changed and records its transition to VK_IMAGE_LAYOUT_GENERAL. The new pyramid
+    // has no depth until the next Build
+    void Prepare(VkCommandBuffer command_buffer, const DepthAttachment& depth);
+    // Outside a render pass, after the pass writing depth. The attachment goes through
+    // VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL and is back in the attachment layout afterwards.
+    // Compute shaders recorded after Build read the new pyramid
+    void Build(VkCommandBuffer command_buffer, const DepthAttachment& depth);
+
+    // all levels, in VK_IMAGE_LAYOUT_GENERAL with a nearest sampler, for texelFetch
+    VkDescriptorImageInfo DescriptorInfo() const;
+    // bumped when the image was recreated, descriptors of older versions are stale
+    uint64_t GetVersion() const { return version_; }
+    // false until the first Build after a (re)creation
+    bool HasDepth() const { return has_depth_; }
+    VkExtent2D GetExtent() const { return extent_; }
+    uint32_t GetLevelCount() const { return level_count_; }
+
+private:
+    void Create(VkCommandBuffer command_buffer, const DepthAttachment& depth);
+    // retires the image and everything referencing it
+    void Release();
+    VkDescriptorSet GetDepthDescriptorSet(VkImageView depth_view);
+
+private:
+    Device& device_;
+
+    VkExtent2D extent_{};
+    uint32_t level_count_ = 0;
+    // swap chain version the pyramid was created for
+    uint64_t depth_version_ = 0;
+    uint64_t version_ = 0;
+    bool has_depth_ = false;
+
+    VkImage image_ = VK_NULL_HANDLE;
+    Allocation allocation_{};
+    VkImageView view_ = VK_NULL_HANDLE;
+    // one per level, the storage target of its level and the source of the next
+    std::vector<VkImageView> level_views_;
+    VkSampler sampler_ = VK_NULL_HANDLE;
+
+    std::unique_ptr<DescriptorSetLayout> descriptor_set_layout_;
+    std::unique_ptr<DescriptorPool> descriptor_pool_;
+    // source level - 1 into level, index 0 unused
+    std::vector<VkDescriptorSet> level_sets_;
+    // depth attachment into level 0, one per swap chain image
+    std::vector<std::pair<VkImageView, VkDescriptorSet>> depth_sets_;
+    std::unique_ptr<ComputePipeline> pipeline_;
+};
+
+} // namespace renderer
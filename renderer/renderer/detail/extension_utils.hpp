@@ -16,17 +16,33 @@ namespace renderer::detail {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME
     };
 
-    inline std::vector<const char*> GetRequiredExtensions()
+    inline std::vector<const char*> GetRequiredExtensions(bool headless = false)
     {
-        uint32_t glfw_extensions_count = 0;
-        const char** glfw_extensions;
-        glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extensions_count);
+        std::vector<const char*> extensions;
 
-        std::vector<const char*> extensions(glfw_extensions, glfw_extensions + glfw_extensions_count);
+        // headless instances have no window, so GLFW (and its surface extensions) is never touched
+        if (!headless)
+        {
+            uint32_t glfw_extensions_count = 0;
+            const char** glfw_extensions;
+            glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extensions_count);
+
+            extensions.assign(glfw_extensions, glfw_extensions + glfw_extensions_count);
+        }
 
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 
         return extensions;
     }
 
+    inline std::vector<const char*> GetRequiredDeviceExtensions(bool headless = false)
+    {
+        if (headless)
+        {
+            return {};
+        }
+
+        return s_device_extensions;
+    }
+
 } // namespace renderer::detail
\ No newline at end of file
@@ -29,15 +29,24 @@ QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surfa
             indices.graphics_family_ = i;
         }
 
-        VkBool32 present_support = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present_support);
+        if ((queue_family.queueFlags & VK_QUEUE_COMPUTE_BIT) && !indices.compute_family_.has_value())
+        {
+            indices.compute_family_ = i;
+        }
 
-        if (present_support) 
+        // headless: there is no surface to query present support for
+        if (surface != VK_NULL_HANDLE)
         {
-            indices.present_family_ = i;
+            VkBool32 present_support = false;
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present_support);
+
+            if (present_support) 
+            {
+                indices.present_family_ = i;
+            }
         }
 
-        if (indices.IsComplete()) 
+        if (indices.IsComplete() && indices.compute_family_.has_value()) 
         {
             break;
         }
@@ -45,6 +54,17 @@ QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surfa
         ++i;
     }
 
+    // dedicated transfer families run copies asynchronously to graphics work
+    for (uint32_t family = 0; family < queue_families.size(); ++family)
+    {
+        VkQueueFlags flags = queue_families[family].queueFlags;
+        if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+        {
+            indices.transfer_family_ = family;
+            break;
+        }
+    }
+
     return indices;
 }
 
@@ -65,6 +85,21 @@ bool CheckDeviceExtensionSupport(VkPhysicalDevice device) {
     return required_extensions.empty();
 }
 
+bool CheckFeatureSupport(VkPhysicalDevice device)
+{
+    VkPhysicalDeviceVulkan12Features vulkan12_features{};
+    vulkan12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &vulkan12_features;
+
+    vkGetPhysicalDeviceFeatures2(device, &features);
+
+    // frame and upload synchronization is built on timeline semaphores
+    return vulkan12_features.timelineSemaphore == VK_TRUE;
+}
+
 SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice device, VkSurfaceKHR surface)
 {
     SwapChainSupportDetails details;
@@ -113,6 +148,17 @@ bool PhysicalDeviceSelector::IsDeviceSuitable(VkPhysicalDevice physical_device)
 {
     QueueFamilyIndices indices = FindQueueFamilies(physical_device, surface_);
 
+    if (!CheckFeatureSupport(physical_device))
+    {
+        return false;
+    }
+
+    if (surface_ == VK_NULL_HANDLE)
+    {
+        // headless: no swap chain, so neither present support nor VK_KHR_swapchain is required
+        return indices.IsCompleteHeadless();
+    }
+
     bool extensions_supported = CheckDeviceExtensionSupport(physical_device);
 
     bool swap_chain_adequate = false;
@@ -12,11 +12,20 @@ namespace renderer::detail {
 struct QueueFamilyIndices {
     std::optional<uint32_t> graphics_family_;
     std::optional<uint32_t> present_family_;
+    std::optional<uint32_t> compute_family_;
+    // transfer only family (DMA engine), empty when the device has none
+    std::optional<uint32_t> transfer_family_;
 
     bool IsComplete() 
     {
         return graphics_family_.has_value() && present_family_.has_value();
     }
+
+    // headless devices never present, so only graphics and compute capabilities matter
+    bool IsCompleteHeadless()
+    {
+        return graphics_family_.has_value() && compute_family_.has_value();
+    }
 };
 
 struct SwapChainSupportDetails {
@@ -28,6 +37,7 @@ struct SwapChainSupportDetails {
 QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surface);
 SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice device, VkSurfaceKHR surface);
 
+// surface == VK_NULL_HANDLE selects devices for headless rendering
 class PhysicalDeviceSelector
 {
 public:
@@ -0,0 +1,144 @@
+#include <renderer/renderer/detail/pipeline_cache_utils.hpp>
+
+// std
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace renderer::detail {
+
+namespace {
+
+// FNV-1a, only used to detect truncated or corrupted blobs
+uint64_t Checksum(const char* data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// The blob itself starts with VkPipelineCacheHeaderVersionOne, check it as well
+// in case the driver changed its mind about the cache format.
+bool IsVulkanHeaderValid(const std::vector<char>& data, const VkPhysicalDeviceProperties& properties)
+{
+    constexpr size_t vulkan_header_size = 16 + VK_UUID_SIZE;
+    if (data.size() < vulkan_header_size)
+    {
+        return false;
+    }
+
+    uint32_t header_length = 0;
+    uint32_t header_version = 0;
+    uint32_t vendor_id = 0;
+    uint32_t device_id = 0;
+    std::memcpy(&header_length, data.data(), 4);
+    std::memcpy(&header_version, data.data() + 4, 4);
+    std::memcpy(&vendor_id, data.data() + 8, 4);
+    std::memcpy(&device_id, data.data() + 12, 4);
+
+    return header_length >= vulkan_header_size
+        && header_version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+        && vendor_id == properties.vendorID
+        && device_id == properties.deviceID
+        && std::memcmp(data.data() + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+} // namespace
+
+std::vector<char> LoadPipelineCacheData(const std::string& path, const VkPhysicalDeviceProperties& properties)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Pipeline cache: no cache at " << path << ", starting cold" << std::endl;
+        return {};
+    }
+
+    PipelineCacheFileHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    {
+        std::cout << "Pipeline cache: truncated header, discarding " << path << std::endl;
+        return {};
+    }
+
+    bool header_valid = header.magic_ == PipelineCacheFileHeader::s_magic_
+                     && header.version_ == PipelineCacheFileHeader::s_version_
+                     && header.vendor_id_ == properties.vendorID
+                     && header.device_id_ == properties.deviceID
+                     && header.driver_version_ == properties.driverVersion
+                     && std::memcmp(header.cache_uuid_, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+
+    if (!header_valid)
+    {
+        std::cout << "Pipeline cache: written for another device or driver, discarding " << path << std::endl;
+        return {};
+    }
+
+    std::vector<char> data(header.data_size_);
+    if (!file.read(data.data(), data.size()) || Checksum(data.data(), data.size()) != header.checksum_)
+    {
+        std::cout << "Pipeline cache: corrupted blob, discarding " << path << std::endl;
+        return {};
+    }
+
+    if (!IsVulkanHeaderValid(data, properties))
+    {
+        std::cout << "Pipeline cache: blob header does not match the device, discarding " << path << std::endl;
+        return {};
+    }
+
+    std::cout << "Pipeline cache: loaded " << data.size() << " bytes from " << path << std::endl;
+    return data;
+}
+
+bool SavePipelineCacheData(const std::string& path, const VkPhysicalDeviceProperties& properties, const std::vector<char>& data)
+{
+    PipelineCacheFileHeader header{};
+    header.magic_ = PipelineCacheFileHeader::s_magic_;
+    header.version_ = PipelineCacheFileHeader::s_version_;
+    header.vendor_id_ = properties.vendorID;
+    header.device_id_ = properties.deviceID;
+    header.driver_version_ = properties.driverVersion;
+    std::memcpy(header.cache_uuid_, properties.pipelineCacheUUID, VK_UUID_SIZE);
+    header.data_size_ = data.size();
+    header.checksum_ = Checksum(data.data(), data.size());
+
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cerr << "Pipeline cache: failed to open " << tmp_path << " for writing" << std::endl;
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(data.data(), data.size());
+        file.flush();
+
+        if (!file)
+        {
+            std::cerr << "Pipeline cache: failed to write " << tmp_path << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tmp_path, path, error);
+    if (error)
+    {
+        std::cerr << "Pipeline cache: failed to move " << tmp_path << " to " << path << ": " << error.message() << std::endl;
+        std::filesystem::remove(tmp_path, error);
+        return false;
+    }
+
+    std::cout << "Pipeline cache: saved " << data.size() << " bytes to " << path << std::endl;
+    return true;
+}
+
+} // namespace renderer::detail
@@ -0,0 +1,37 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// vulkan
+#include <vulkan/vulkan.h>
+
+namespace renderer::detail {
+
+// Header written in front of the driver's pipeline cache blob. Vulkan's own
+// cache header has no driver version, so it is stored here to discard blobs
+// written by an older driver.
+struct PipelineCacheFileHeader
+{
+    static constexpr uint32_t s_magic_ = 0x43505652; // "RVPC"
+    static constexpr uint32_t s_version_ = 1;
+
+    uint32_t magic_;
+    uint32_t version_;
+    uint32_t vendor_id_;
+    uint32_t device_id_;
+    uint32_t driver_version_;
+    uint8_t cache_uuid_[VK_UUID_SIZE];
+    uint64_t data_size_;
+    uint64_t checksum_;
+};
+
+// Returns an empty vector when the file is missing, corrupted or was written for another device/driver
+std::vector<char> LoadPipelineCacheData(const std::string& path, const VkPhysicalDeviceProperties& properties);
+
+// Writes to a temporary file and renames it over path, so a crash never leaves a truncated cache behind
+bool SavePipelineCacheData(const std::string& path, const VkPhysicalDeviceProperties& properties, const std::vector<char>& data);
+
+} // namespace renderer::detail
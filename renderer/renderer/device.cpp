@@ -13,26 +13,46 @@
 #include <renderer/renderer/detail/extension_utils.hpp>
 #include <renderer/renderer/detail/validation_layers.hpp>
 #include <renderer/renderer/detail/physical_device_utils.hpp>
+#include <renderer/renderer/detail/pipeline_cache_utils.hpp>
 
 namespace renderer
 {
 
 Device::Device(engine::Window& window)
-    : window_(window)
+    : window_(&window)
+{
+    InitVulkan();
+}
+
+Device::Device()
 {
     InitVulkan();
 }
 
 Device::~Device()
 {
+    // every frame and upload finished, retired objects can go right away
+    vkDeviceWaitIdle(device_);
+
+    SavePipelineCache();
+    vkDestroyPipelineCache(device_, pipeline_cache_, nullptr);
+
     vkDestroyCommandPool(device_, command_pool_, nullptr);
+
+    upload_engine_.reset();
+    deletion_queue_.Flush();
+    allocator_.reset();
+    frame_timeline_.reset();
     vkDestroyDevice(device_, nullptr);
 
     // Validation layers
 
     detail::DestroyDebugUtilsMessengerEXT(instance_, debug_messenger_, nullptr);
 
-    vkDestroySurfaceKHR(instance_, surface_, nullptr);
+    if (surface_ != VK_NULL_HANDLE)
+    {
+        vkDestroySurfaceKHR(instance_, surface_, nullptr);
+    }
     vkDestroyInstance(instance_, nullptr);
 }
 
@@ -44,6 +64,10 @@ void Device::InitVulkan()
     PickPhysicalDevice();
     CreateLogicalDevice();
     CreateCommapdPool();
+    CreateFrameTimeline();
+    CreateAllocator();
+    CreateUploadEngine();
+    CreatePipelineCache();
 }
 
 void Device::CreateInstance()
@@ -66,7 +90,7 @@ void Device::CreateInstance()
     create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     create_info.pApplicationInfo = &app_info;
 
-    auto extensions = detail::GetRequiredExtensions();
+    auto extensions = detail::GetRequiredExtensions(IsHeadless());
     create_info.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
     create_info.ppEnabledExtensionNames = extensions.data();
     std::cout << extensions.size() << std::endl;
@@ -101,7 +125,12 @@ void Device::SetupDebugMessenger()
 
 void Device::CreateSurface()
 {
-    window_.CreateSurface(instance_, &surface_);
+    if (IsHeadless())
+    {
+        return;
+    }
+
+    window_->CreateSurface(instance_, &surface_);
 }
 
 void Device::PickPhysicalDevice()
@@ -125,6 +154,9 @@ void Device::PickPhysicalDevice()
         std::cerr << "Failed to find a suitable GPU!" << std::endl;
         std::abort();
     }
+
+    vkGetPhysicalDeviceProperties(physical_device_, &properties_);
+    std::cout << "Selected GPU: " << properties_.deviceName << std::endl;
 }
 
 void Device::CreateLogicalDevice()
@@ -132,7 +164,15 @@ void Device::CreateLogicalDevice()
     detail::QueueFamilyIndices indices = detail::FindQueueFamilies(physical_device_, surface_);
 
     std::vector<VkDeviceQueueCreateInfo> queue_create_infos;
-    std::set<uint32_t> unique_queue_families = {indices.graphics_family_.value(), indices.present_family_.value()};
+    std::set<uint32_t> unique_queue_families = {indices.graphics_family_.value()};
+    if (indices.present_family_.has_value())
+    {
+        unique_queue_families.insert(indices.present_family_.value());
+    }
+    if (indices.transfer_family_.has_value())
+    {
+        unique_queue_families.insert(indices.transfer_family_.value());
+    }
 
     float queue_priority = 1.0f;
     for (uint32_t queue_family : unique_queue_families)
@@ -145,18 +185,41 @@ void Device::CreateLogicalDevice()
         queue_create_infos.push_back(queue_create_info);
     }
 
+    VkPhysicalDeviceVulkan12Features supported_vulkan12_features{};
+    supported_vulkan12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+
+    VkPhysicalDeviceFeatures2 supported_features{};
+    supported_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supported_features.pNext = &supported_vulkan12_features;
+    vkGetPhysicalDeviceFeatures2(physical_device_, &supported_features);
+
+    // optional, the indirect draw path falls back to fewer draws per call without them
+    features_.multi_draw_indirect_ = supported_features.features.multiDrawIndirect == VK_TRUE;
+    features_.draw_indirect_first_instance_ = supported_features.features.drawIndirectFirstInstance == VK_TRUE;
+    features_.draw_indirect_count_ = supported_vulkan12_features.drawIndirectCount == VK_TRUE;
+
     VkPhysicalDeviceFeatures device_features{};
+    device_features.multiDrawIndirect = features_.multi_draw_indirect_ ? VK_TRUE : VK_FALSE;
+    device_features.drawIndirectFirstInstance = features_.draw_indirect_first_instance_ ? VK_TRUE : VK_FALSE;
+
+    // timelineSemaphore is checked by PhysicalDeviceSelector
+    VkPhysicalDeviceVulkan12Features vulkan12_features{};
+    vulkan12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+    vulkan12_features.timelineSemaphore = VK_TRUE;
+    vulkan12_features.drawIndirectCount = features_.draw_indirect_count_ ? VK_TRUE : VK_FALSE;
 
     VkDeviceCreateInfo create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    create_info.pNext = &vulkan12_features;
 
     create_info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
     create_info.pQueueCreateInfos = queue_create_infos.data();
 
     create_info.pEnabledFeatures = &device_features;
 
-    create_info.enabledExtensionCount = static_cast<uint32_t>(detail::s_device_extensions.size());
-    create_info.ppEnabledExtensionNames = detail::s_device_extensions.data();
+    auto device_extensions = detail::GetRequiredDeviceExtensions(IsHeadless());
+    create_info.enabledExtensionCount = static_cast<uint32_t>(device_extensions.size());
+    create_info.ppEnabledExtensionNames = device_extensions.data();
 
     // validation layers
     create_info.enabledLayerCount = static_cast<uint32_t>(detail::s_validation_layers_.size());
@@ -167,8 +230,16 @@ void Device::CreateLogicalDevice()
         throw std::runtime_error("Failed to create Vulkan Logical device");
     }   
 
-    vkGetDeviceQueue(device_, indices.graphics_family_.value(), 0, &graphics_queue_);
-    vkGetDeviceQueue(device_, indices.present_family_.value(), 0, &present_queue_);
+    graphics_family_ = indices.graphics_family_.value();
+    vkGetDeviceQueue(device_, graphics_family_, 0, &graphics_queue_);
+
+    // without a transfer only family uploads go through the graphics queue
+    transfer_family_ = indices.transfer_family_.value_or(graphics_family_);
+    vkGetDeviceQueue(device_, transfer_family_, 0, &transfer_queue_);
+    if (indices.present_family_.has_value())
+    {
+        vkGetDeviceQueue(device_, indices.present_family_.value(), 0, &present_queue_);
+    }
 }
 
 void Device::CreateCommapdPool()
@@ -188,39 +259,66 @@ void Device::CreateCommapdPool()
     }
 }
 
-// Buffer utility interface
-void Device::CopyBuffer(VkBuffer src_buffer, VkBuffer dst_buffer, VkDeviceSize size)
+void Device::CreateFrameTimeline()
+{
+    frame_timeline_ = std::make_unique<TimelineSemaphore>(device_);
+}
+
+void Device::CreateAllocator()
+{
+    allocator_ = std::make_unique<MemoryAllocator>(device_, physical_device_);
+}
+
+void Device::CreateUploadEngine()
 {
-    VkCommandBufferAllocateInfo alloc_info{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    alloc_info.commandPool = command_pool_;
-    alloc_info.commandBufferCount = 1;
+    upload_engine_ = std::make_unique<UploadEngine>(*this);
+}
 
-    VkCommandBuffer command_buffer;
-    vkAllocateCommandBuffers(device_, &alloc_info, &command_buffer);
+void Device::CreatePipelineCache()
+{
+    // stale or foreign blobs come back empty, the driver then starts from a cold cache
+    std::vector<char> initial_data = detail::LoadPipelineCacheData(s_pipeline_cache_path_, properties_);
+    pipeline_cache_warm_ = !initial_data.empty();
+
+    VkPipelineCacheCreateInfo cache_info{};
+    cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cache_info.initialDataSize = initial_data.size();
+    cache_info.pInitialData = initial_data.empty() ? nullptr : initial_data.data();
+
+    if (vkCreatePipelineCache(device_, &cache_info, nullptr, &pipeline_cache_) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create pipeline cache!");
+    }
+}
 
-    VkCommandBufferBeginInfo begin_info{};
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+void Device::SavePipelineCache()
+{
+    size_t data_size = 0;
+    if (vkGetPipelineCacheData(device_, pipeline_cache_, &data_size, nullptr) != VK_SUCCESS || data_size == 0)
+    {
+        return;
+    }
 
-    vkBeginCommandBuffer(command_buffer, &begin_info);
+    std::vector<char> data(data_size);
+    if (vkGetPipelineCacheData(device_, pipeline_cache_, &data_size, data.data()) != VK_SUCCESS)
     {
-        VkBufferCopy copy_region{};
-        copy_region.size = size;
-        vkCmdCopyBuffer(command_buffer, src_buffer, dst_buffer, 1, &copy_region);
+        std::cerr << "Failed to read pipeline cache data" << std::endl;
+        return;
     }
-    vkEndCommandBuffer(command_buffer);
+    data.resize(data_size);
 
-    VkSubmitInfo submit_info{};
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &command_buffer;
+    detail::SavePipelineCacheData(s_pipeline_cache_path_, properties_, data);
+}
 
-    vkQueueSubmit(graphics_queue_, 1, &submit_info, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphics_queue_);
+void Device::Retire(std::function<void()> deleter)
+{
+    // the frame being recorded signals pending + 1, it may still reference the object
+    deletion_queue_.Retire(frame_timeline_->GetPendingValue() + 1, std::move(deleter));
+}
 
-    vkFreeCommandBuffers(device_, command_pool_, 1, &command_buffer);
+void Device::CollectGarbage()
+{
+    deletion_queue_.Collect(frame_timeline_->GetCompletedValue());
 }
 
 VkFormat Device::FindSupportedFormat(const std::vector<VkFormat>& candidates
@@ -248,7 +346,7 @@ VkFormat Device::FindSupportedFormat(const std::vector<VkFormat>& candidates
 void Device::CreateImageWithInfo(const VkImageCreateInfo &image_info
                         , VkMemoryPropertyFlags properties
                         , VkImage &image
-                        , VkDeviceMemory &image_memory)
+                        , Allocation &image_allocation)
 {
     if (vkCreateImage(device_, &image_info, nullptr, &image) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create image!");
@@ -257,36 +355,24 @@ void Device::CreateImageWithInfo(const VkImageCreateInfo &image_info
     VkMemoryRequirements mem_requirements;
     vkGetImageMemoryRequirements(device_, image, &mem_requirements);
 
-    VkMemoryAllocateInfo alloc_info{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    alloc_info.allocationSize = mem_requirements.size;
-    alloc_info.memoryTypeIndex = FindMemoryType(mem_requirements.memoryTypeBits, properties);
+    AllocationKind kind = image_info.tiling == VK_IMAGE_TILING_OPTIMAL ? AllocationKind::Optimal : AllocationKind::Linear;
+    image_allocation = allocator_->Allocate(mem_requirements, properties, kind);
 
-    if (vkAllocateMemory(device_, &alloc_info, nullptr, &image_memory) != VK_SUCCESS) 
-    {
-        throw std::runtime_error("failed to allocate image memory!");
-    }
-
-    if (vkBindImageMemory(device_, image, image_memory, 0) != VK_SUCCESS) 
+    if (vkBindImageMemory(device_, image, image_allocation.memory_, image_allocation.offset_) != VK_SUCCESS) 
     {
         throw std::runtime_error("failed to bind image memory!");
     }
 }
 
-uint32_t Device::FindMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties)
+void Device::DestroyImage(VkImage image, Allocation& image_allocation)
 {
-    VkPhysicalDeviceMemoryProperties mem_properties;
-    vkGetPhysicalDeviceMemoryProperties(physical_device_, &mem_properties);
-    for (uint32_t i = 0; i < mem_properties.memoryTypeCount; i++) 
-    {
-        if ((type_filter & (1 << i)) && (mem_properties.memoryTypes[i].propertyFlags & properties) == properties) 
-        {
-            return i;
-        }
-    }
-
-    throw std::runtime_error("failed to find suitable memory type!");
+    vkDestroyImage(device_, image, nullptr);
+    allocator_->Free(image_allocation);
+}
 
+uint32_t Device::FindMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties)
+{
+    return allocator_->FindMemoryType(type_filter, properties);
 }
 
 } // namespace renderer
@@ -1,6 +1,8 @@
 #pragma once
 
 // std
+#include <functional>
+#include <memory>
 #include <vector>
 
 // vulkan
@@ -8,24 +10,70 @@
 
 // engine includes
 #include <renderer/window.hpp>
+#include <renderer/renderer/memory_allocator.hpp>
+#include <renderer/renderer/upload_engine.hpp>
+#include <renderer/renderer/timeline_semaphore.hpp>
+#include <renderer/renderer/deletion_queue.hpp>
 
 namespace renderer {
 
+// Optional features, enabled at device creation whenever the GPU supports them
+struct DeviceFeatures
+{
+    // more than one draw per vkCmdDrawIndexedIndirect
+    bool multi_draw_indirect_ = false;
+    // non zero firstInstance in indirect commands
+    bool draw_indirect_first_instance_ = false;
+    // vkCmdDrawIndexedIndirectCount, the draw count is read from a buffer
+    bool draw_indirect_count_ = false;
+};
+
 class Device
 {
 public:
     Device(engine::Window& window);
+    // headless device: no window, surface or swap chain, renders into offscreen images
+    Device();
     ~Device();
 
+    bool IsHeadless() { return window_ == nullptr; }
+
     VkDevice GetDevice() { return device_; }
     VkPhysicalDevice GetPhysicalDevice() { return physical_device_; }
     VkSurfaceKHR GetSurface()            { return surface_; }
 
     VkQueue GetGraphicsQueue() { return graphics_queue_; }
     VkQueue GetPresentQueue() { return present_queue_; }
+    // dedicated transfer queue when the device has one, the graphics queue otherwise
+    VkQueue GetTransferQueue() { return transfer_queue_; }
+
+    uint32_t GetGraphicsFamily() { return graphics_family_; }
+    uint32_t GetTransferFamily() { return transfer_family_; }
 
     VkCommandPool GetCommandPool() { return command_pool_; }
 
+    const VkPhysicalDeviceProperties& GetProperties() { return properties_; }
+    const DeviceFeatures& GetFeatures() { return features_; }
+
+    // pipeline cache shared by every pipeline, persisted to s_pipeline_cache_path_
+    VkPipelineCache GetPipelineCache() { return pipeline_cache_; }
+    // true when the cache was seeded from a valid blob on disk
+    bool IsPipelineCacheWarm() { return pipeline_cache_warm_; }
+
+    // Signaled with the frame number when a frame's GPU work completes. Anything tied to a frame
+    // (recycling, deferred deletion) waits on or polls this single value instead of its own fence
+    TimelineSemaphore& GetFrameTimeline() { return *frame_timeline_; }
+
+    // Defers deleter until the GPU finished the frame currently being recorded, so resources
+    // can be released at any time without idling the device
+    void Retire(std::function<void()> deleter);
+    // frees everything retired with frames the GPU already completed, called once per frame
+    void CollectGarbage();
+
+    // every buffer and image is sub-allocated from here
+    MemoryAllocator& GetAllocator() { return *allocator_; }
+    // batched buffer uploads, flushed by the renderer once per frame
+    UploadEngine& GetUploadEngine() { return *upload_engine_; }
 
 private:
     void InitVulkan();
@@ -37,11 +85,13 @@ private:
     void PickPhysicalDevice();
     void CreateLogicalDevice();
     void CreateCommapdPool();
+    void CreateFrameTimeline();
+    void CreateAllocator();
+    void CreateUploadEngine();
+    void CreatePipelineCache();
+    void SavePipelineCache();
 
 public:
-    // buffer utility interface
-    void CopyBuffer(VkBuffer src_buffer, VkBuffer dst_buffer, VkDeviceSize size);
-
     VkFormat FindSupportedFormat(const std::vector<VkFormat>& candidates
                                 , VkImageTiling tilling
                                 , VkFormatFeatureFlags features);
@@ -49,28 +99,48 @@ public:
     void CreateImageWithInfo(const VkImageCreateInfo &image_info
                             , VkMemoryPropertyFlags properties
                             , VkImage &image
-                            , VkDeviceMemory &image_memory);
+                            , Allocation &image_allocation);
+    void DestroyImage(VkImage image, Allocation& image_allocation);
     uint32_t FindMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties);
 private:
-    // window for rendering to it
-    engine::Window& window_;
+    // window for rendering to it, nullptr in headless mode
+    engine::Window* window_ = nullptr;
 
     VkInstance instance_;
     VkDebugUtilsMessengerEXT debug_messenger_;
 
-    // surface
-    VkSurfaceKHR surface_;
+    // surface, VK_NULL_HANDLE in headless mode
+    VkSurfaceKHR surface_ = VK_NULL_HANDLE;
 
     VkPhysicalDevice physical_device_ = VK_NULL_HANDLE;
+    VkPhysicalDeviceProperties properties_{};
+    DeviceFeatures features_{};
     VkDevice device_;
 
     // device_ queues
     VkQueue graphics_queue_;
-    VkQueue present_queue_;
+    VkQueue present_queue_ = VK_NULL_HANDLE;
+    VkQueue transfer_queue_ = VK_NULL_HANDLE;
+
+    uint32_t graphics_family_ = 0;
+    uint32_t transfer_family_ = 0;
 
     // command pool
     VkCommandPool command_pool_;
 
+    std::unique_ptr<TimelineSemaphore> frame_timeline_;
+    DeletionQueue deletion_queue_;
+
+    // memory allocator, destroyed before device_
+    std::unique_ptr<MemoryAllocator> allocator_;
+    // uses allocator_, destroyed before it
+    std::unique_ptr<UploadEngine> upload_engine_;
+
+    // pipeline cache
+    static constexpr const char* s_pipeline_cache_path_ = "pipeline_cache.bin";
+    VkPipelineCache pipeline_cache_ = VK_NULL_HANDLE;
+    bool pipeline_cache_warm_ = false;
+
 };
 
 } // namespace renderer
\ No newline at end of file
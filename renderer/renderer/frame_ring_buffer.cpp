@@ -0,0 +1,59 @@
+#include <renderer/renderer/frame_ring_buffer.hpp>
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace renderer {
+
+FrameRingBuffer::FrameRingBuffer(Device& device, uint32_t frame_count, VkDeviceSize frame_capacity, VkBufferUsageFlags usage)
+    : device_{device}
+    , frame_count_{frame_count}
+{
+    // one alignment for both uniform and storage usage keeps every offset valid for either binding type
+    const VkPhysicalDeviceLimits& limits = device_.GetProperties().limits;
+    alignment_ = std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment);
+
+    frame_capacity_ = (frame_capacity + alignment_ - 1) / alignment_ * alignment_;
+
+    buffer_ = std::make_unique<Buffer>(device_,
+                                       frame_capacity_,
+                                       frame_count_,
+                                       usage,
+                                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    if (buffer_->Map() != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to map frame ring buffer!");
+    }
+}
+
+void FrameRingBuffer::BeginFrame(uint32_t frame_index)
+{
+    assert(frame_index < frame_count_ && "Frame index out of range");
+
+    frame_index_ = frame_index;
+    head_ = 0;
+}
+
+RingAllocation FrameRingBuffer::Allocate(VkDeviceSize size)
+{
+    VkDeviceSize aligned_size = (size + alignment_ - 1) / alignment_ * alignment_;
+    if (head_ + aligned_size > frame_capacity_)
+    {
+        throw std::runtime_error("Frame ring buffer overflow, increase its frame capacity!");
+    }
+
+    VkDeviceSize offset = frame_index_ * frame_capacity_ + head_;
+    head_ += aligned_size;
+
+    RingAllocation allocation{};
+    allocation.mapped_ = buffer_->GetMappedMemory(offset);
+    allocation.offset_ = static_cast<uint32_t>(offset);
+    allocation.size_ = size;
+
+    return allocation;
+}
+
+} // namespace renderer
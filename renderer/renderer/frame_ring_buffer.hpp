@@ -0,0 +1,77 @@
+#pragma once
+
+// std
+#include <memory>
+
+// vulkan
+#include <vulkan/vulkan.h>
+
+// renderer includes
+#include <renderer/renderer/device.hpp>
+#include <renderer/renderer/buffer.hpp>
+
+namespace renderer {
+
+struct RingAllocation
+{
+    // host pointer to write the data through
+    void* mapped_ = nullptr;
+    // offset into the ring buffer, passed as the dynamic offset when binding descriptor sets
+    uint32_t offset_ = 0;
+    VkDeviceSize size_ = 0;
+};
+
+// Persistently mapped buffer split into one region per frame in flight. Transient uniform and
+// storage data is bump allocated from the current frame's region, so per object data needs no
+// Vulkan object creation, only a dynamic offset (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC).
+// Per instance vertex streams are allocated the same way and bound at their offset.
+class FrameRingBuffer
+{
+public:
+    static constexpr VkDeviceSize s_default_frame_capacity_ = 4 * 1024 * 1024;
+
+public:
+    FrameRingBuffer(Device& device,
+                    uint32_t frame_count,
+                    VkDeviceSize frame_capacity = s_default_frame_capacity_,
+                    VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+    ~FrameRingBuffer() = default;
+
+    FrameRingBuffer(const FrameRingBuffer&) = delete;
+    FrameRingBuffer& operator=(const FrameRingBuffer&) = delete;
+
+    // Rewinds the region of frame_index. Call only once the frame's fence signaled,
+    // i.e. after Renderer::BeginFrame returned the command buffer of that frame.
+    void BeginFrame(uint32_t frame_index);
+
+    RingAllocation Allocate(VkDeviceSize size);
+
+    template<typename T>
+    RingAllocation Push(const T& value)
+    {
+        RingAllocation allocation = Allocate(sizeof(T));
+        *static_cast<T*>(allocation.mapped_) = value;
+        return allocation;
+    }
+
+    VkBuffer GetBuffer() { return buffer_->GetBuffer(); }
+    VkDeviceSize GetAlignment() { return alignment_; }
+    VkDeviceSize GetFrameUsage() { return head_; }
+
+    // descriptor for a dynamic binding, range is the size of the data read per draw
+    VkDescriptorBufferInfo DescriptorInfo(VkDeviceSize range) { return buffer_->DescriptorInfo(range, 0); }
+
+private:
+    Device& device_;
+    std::unique_ptr<Buffer> buffer_ = nullptr;
+
+    uint32_t frame_count_;
+    VkDeviceSize frame_capacity_;
+    VkDeviceSize alignment_;
+
+    uint32_t frame_index_ = 0;
+    // bump pointer, relative to the current frame's region
+    VkDeviceSize head_ = 0;
+};
+
+} // namespace renderer
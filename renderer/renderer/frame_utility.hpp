@@ -24,6 +24,8 @@ namespace renderer
         int frame_index_;
         VkCommandBuffer command_buffer_;
         VkDescriptorSet global_descriptor_set_;
+        // dynamic offset of this frame's UBO in the frame ring buffer
+        uint32_t global_ubo_offset_;
     };
 
 
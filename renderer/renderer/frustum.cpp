@@ -0,0 +1,25 @@
+#include <renderer/renderer/frustum.hpp>
+
+namespace renderer {
+
+FrustumPlanes ExtractFrustumPlanes(const glm::mat4& matrix)
+{
+    const glm::mat4& m = matrix;
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    FrustumPlanes planes = {row3 + row0, row3 - row0, row3 + row1, row3 - row1, row2, row3 - row2};
+    for (glm::vec4& plane : planes)
+    {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f)
+        {
+            plane /= length;
+        }
+    }
+    return planes;
+}
+
+} // namespace renderer
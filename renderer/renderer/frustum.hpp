@@ -0,0 +1,20 @@
+#pragma once
+
+// std
+#include <array>
+
+// glm
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+namespace renderer {
+
+// left, right, bottom, top, near, far
+using FrustumPlanes = std::array<glm::vec4, 6>;
+
+// Gribb-Hartmann planes of a Vulkan clip space matrix (0 <= z <= w), normalized so that
+// dot(plane.xyz, p) + plane.w is the signed distance of p, positive inside. The planes are in the
+// space the matrix transforms from: world space for view * projection, object space for a full MVP.
+FrustumPlanes ExtractFrustumPlanes(const glm::mat4& matrix);
+
+} // namespace renderer
@@ -0,0 +1,158 @@
+#include <renderer/renderer/geometry_arena.hpp>
+
+// std
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace renderer {
+
+GeometryArena::GeometryArena(Device& device, VkDeviceSize vertex_capacity, uint32_t index_capacity)
+    : device_{device}
+    , vertex_ranges_{vertex_capacity}
+    , index_ranges_{index_capacity}
+{
+    // the vertex buffer holds bytes counted in 32 bits
+    if (vertex_capacity == 0 || vertex_capacity > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::runtime_error("Geometry arena vertex capacity must be between 1 byte and 4 GiB, " + std::to_string(vertex_capacity) + " bytes requested");
+    }
+
+    // uploaded into range by range for the arena's whole lifetime, concurrent sharing spares
+    // the queue family ownership transfers a dedicated transfer queue would need. The upload
+    // engine's acquire barrier still makes every copy visible to the frames after it
+    vertex_buffer_ = std::make_unique<TypedBuffer<std::byte>>(device_, static_cast<uint32_t>(vertex_capacity), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_SHARING_MODE_CONCURRENT);
+    index_buffer_ = std::make_unique<TypedBuffer<uint32_t>>(device_, index_capacity, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_SHARING_MODE_CONCURRENT);
+}
+
+GeometryArena::~GeometryArena()
+{
+    // the buffers retire through the device, pending ranges die with the allocators
+}
+
+GeometryRange GeometryArena::Allocate(std::span<const std::byte> vertices, uint32_t vertex_stride, std::span<const uint32_t> indices)
+{
+    GeometryRange range = AllocateRanges(vertices, vertex_stride, indices.size());
+    if (!indices.empty())
+    {
+        index_buffer_->Upload(indices, range.first_index_);
+    }
+    return range;
+}
+
+GeometryRange GeometryArena::Allocate(std::span<const std::byte> vertices, uint32_t vertex_stride, std::span<const uint16_t> indices)
+{
+    GeometryRange range = AllocateRanges(vertices, vertex_stride, indices.size());
+    if (!indices.empty())
+    {
+        uint32_t* staging = index_buffer_->StageUpload(static_cast<uint32_t>(indices.size()), range.first_index_);
+        std::copy(indices.begin(), indices.end(), staging);
+    }
+    return range;
+}
+
+GeometryRange GeometryArena::AllocateRanges(std::span<const std::byte> vertices, uint32_t vertex_stride, size_t index_count)
+{
+    if (vertex_stride == 0 || vertices.empty() || vertices.size() % vertex_stride != 0)
+    {
+        throw std::runtime_error("Geometry arena vertex data does not match the stride");
+    }
+
+    CollectRetired();
+
+    GeometryRange range{};
+    range.vertex_stride_ = vertex_stride;
+    range.vertex_byte_size_ = vertices.size();
+    range.vertex_count_ = static_cast<uint32_t>(vertices.size() / vertex_stride);
+    range.index_count_ = static_cast<uint32_t>(index_count);
+
+    uint64_t vertex_offset = vertex_ranges_.Allocate(vertices.size(), vertex_stride);
+    if (vertex_offset == RangeAllocator::s_invalid_offset_)
+    {
+        throw std::runtime_error("Geometry arena out of vertex memory, " + std::to_string(vertices.size()) + " bytes requested");
+    }
+    range.vertex_byte_offset_ = vertex_offset;
+    range.vertex_offset_ = static_cast<int32_t>(vertex_offset / vertex_stride);
+
+    if (index_count > 0)
+    {
+        uint64_t first_index = index_ranges_.Allocate(index_count);
+        if (first_index == RangeAllocator::s_invalid_offset_)
+        {
+            vertex_ranges_.Free(range.vertex_byte_offset_, range.vertex_byte_size_);
+            throw std::runtime_error("Geometry arena out of index memory, " + std::to_string(index_count) + " indices requested");
+        }
+        range.first_index_ = static_cast<uint32_t>(first_index);
+    }
+
+    vertex_buffer_->Upload(vertices, static_cast<uint32_t>(range.vertex_byte_offset_));
+
+    ++mesh_count_;
+    return range;
+}
+
+void GeometryArena::Free(const GeometryRange& range)
+{
+    if (range.vertex_byte_size_ == 0)
+    {
+        return;
+    }
+
+    // the frame being recorded signals pending + 1, it may still draw from the range
+    retired_.push_back(RetiredRange{device_.GetFrameTimeline().GetPendingValue() + 1, range});
+    --mesh_count_;
+}
+
+void GeometryArena::Bind(VkCommandBuffer command_buffer)
+{
+    VkBuffer vertex_buffer = vertex_buffer_->GetBuffer();
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(command_buffer, 0, 1, &vertex_buffer, &offset);
+    vkCmdBindIndexBuffer(command_buffer, index_buffer_->GetBuffer(), 0, s_index_type_);
+}
+
+GeometryArenaStats GeometryArena::GetStats()
+{
+    GeometryArenaStats stats{};
+    stats.vertex_bytes_used_ = vertex_ranges_.GetUsed();
+    stats.vertex_bytes_capacity_ = vertex_ranges_.GetCapacity();
+    stats.indices_used_ = index_ranges_.GetUsed();
+    stats.index_capacity_ = index_ranges_.GetCapacity();
+    stats.mesh_count_ = mesh_count_;
+    stats.vertex_free_ranges_ = vertex_ranges_.GetFreeRangeCount();
+    stats.index_free_ranges_ = index_ranges_.GetFreeRangeCount();
+    return stats;
+}
+
+void GeometryArena::PrintStats()
+{
+    GeometryArenaStats stats = GetStats();
+
+    std::cout << "Geometry arena: " << stats.mesh_count_ << " meshes, "
+              << stats.vertex_bytes_used_ / 1024 << " / " << stats.vertex_bytes_capacity_ / 1024 << " KiB vertices, "
+              << stats.indices_used_ << " / " << stats.index_capacity_ << " indices, "
+              << stats.vertex_free_ranges_ << " + " << stats.index_free_ranges_ << " free ranges" << std::endl;
+}
+
+void GeometryArena::CollectRetired()
+{
+    uint64_t completed_value = device_.GetFrameTimeline().GetCompletedValue();
+    while (!retired_.empty() && retired_.front().timeline_value_ <= completed_value)
+    {
+        Release(retired_.front().range_);
+        retired_.pop_front();
+    }
+}
+
+void GeometryArena::Release(const GeometryRange& range)
+{
+    vertex_ranges_.Free(range.vertex_byte_offset_, range.vertex_byte_size_);
+    if (range.index_count_ > 0)
+    {
+        index_ranges_.Free(range.first_index_, range.index_count_);
+    }
+}
+
+} // namespace renderer
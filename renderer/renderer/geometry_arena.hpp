@@ -0,0 +1,115 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <span>
+
+// vulkan
+#include <vulkan/vulkan.h>
+
+// renderer includes
+#include <renderer/renderer/device.hpp>
+#include <renderer/renderer/buffer.hpp>
+#include <renderer/renderer/typed_buffer.hpp>
+#include <renderer/renderer/range_allocator.hpp>
+
+namespace renderer {
+
+// Where a mesh lives inside the arena. Draws only differ in these offsets, the buffers are shared.
+struct GeometryRange
+{
+    VkDeviceSize vertex_byte_offset_ = 0;
+    VkDeviceSize vertex_byte_size_ = 0;
+    uint32_t vertex_stride_ = 0;
+
+    // vertexOffset of vkCmdDrawIndexed, firstVertex of vkCmdDraw for non indexed meshes
+    int32_t vertex_offset_ = 0;
+    uint32_t vertex_count_ = 0;
+
+    uint32_t first_index_ = 0;
+    uint32_t index_count_ = 0;
+};
+
+struct GeometryArenaStats
+{
+    VkDeviceSize vertex_bytes_used_ = 0;
+    VkDeviceSize vertex_bytes_capacity_ = 0;
+    uint64_t indices_used_ = 0;
+    uint64_t index_capacity_ = 0;
+    uint32_t mesh_count_ = 0;
+    // free list lengths, a measure of fragmentation
+    size_t vertex_free_ranges_ = 0;
+    size_t index_free_ranges_ = 0;
+};
+
+// One device local vertex buffer and one 32-bit index buffer shared by every static mesh, with
+// free lists handing out ranges of both. Meshes of any vertex layout share the vertex buffer:
+// ranges are aligned to the mesh's stride, so the vertex offset is a whole number of vertices.
+// Indices stay relative to the mesh's first vertex, binding once per frame is enough to draw
+// every mesh in the arena.
+class GeometryArena
+{
+public:
+    static constexpr VkDeviceSize s_default_vertex_capacity_ = 64ull * 1024 * 1024;
+    static constexpr uint32_t s_default_index_capacity_ = 16u * 1024 * 1024;
+    static constexpr VkIndexType s_index_type_ = VK_INDEX_TYPE_UINT32;
+
+public:
+    GeometryArena(Device& device,
+                  VkDeviceSize vertex_capacity = s_default_vertex_capacity_,
+                  uint32_t index_capacity = s_default_index_capacity_);
+    ~GeometryArena();
+
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    // Copies the streams into free ranges through the upload engine, indices may be empty.
+    // Throws when the arena has no range large enough left.
+    GeometryRange Allocate(std::span<const std::byte> vertices, uint32_t vertex_stride, std::span<const uint32_t> indices = {});
+    // 16-bit indices, widened while they are copied into staging memory
+    GeometryRange Allocate(std::span<const std::byte> vertices, uint32_t vertex_stride, std::span<const uint16_t> indices);
+    // The ranges become reusable once the GPU finished the frame being recorded, so meshes can
+    // be freed while frames drawing them are still in flight.
+    void Free(const GeometryRange& range);
+
+    void Bind(VkCommandBuffer command_buffer);
+
+    VkBuffer GetVertexBuffer() { return vertex_buffer_->GetBuffer(); }
+    VkBuffer GetIndexBuffer() { return index_buffer_->GetBuffer(); }
+
+    GeometryArenaStats GetStats();
+    void PrintStats();
+
+private:
+    struct RetiredRange
+    {
+        uint64_t timeline_value_;
+        GeometryRange range_;
+    };
+
+private:
+    // allocates both ranges and uploads the vertices, the caller uploads index_count indices
+    GeometryRange AllocateRanges(std::span<const std::byte> vertices, uint32_t vertex_stride, size_t index_count);
+    void CollectRetired();
+    void Release(const GeometryRange& range);
+
+private:
+    Device& device_;
+
+    // bytes, meshes of any vertex layout share it
+    std::unique_ptr<TypedBuffer<std::byte>> vertex_buffer_;
+    std::unique_ptr<TypedBuffer<uint32_t>> index_buffer_;
+
+    // bytes of the vertex buffer, elements of the index buffer
+    RangeAllocator vertex_ranges_;
+    RangeAllocator index_ranges_;
+
+    // freed ranges in retirement order, waiting for the frame timeline
+    std::deque<RetiredRange> retired_;
+    uint32_t mesh_count_ = 0;
+};
+
+} // namespace renderer
@@ -0,0 +1,198 @@
+#include <renderer/renderer/gpu_draw_culler.hpp>
+
+// std
+#include <algorithm>
+#include <stdexcept>
+
+namespace renderer {
+
+GpuDrawCuller::GpuDrawCuller(Device& device, IndirectDrawList& draws, uint32_t frame_count)
+    : device_{device}
+    , draws_{draws}
+    , frame_count_{frame_count}
+    , compact_{draws.GetMode() == IndirectDrawMode::IndirectCount}
+    , readback_written_(frame_count, false)
+{
+    if (!IsSupported(draws_))
+    {
+        throw std::runtime_error("GPU draw culling needs drawIndirectFirstInstance!");
+    }
+
+    VkDeviceSize alignment = device_.GetProperties().limits.minStorageBufferOffsetAlignment;
+    TypedBufferLayout layout;
+    count_region_ = layout.Add<uint32_t>(1);
+    commands_region_ = layout.Add<VkDrawIndexedIndirectCommand>(std::max<uint32_t>(draws_.GetMaxDraws(), 1), s_commands_alignment_);
+    region_size_ = layout.GetSize(alignment);
+
+    visible_buffer_ = std::make_unique<Buffer>(device_,
+                                               region_size_,
+                                               frame_count_,
+                                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+                                                   | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    readback_buffer_ = std::make_unique<TypedBuffer<uint32_t>>(device_,
+                                                               frame_count_,
+                                                               VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (readback_buffer_->Map() != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to map culling readback buffer!");
+    }
+
+    // draw data, input commands, bounds and output, all at per frame dynamic offsets
+    descriptor_set_layout_ = DescriptorSetLayout::Builder(device_)
+                                 .AddBindings(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, VK_SHADER_STAGE_COMPUTE_BIT)
+                                 .AddBindings(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, VK_SHADER_STAGE_COMPUTE_BIT)
+                                 .AddBindings(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, VK_SHADER_STAGE_COMPUTE_BIT)
+                                 .AddBindings(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, VK_SHADER_STAGE_COMPUTE_BIT)
+                                 .Build();
+
+    descriptor_pool_ = DescriptorPool::Builder(device_)
+                           .SetMaxSets(1)
+                           .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 4)
+                           .Build();
+
+    VkDescriptorBufferInfo draw_data_info = draws_.DrawDataDescriptorInfo();
+    VkDescriptorBufferInfo commands_info = draws_.CommandsDescriptorInfo();
+    VkDescriptorBufferInfo bounds_info = draws_.BoundsDescriptorInfo();
+    VkDescriptorBufferInfo visible_info = visible_buffer_->DescriptorInfo(region_size_, 0);
+    bool built = DescriptorWriter(*descriptor_set_layout_, *descriptor_pool_)
+                     .WriteBuffer(0, &draw_data_info)
+                     .WriteBuffer(1, &commands_info)
+                     .WriteBuffer(2, &bounds_info)
+                     .WriteBuffer(3, &visible_info)
+                     .Build(descriptor_set_);
+    if (!built)
+    {
+        throw std::runtime_error("Failed to allocate the culling descriptor set!");
+    }
+
+    ComputePipelineConfig pipeline_config{};
+    pipeline_config.compute_shader_ = "shaders/cull_comp.spv";
+    pipeline_config.push_constant_size_ = sizeof(CullConstants);
+    pipeline_ = std::make_unique<ComputePipeline>(device_, descriptor_set_layout_->GetDescriptorSetLayout(), pipeline_config);
+}
+
+void GpuDrawCuller::Cull(VkCommandBuffer command_buffer, uint32_t frame_index, const glm::mat4& view_projection)
+{
+    frame_index_ = frame_index;
+
+    // the slot's fence was waited for, its last copy has landed
+    if (readback_written_[frame_index_])
+    {
+        visible_count_ = readback_buffer_->GetMappedData()[frame_index_];
+    }
+
+    VkBuffer visible_buffer = visible_buffer_->GetBuffer();
+    VkDeviceSize region_offset = frame_index_ * region_size_;
+    TypedBufferView<uint32_t> count = count_region_.InRegion(visible_buffer, region_offset);
+
+    vkCmdFillBuffer(command_buffer, visible_buffer, count.offset_, count.GetSize(), 0);
+
+    VkMemoryBarrier clear_barrier{};
+    clear_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clear_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clear_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         1, &clear_barrier,
+                         0, nullptr,
+                         0, nullptr);
+
+    CullConstants constants{};
+    constants.planes_ = ExtractFrustumPlanes(view_projection);
+    constants.draw_count_ = draws_.GetDrawCount();
+    constants.compact_ = compact_ ? 1 : 0;
+
+    uint32_t input_offset = draws_.GetRegionOffset();
+    uint32_t dynamic_offsets[] = {input_offset, input_offset, input_offset, static_cast<uint32_t>(region_offset)};
+
+    pipeline_->Bind(command_buffer);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_->GetLayout(), 0, 1, &descriptor_set_, 4, dynamic_offsets);
+    vkCmdPushConstants(command_buffer, pipeline_->GetLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+    ComputePipeline::Dispatch(command_buffer, constants.draw_count_, s_group_size_);
+
+    // the commands and count feed the indirect draws and the statistics copy
+    VkMemoryBarrier cull_barrier{};
+    cull_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    cull_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    cull_barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         1, &cull_barrier,
+                         0, nullptr,
+                         0, nullptr);
+
+    VkBufferCopy copy{};
+    copy.srcOffset = count.offset_;
+    copy.dstOffset = readback_buffer_->View(frame_index_, 1).offset_;
+    copy.size = count.GetSize();
+    vkCmdCopyBuffer(command_buffer, visible_buffer, readback_buffer_->GetBuffer(), 1, &copy);
+
+    VkMemoryBarrier readback_barrier{};
+    readback_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    readback_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    readback_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_HOST_BIT,
+                         0,
+                         1, &readback_barrier,
+                         0, nullptr,
+                         0, nullptr);
+
+    readback_written_[frame_index_] = true;
+}
+
+void GpuDrawCuller::Record(VkCommandBuffer command_buffer)
+{
+    VkBuffer visible_buffer = visible_buffer_->GetBuffer();
+    VkDeviceSize region_offset = frame_index_ * region_size_;
+    RecordCulledDraws(command_buffer,
+                      draws_.GetMode(),
+                      commands_region_.InRegion(visible_buffer, region_offset),
+                      count_region_.InRegion(visible_buffer, region_offset),
+                      draws_.GetDrawCount());
+}
+
+void RecordCulledDraws(VkCommandBuffer command_buffer,
+                       IndirectDrawMode mode,
+                       const TypedBufferView<VkDrawIndexedIndirectCommand>& commands,
+                       const TypedBufferView<uint32_t>& count,
+                       uint32_t draw_count)
+{
+    if (draw_count == 0)
+    {
+        return;
+    }
+
+    constexpr uint32_t stride = TypedBufferView<VkDrawIndexedIndirectCommand>::s_stride_;
+    switch (mode)
+    {
+    case IndirectDrawMode::IndirectCount:
+        vkCmdDrawIndexedIndirectCount(command_buffer, commands.buffer_, commands.GetOffset(), count.buffer_, count.GetOffset(), draw_count, stride);
+        break;
+    case IndirectDrawMode::MultiDrawIndirect:
+        vkCmdDrawIndexedIndirect(command_buffer, commands.buffer_, commands.GetOffset(), draw_count, stride);
+        break;
+    case IndirectDrawMode::SingleDrawIndirect:
+        for (uint32_t draw = 0; draw < draw_count; ++draw)
+        {
+            vkCmdDrawIndexedIndirect(command_buffer, commands.buffer_, commands.GetOffset(draw), 1, stride);
+        }
+        break;
+    case IndirectDrawMode::Direct:
+        // the draw index travels in firstInstance, culling shaders cannot serve direct draws
+        break;
+    }
+}
+
+} // namespace renderer
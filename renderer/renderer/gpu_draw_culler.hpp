@@ -0,0 +1,102 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// vulkan
+#include <vulkan/vulkan.h>
+
+// glm
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// renderer includes
+#include <renderer/renderer/device.hpp>
+#include <renderer/renderer/buffer.hpp>
+#include <renderer/renderer/typed_buffer.hpp>
+#include <renderer/renderer/descriptors.hpp>
+#include <renderer/renderer/pipeline.hpp>
+#include <renderer/renderer/frustum.hpp>
+#include <renderer/renderer/indirect_draw_list.hpp>
+
+namespace renderer {
+
+// push constants of shaders/cull.comp
+struct CullConstants
+{
+    FrustumPlanes planes_;
+    uint32_t draw_count_;
+    uint32_t compact_;
+};
+static_assert(sizeof(CullConstants) == 104, "CullConstants must match the push constant block of shaders/cull.comp");
+
+// Draws the commands a culling shader wrote: with IndirectCount the compacted commands and the
+// count, otherwise draw_count commands where culled ones have instanceCount 0. Shared by the
+// GPU cullers
+void RecordCulledDraws(VkCommandBuffer command_buffer,
+                       IndirectDrawMode mode,
+                       const TypedBufferView<VkDrawIndexedIndirectCommand>& commands,
+                       const TypedBufferView<uint32_t>& count,
+                       uint32_t draw_count);
+
+// Frustum culls the draws of an IndirectDrawList on the GPU (shaders/cull.comp). Visible draws
+// are appended to a device local command buffer through an atomic counter, which is the draw
+// count of vkCmdDrawIndexedIndirectCount, so culling needs no CPU readback. Without
+// drawIndirectCount every command is written in place and culled draws get instanceCount 0.
+// Every frame in flight owns a region of the output:
+//     count | pad | VkDrawIndexedIndirectCommand[max_draws]
+class GpuDrawCuller
+{
+public:
+    static constexpr uint32_t s_group_size_ = 64;
+    // the commands start 16 bytes in, after the padded count of shaders/cull.comp
+    static constexpr VkDeviceSize s_commands_alignment_ = 16;
+
+public:
+    GpuDrawCuller(Device& device, IndirectDrawList& draws, uint32_t frame_count);
+    ~GpuDrawCuller() = default;
+
+    GpuDrawCuller(const GpuDrawCuller&) = delete;
+    GpuDrawCuller& operator=(const GpuDrawCuller&) = delete;
+
+    // the draw index travels in firstInstance, so direct draws cannot be culled on the GPU
+    static bool IsSupported(const IndirectDrawList& draws) { return draws.GetMode() != IndirectDrawMode::Direct; }
+
+    // outside a render pass, after draws.Prepare(frame_index). view_projection gives world space planes
+    void Cull(VkCommandBuffer command_buffer, uint32_t frame_index, const glm::mat4& view_projection);
+    // the culled replacement of IndirectDrawList::Record, with the same bindings
+    void Record(VkCommandBuffer command_buffer);
+
+    // visible draws of the last completed frame in this slot, a statistic copied back with
+    // frames in flight latency, never waited for
+    uint32_t GetVisibleCount() const { return visible_count_; }
+    bool IsCompacting() const { return compact_; }
+
+private:
+    Device& device_;
+    IndirectDrawList& draws_;
+    uint32_t frame_count_;
+    bool compact_;
+
+    // layout of one region
+    TypedBufferView<uint32_t> count_region_;
+    TypedBufferView<VkDrawIndexedIndirectCommand> commands_region_;
+    VkDeviceSize region_size_;
+    uint32_t frame_index_ = 0;
+    uint32_t visible_count_ = 0;
+
+    // device local commands and count
+    std::unique_ptr<Buffer> visible_buffer_;
+    // per frame copies of the count, host visible
+    std::unique_ptr<TypedBuffer<uint32_t>> readback_buffer_;
+    std::vector<bool> readback_written_;
+
+    std::unique_ptr<DescriptorSetLayout> descriptor_set_layout_;
+    std::unique_ptr<DescriptorPool> descriptor_pool_;
+    VkDescriptorSet descriptor_set_ = VK_NULL_HANDLE;
+    std::unique_ptr<ComputePipeline> pipeline_;
+};
+
+} // namespace renderer
@@ -0,0 +1,190 @@
+#include <renderer/renderer/indirect_draw_list.hpp>
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace renderer {
+
+const char* ToString(IndirectDrawMode mode)
+{
+    switch (mode)
+    {
+    case IndirectDrawMode::IndirectCount:
+        return "indirect count";
+    case IndirectDrawMode::MultiDrawIndirect:
+        return "multi draw indirect";
+    case IndirectDrawMode::SingleDrawIndirect:
+        return "single draw indirect";
+    case IndirectDrawMode::Direct:
+        return "direct";
+    }
+    return "unknown";
+}
+
+IndirectDrawList::IndirectDrawList(Device& device, uint32_t frame_count, uint32_t max_draws)
+    : device_{device}
+    , frame_count_{frame_count}
+    , max_draws_{max_draws}
+    , region_versions_(frame_count, 0)
+{
+    const DeviceFeatures& features = device_.GetFeatures();
+    if (!features.draw_indirect_first_instance_)
+    {
+        // firstInstance carries the draw index, without it only direct draws can pass it
+        mode_ = IndirectDrawMode::Direct;
+    }
+    else if (features.draw_indirect_count_)
+    {
+        mode_ = IndirectDrawMode::IndirectCount;
+    }
+    else if (features.multi_draw_indirect_)
+    {
+        mode_ = IndirectDrawMode::MultiDrawIndirect;
+    }
+    else
+    {
+        mode_ = IndirectDrawMode::SingleDrawIndirect;
+    }
+
+    VkDeviceSize alignment = device_.GetProperties().limits.minStorageBufferOffsetAlignment;
+
+    uint32_t draw_capacity = std::max<uint32_t>(max_draws_, 1);
+    TypedBufferLayout layout;
+    draw_data_region_ = layout.Add<DrawData>(draw_capacity, alignment);
+    commands_region_ = layout.Add<VkDrawIndexedIndirectCommand>(draw_capacity, alignment);
+    bounds_region_ = layout.Add<glm::vec4>(draw_capacity, alignment);
+    count_region_ = layout.Add<uint32_t>(1);
+    // regions are bound with dynamic storage buffer offsets
+    region_size_ = layout.GetSize(alignment);
+
+    buffer_ = std::make_unique<Buffer>(device_,
+                                       region_size_,
+                                       frame_count_,
+                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    if (buffer_->Map() != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to map indirect draw buffer!");
+    }
+
+    commands_.reserve(max_draws_);
+    draw_data_.reserve(max_draws_);
+    bounds_.reserve(max_draws_);
+}
+
+uint32_t IndirectDrawList::AddDraw(const MeshRecord& mesh, const DrawData& data, uint32_t lod)
+{
+    if (commands_.size() >= max_draws_)
+    {
+        throw std::runtime_error("Indirect draw list is full, increase its draw capacity!");
+    }
+
+    uint32_t draw = static_cast<uint32_t>(commands_.size());
+    commands_.push_back(MakeCommand(mesh, lod, draw));
+    draw_data_.push_back(data);
+    bounds_.push_back(mesh.bounding_sphere_);
+    ++version_;
+
+    return draw;
+}
+
+void IndirectDrawList::SetDrawData(uint32_t draw, const DrawData& data)
+{
+    draw_data_.at(draw) = data;
+    ++version_;
+}
+
+void IndirectDrawList::SetDrawLod(uint32_t draw, const MeshRecord& mesh, uint32_t lod)
+{
+    commands_.at(draw) = MakeCommand(mesh, lod, draw);
+    bounds_[draw] = mesh.bounding_sphere_;
+    ++version_;
+}
+
+void IndirectDrawList::Clear()
+{
+    commands_.clear();
+    draw_data_.clear();
+    bounds_.clear();
+    ++version_;
+}
+
+void IndirectDrawList::Prepare(uint32_t frame_index)
+{
+    assert(frame_index < frame_count_ && "Frame index out of range");
+
+    frame_index_ = frame_index;
+    if (region_versions_[frame_index_] == version_)
+    {
+        return;
+    }
+
+    VkBuffer buffer = buffer_->GetBuffer();
+    VkDeviceSize region_offset = frame_index_ * region_size_;
+
+    std::copy(draw_data_.begin(), draw_data_.end(), draw_data_region_.InRegion(buffer, region_offset).GetMappedData(*buffer_));
+    std::copy(commands_.begin(), commands_.end(), commands_region_.InRegion(buffer, region_offset).GetMappedData(*buffer_));
+    std::copy(bounds_.begin(), bounds_.end(), bounds_region_.InRegion(buffer, region_offset).GetMappedData(*buffer_));
+    *count_region_.InRegion(buffer, region_offset).GetMappedData(*buffer_) = GetDrawCount();
+
+    region_versions_[frame_index_] = version_;
+}
+
+void IndirectDrawList::Record(VkCommandBuffer command_buffer)
+{
+    uint32_t draw_count = GetDrawCount();
+    if (draw_count == 0)
+    {
+        return;
+    }
+
+    VkBuffer buffer = buffer_->GetBuffer();
+    VkDeviceSize region_offset = frame_index_ * region_size_;
+    TypedBufferView<VkDrawIndexedIndirectCommand> commands = commands_region_.InRegion(buffer, region_offset);
+    constexpr uint32_t stride = TypedBufferView<VkDrawIndexedIndirectCommand>::s_stride_;
+
+    switch (mode_)
+    {
+    case IndirectDrawMode::IndirectCount:
+        vkCmdDrawIndexedIndirectCount(command_buffer, buffer, commands.GetOffset(), buffer, count_region_.InRegion(buffer, region_offset).GetOffset(), max_draws_, stride);
+        break;
+    case IndirectDrawMode::MultiDrawIndirect:
+        vkCmdDrawIndexedIndirect(command_buffer, buffer, commands.GetOffset(), draw_count, stride);
+        break;
+    case IndirectDrawMode::SingleDrawIndirect:
+        for (uint32_t draw = 0; draw < draw_count; ++draw)
+        {
+            vkCmdDrawIndexedIndirect(command_buffer, buffer, commands.GetOffset(draw), 1, stride);
+        }
+        break;
+    case IndirectDrawMode::Direct:
+        for (const VkDrawIndexedIndirectCommand& command : commands_)
+        {
+            vkCmdDrawIndexed(command_buffer, command.indexCount, command.instanceCount, command.firstIndex, command.vertexOffset, command.firstInstance);
+        }
+        break;
+    }
+}
+
+VkDrawIndexedIndirectCommand IndirectDrawList::MakeCommand(const MeshRecord& mesh, uint32_t lod, uint32_t draw)
+{
+    if (mesh.index_buffer_ == VK_NULL_HANDLE || mesh.geometry_.vertex_byte_size_ == 0)
+    {
+        throw std::runtime_error("Indirect draws need indexed meshes of the geometry arena");
+    }
+
+    const MeshLod& range = mesh.lods_[std::min(lod, mesh.lod_count_ - 1)];
+
+    VkDrawIndexedIndirectCommand command{};
+    command.indexCount = range.index_count_;
+    command.instanceCount = 1;
+    command.firstIndex = range.first_index_;
+    command.vertexOffset = mesh.vertex_offset_;
+    command.firstInstance = draw;
+    return command;
+}
+
+} // namespace renderer
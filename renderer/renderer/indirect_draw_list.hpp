@@ -0,0 +1,109 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// vulkan
+#include <vulkan/vulkan.h>
+
+// glm
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// renderer includes
+#include <renderer/renderer/device.hpp>
+#include <renderer/renderer/buffer.hpp>
+#include <renderer/renderer/typed_buffer.hpp>
+#include <renderer/renderer/resource_registry.hpp>
+
+namespace renderer {
+
+// Per draw shader data (std430), read at gl_InstanceIndex: every command's firstInstance is its
+// draw index, see shaders/indirect.vert
+struct DrawData
+{
+    glm::mat4 model_;
+    glm::vec4 color_;
+};
+
+// How Record submits the list, picked from the device features
+enum class IndirectDrawMode
+{
+    IndirectCount,       // one vkCmdDrawIndexedIndirectCount, the count is read from the buffer
+    MultiDrawIndirect,   // one vkCmdDrawIndexedIndirect
+    SingleDrawIndirect,  // one vkCmdDrawIndexedIndirect per draw (no multiDrawIndirect)
+    Direct,              // vkCmdDrawIndexed per draw (no drawIndirectFirstInstance)
+};
+
+const char* ToString(IndirectDrawMode mode);
+
+// Draws of static meshes kept in GPU visible memory, so recording them is a single call however
+// many there are. Every frame in flight owns a region of one persistently mapped buffer:
+//     DrawData[max_draws] | VkDrawIndexedIndirectCommand[max_draws] | bounds[max_draws] | draw count
+// with every array starting at a storage buffer offset alignment, so each can be bound on its own
+// (GpuDrawCuller). bounds are the meshes' object space spheres. The CPU copy is only written to a
+// region when the list changed since that region was written.
+class IndirectDrawList
+{
+public:
+    IndirectDrawList(Device& device, uint32_t frame_count, uint32_t max_draws);
+    ~IndirectDrawList() = default;
+
+    IndirectDrawList(const IndirectDrawList&) = delete;
+    IndirectDrawList& operator=(const IndirectDrawList&) = delete;
+
+    // mesh must be an indexed mesh of the geometry arena, returns the draw index
+    uint32_t AddDraw(const MeshRecord& mesh, const DrawData& data, uint32_t lod = 0);
+    void SetDrawData(uint32_t draw, const DrawData& data);
+    void SetDrawLod(uint32_t draw, const MeshRecord& mesh, uint32_t lod);
+    void Clear();
+
+    // brings the region of frame_index up to date, call once per frame before Record
+    void Prepare(uint32_t frame_index);
+    // The arena geometry (ResourceRegistry::BindGeometry) and the draw data descriptor at
+    // GetRegionOffset must be bound
+    void Record(VkCommandBuffer command_buffer);
+
+    // for VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC bindings, all used with GetRegionOffset
+    VkDescriptorBufferInfo DrawDataDescriptorInfo() { return draw_data_region_.InRegion(buffer_->GetBuffer(), 0).DescriptorInfo(); }
+    VkDescriptorBufferInfo CommandsDescriptorInfo() { return commands_region_.InRegion(buffer_->GetBuffer(), 0).DescriptorInfo(); }
+    VkDescriptorBufferInfo BoundsDescriptorInfo() { return bounds_region_.InRegion(buffer_->GetBuffer(), 0).DescriptorInfo(); }
+    // dynamic offset of the prepared frame's region
+    uint32_t GetRegionOffset() const { return static_cast<uint32_t>(frame_index_ * region_size_); }
+
+    uint32_t GetDrawCount() const { return static_cast<uint32_t>(commands_.size()); }
+    uint32_t GetMaxDraws() const { return max_draws_; }
+    IndirectDrawMode GetMode() const { return mode_; }
+
+private:
+    VkDrawIndexedIndirectCommand MakeCommand(const MeshRecord& mesh, uint32_t lod, uint32_t draw);
+
+private:
+    Device& device_;
+    IndirectDrawMode mode_;
+
+    uint32_t frame_count_;
+    uint32_t max_draws_;
+
+    // layout of one region
+    TypedBufferView<DrawData> draw_data_region_;
+    TypedBufferView<VkDrawIndexedIndirectCommand> commands_region_;
+    TypedBufferView<glm::vec4> bounds_region_;
+    TypedBufferView<uint32_t> count_region_;
+    VkDeviceSize region_size_;
+
+    std::unique_ptr<Buffer> buffer_;
+
+    std::vector<VkDrawIndexedIndirectCommand> commands_;
+    std::vector<DrawData> draw_data_;
+    std::vector<glm::vec4> bounds_;
+
+    // bumped on every change, a region is rewritten when its copy is older
+    uint64_t version_ = 1;
+    std::vector<uint64_t> region_versions_;
+    uint32_t frame_index_ = 0;
+};
+
+} // namespace renderer
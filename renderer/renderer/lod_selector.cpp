@@ -0,0 +1,78 @@
+#include <renderer/renderer/lod_selector.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+
+namespace renderer {
+
+LodSelector::LodSelector(const LodSelectionSettings& settings)
+    : settings_{settings}
+{
+}
+
+void LodSelector::Update(const glm::mat4& view, const glm::mat4& projection, float viewport_height)
+{
+    camera_position_ = glm::vec3(glm::inverse(view)[3]);
+
+    // [1][1] is cot(fov / 2) for perspective and 2 / height for orthographic projections,
+    // the sign only depends on the clip space y convention
+    projection_scale_ = std::fabs(projection[1][1]) * viewport_height * 0.5f;
+    perspective_ = projection[2][3] != 0.0f;
+}
+
+float LodSelector::GetPixelsPerUnit(const glm::vec3& center, float radius) const
+{
+    if (!perspective_)
+    {
+        return projection_scale_;
+    }
+
+    float distance = glm::length(center - camera_position_) - radius;
+    if (distance <= 0.0f)
+    {
+        return -1.0f;
+    }
+    return projection_scale_ / distance;
+}
+
+uint32_t LodSelector::Select(const MeshRecord& mesh, const glm::mat4& model, uint32_t previous_lod) const
+{
+    if (mesh.lod_count_ <= 1)
+    {
+        return 0;
+    }
+
+    // errors and radius grow with the largest axis scale of the model matrix
+    float scale = std::sqrt(std::max({glm::dot(glm::vec3(model[0]), glm::vec3(model[0])),
+                                      glm::dot(glm::vec3(model[1]), glm::vec3(model[1])),
+                                      glm::dot(glm::vec3(model[2]), glm::vec3(model[2]))}));
+    glm::vec3 center = glm::vec3(model * glm::vec4(glm::vec3(mesh.bounding_sphere_), 1.0f));
+
+    float pixels_per_unit = GetPixelsPerUnit(center, mesh.bounding_sphere_.w * scale);
+    if (pixels_per_unit < 0.0f)
+    {
+        return 0;
+    }
+
+    for (uint32_t lod = mesh.lod_count_ - 1; lod > 0; --lod)
+    {
+        float budget = settings_.pixel_error_;
+        if (lod > previous_lod)
+        {
+            budget *= 1.0f - settings_.hysteresis_;
+        }
+        else if (lod == previous_lod)
+        {
+            budget *= 1.0f + settings_.hysteresis_;
+        }
+
+        if (mesh.lods_[lod].error_ * scale * pixels_per_unit <= budget)
+        {
+            return lod;
+        }
+    }
+    return 0;
+}
+
+} // namespace renderer
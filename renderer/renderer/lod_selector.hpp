@@ -0,0 +1,52 @@
+#pragma once
+
+// std
+#include <cstdint>
+
+// glm
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// renderer includes
+#include <renderer/renderer/resource_registry.hpp>
+
+namespace renderer {
+
+struct LodSelectionSettings
+{
+    // largest simplification error allowed on screen, in pixels
+    float pixel_error_ = 1.0f;
+    // A coarser level has to fit (1 - hysteresis_) of the budget and the current level is kept
+    // until it exceeds (1 + hysteresis_), so objects sitting on a threshold do not pop every frame.
+    float hysteresis_ = 0.25f;
+};
+
+// Screen space error LOD selection: a level is good enough when its object space error, projected
+// at the nearest point of the bounding sphere, stays below the pixel budget. Update once per frame
+// with the camera, then select per object with the level it was drawn with last frame.
+class LodSelector
+{
+public:
+    LodSelector(const LodSelectionSettings& settings = LodSelectionSettings{});
+
+    void Update(const glm::mat4& view, const glm::mat4& projection, float viewport_height);
+
+    // pixels covered by a world space length at the nearest point of a world space sphere,
+    // negative when the camera is inside the sphere
+    float GetPixelsPerUnit(const glm::vec3& center, float radius) const;
+
+    uint32_t Select(const MeshRecord& mesh, const glm::mat4& model, uint32_t previous_lod) const;
+
+    const LodSelectionSettings& GetSettings() const { return settings_; }
+    void SetSettings(const LodSelectionSettings& settings) { settings_ = settings; }
+
+private:
+    LodSelectionSettings settings_;
+
+    glm::vec3 camera_position_{0.0f};
+    // perspective: pixels per unit at distance 1, orthographic: pixels per unit
+    float projection_scale_ = 0.0f;
+    bool perspective_ = true;
+};
+
+} // namespace renderer
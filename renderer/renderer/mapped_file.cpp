@@ -0,0 +1,61 @@
+#include <renderer/renderer/mapped_file.hpp>
+
+// std
+#include <stdexcept>
+
+// posix
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace renderer {
+
+MappedFile::MappedFile(const std::string& path)
+    : path_{path}
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+
+    struct stat file_stat{};
+    if (fstat(fd, &file_stat) != 0)
+    {
+        close(fd);
+        throw std::runtime_error("Failed to stat file: " + path);
+    }
+
+    size_ = static_cast<size_t>(file_stat.st_size);
+    if (size_ == 0)
+    {
+        close(fd);
+        return;
+    }
+
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        throw std::runtime_error("Failed to map file: " + path);
+    }
+
+    // the file is read front to back once, let the kernel read ahead
+    madvise(mapping, size_, MADV_SEQUENTIAL);
+    madvise(mapping, size_, MADV_WILLNEED);
+
+    data_ = static_cast<const std::byte*>(mapping);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_ != nullptr)
+    {
+        munmap(const_cast<std::byte*>(data_), size_);
+    }
+}
+
+} // namespace renderer
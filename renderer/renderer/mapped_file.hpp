@@ -0,0 +1,32 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace renderer {
+
+// Read only memory mapping of a whole file. Pages are faulted in on first access,
+// so reading the mapping costs I/O and no parsing or intermediate copies.
+class MappedFile
+{
+public:
+    MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::byte* GetData() const { return data_; }
+    size_t GetSize() const { return size_; }
+    std::span<const std::byte> GetBytes() const { return {data_, size_}; }
+    const std::string& GetPath() const { return path_; }
+
+private:
+    std::string path_;
+    const std::byte* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace renderer
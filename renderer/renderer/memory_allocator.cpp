@@ -0,0 +1,376 @@
+#include <renderer/renderer/memory_allocator.hpp>
+
+// std
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace renderer {
+
+namespace {
+
+VkDeviceSize RoundUpToPowerOfTwo(VkDeviceSize value)
+{
+    VkDeviceSize result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+VkDeviceSize RoundDownToPowerOfTwo(VkDeviceSize value)
+{
+    VkDeviceSize result = 1;
+    while ((result << 1) != 0 && (result << 1) <= value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+MemoryAllocator::MemoryAllocator(VkDevice device, VkPhysicalDevice physical_device, VkDeviceSize block_size)
+    : device_{device}
+    , block_size_{RoundUpToPowerOfTwo(std::max(block_size, s_min_allocation_size_))}
+{
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties_);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+    limits_ = properties.limits;
+}
+
+MemoryAllocator::~MemoryAllocator()
+{
+    if (stats_.allocation_count_ != 0)
+    {
+        std::cerr << "MemoryAllocator destroyed with " << stats_.allocation_count_ << " live allocations" << std::endl;
+    }
+
+    for (auto& pool : pools_)
+    {
+        for (uint32_t i = 0; i < pool.blocks_.size(); ++i)
+        {
+            if (pool.blocks_[i])
+            {
+                DestroyBlock(pool, i);
+            }
+        }
+    }
+}
+
+Allocation MemoryAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, AllocationKind kind)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint32_t memory_type = FindMemoryType(requirements.memoryTypeBits, properties);
+    uint32_t pool_index = GetPool(memory_type, kind);
+    Pool& pool = pools_[pool_index];
+
+    Allocation allocation{};
+    allocation.size_ = requirements.size;
+    allocation.pool_index_ = pool_index;
+
+    // buddy ranges are aligned to their own size, so rounding up to the alignment is enough
+    VkDeviceSize rounded = RoundUpToPowerOfTwo(std::max({requirements.size, requirements.alignment, s_min_allocation_size_}));
+
+    if (rounded > pool.block_size_)
+    {
+        allocation.block_index_ = CreateBlock(pool, requirements.size, true);
+        allocation.order_ = s_dedicated_order_;
+    }
+    else
+    {
+        allocation.order_ = OrderForSize(rounded);
+
+        bool found = false;
+        for (uint32_t i = 0; i < pool.blocks_.size() && !found; ++i)
+        {
+            Block* block = pool.blocks_[i].get();
+            if (block && !block->dedicated_ && TryAllocateFromBlock(*block, allocation.order_, allocation.offset_))
+            {
+                allocation.block_index_ = i;
+                found = true;
+            }
+        }
+
+        if (!found)
+        {
+            allocation.block_index_ = CreateBlock(pool, pool.block_size_, false);
+            TryAllocateFromBlock(*pool.blocks_[allocation.block_index_], allocation.order_, allocation.offset_);
+        }
+
+        stats_.bytes_wasted_ += rounded - requirements.size;
+    }
+
+    Block& block = *pool.blocks_[allocation.block_index_];
+    ++block.allocation_count_;
+
+    allocation.memory_ = block.memory_;
+    if (block.mapped_)
+    {
+        allocation.mapped_ = static_cast<char*>(block.mapped_) + allocation.offset_;
+    }
+
+    stats_.bytes_used_ += requirements.size;
+    ++stats_.allocation_count_;
+
+    return allocation;
+}
+
+void MemoryAllocator::Free(Allocation& allocation)
+{
+    if (allocation.memory_ == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Pool& pool = pools_[allocation.pool_index_];
+    Block& block = *pool.blocks_[allocation.block_index_];
+
+    stats_.bytes_used_ -= allocation.size_;
+    --stats_.allocation_count_;
+    --block.allocation_count_;
+
+    if (allocation.order_ == s_dedicated_order_)
+    {
+        DestroyBlock(pool, allocation.block_index_);
+    }
+    else
+    {
+        stats_.bytes_wasted_ -= SizeForOrder(allocation.order_) - allocation.size_;
+        FreeToBlock(block, allocation.offset_, allocation.order_);
+
+        // keep one empty block per pool around to avoid vkAllocateMemory churn
+        if (block.allocation_count_ == 0)
+        {
+            uint32_t empty_blocks = 0;
+            for (auto& other : pool.blocks_)
+            {
+                if (other && !other->dedicated_ && other->allocation_count_ == 0)
+                {
+                    ++empty_blocks;
+                }
+            }
+
+            if (empty_blocks > 1)
+            {
+                DestroyBlock(pool, allocation.block_index_);
+            }
+        }
+    }
+
+    allocation = Allocation{};
+}
+
+VkResult MemoryAllocator::Flush(const Allocation& allocation, VkDeviceSize size, VkDeviceSize offset)
+{
+    VkDeviceSize atom = limits_.nonCoherentAtomSize;
+    VkDeviceSize reserved = allocation.order_ == s_dedicated_order_ ? VK_WHOLE_SIZE : SizeForOrder(allocation.order_);
+
+    VkMappedMemoryRange mapped_range = {};
+    mapped_range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    mapped_range.memory = allocation.memory_;
+
+    VkDeviceSize begin = allocation.offset_ + offset;
+    mapped_range.offset = begin / atom * atom;
+
+    if (size == VK_WHOLE_SIZE)
+    {
+        mapped_range.size = reserved == VK_WHOLE_SIZE ? VK_WHOLE_SIZE : allocation.offset_ + reserved - mapped_range.offset;
+    }
+    else
+    {
+        // buddy ranges are at least s_min_allocation_size_ and nonCoherentAtomSize is at most 256,
+        // so widening never leaves the range reserved for this allocation
+        VkDeviceSize end = (begin + size + atom - 1) / atom * atom;
+        mapped_range.size = end - mapped_range.offset;
+    }
+
+    return vkFlushMappedMemoryRanges(device_, 1, &mapped_range);
+}
+
+uint32_t MemoryAllocator::FindMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties)
+{
+    for (uint32_t i = 0; i < memory_properties_.memoryTypeCount; i++)
+    {
+        if ((type_filter & (1 << i)) && (memory_properties_.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+AllocatorStats MemoryAllocator::GetStats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void MemoryAllocator::PrintStats()
+{
+    AllocatorStats stats = GetStats();
+
+    std::cout << "GPU memory: " << stats.allocation_count_ << " allocations in "
+              << stats.block_count_ << " blocks, "
+              << stats.bytes_used_ / 1024 << " KiB used, "
+              << stats.bytes_wasted_ / 1024 << " KiB wasted, "
+              << stats.bytes_reserved_ / 1024 << " KiB reserved" << std::endl;
+}
+
+uint32_t MemoryAllocator::GetPool(uint32_t memory_type, AllocationKind kind)
+{
+    for (uint32_t i = 0; i < pools_.size(); ++i)
+    {
+        if (pools_[i].memory_type_ == memory_type && pools_[i].kind_ == kind)
+        {
+            return i;
+        }
+    }
+
+    // small heaps (e.g. host visible device local memory) get proportionally smaller blocks
+    uint32_t heap_index = memory_properties_.memoryTypes[memory_type].heapIndex;
+    VkDeviceSize heap_size = memory_properties_.memoryHeaps[heap_index].size;
+
+    Pool pool{};
+    pool.memory_type_ = memory_type;
+    pool.kind_ = kind;
+    pool.block_size_ = std::max(std::min(block_size_, RoundDownToPowerOfTwo(heap_size / 8)), s_min_allocation_size_);
+
+    pools_.push_back(std::move(pool));
+    return static_cast<uint32_t>(pools_.size() - 1);
+}
+
+uint32_t MemoryAllocator::CreateBlock(Pool& pool, VkDeviceSize size, bool dedicated)
+{
+    if (stats_.block_count_ >= limits_.maxMemoryAllocationCount)
+    {
+        throw std::runtime_error("exceeded maxMemoryAllocationCount!");
+    }
+
+    auto block = std::make_unique<Block>();
+    block->size_ = size;
+    block->dedicated_ = dedicated;
+
+    VkMemoryAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = size;
+    alloc_info.memoryTypeIndex = pool.memory_type_;
+
+    if (vkAllocateMemory(device_, &alloc_info, nullptr, &block->memory_) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate memory block!");
+    }
+
+    if (memory_properties_.memoryTypes[pool.memory_type_].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        if (vkMapMemory(device_, block->memory_, 0, VK_WHOLE_SIZE, 0, &block->mapped_) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to map memory block!");
+        }
+    }
+
+    if (!dedicated)
+    {
+        uint32_t top_order = OrderForSize(size);
+        block->free_lists_.resize(top_order + 1);
+        block->free_lists_[top_order].insert(0);
+    }
+
+    ++stats_.block_count_;
+    stats_.bytes_reserved_ += size;
+
+    for (uint32_t i = 0; i < pool.blocks_.size(); ++i)
+    {
+        if (!pool.blocks_[i])
+        {
+            pool.blocks_[i] = std::move(block);
+            return i;
+        }
+    }
+
+    pool.blocks_.push_back(std::move(block));
+    return static_cast<uint32_t>(pool.blocks_.size() - 1);
+}
+
+void MemoryAllocator::DestroyBlock(Pool& pool, uint32_t block_index)
+{
+    Block& block = *pool.blocks_[block_index];
+
+    if (block.mapped_)
+    {
+        vkUnmapMemory(device_, block.memory_);
+    }
+    vkFreeMemory(device_, block.memory_, nullptr);
+
+    --stats_.block_count_;
+    stats_.bytes_reserved_ -= block.size_;
+
+    pool.blocks_[block_index].reset();
+}
+
+bool MemoryAllocator::TryAllocateFromBlock(Block& block, uint32_t order, VkDeviceSize& offset)
+{
+    uint32_t current = order;
+    while (current < block.free_lists_.size() && block.free_lists_[current].empty())
+    {
+        ++current;
+    }
+
+    if (current >= block.free_lists_.size())
+    {
+        return false;
+    }
+
+    // lowest offset first keeps the upper part of the block free for large requests
+    auto it = block.free_lists_[current].begin();
+    offset = *it;
+    block.free_lists_[current].erase(it);
+
+    // split down to the requested order, returning the upper halves to the free lists
+    while (current > order)
+    {
+        --current;
+        block.free_lists_[current].insert(offset + SizeForOrder(current));
+    }
+
+    return true;
+}
+
+void MemoryAllocator::FreeToBlock(Block& block, VkDeviceSize offset, uint32_t order)
+{
+    // merge with the buddy while it is free
+    while (order + 1 < block.free_lists_.size())
+    {
+        VkDeviceSize buddy = offset ^ SizeForOrder(order);
+        auto it = block.free_lists_[order].find(buddy);
+        if (it == block.free_lists_[order].end())
+        {
+            break;
+        }
+
+        block.free_lists_[order].erase(it);
+        offset = std::min(offset, buddy);
+        ++order;
+    }
+
+    block.free_lists_[order].insert(offset);
+}
+
+uint32_t MemoryAllocator::OrderForSize(VkDeviceSize size)
+{
+    uint32_t order = 0;
+    while (SizeForOrder(order) < size)
+    {
+        ++order;
+    }
+    return order;
+}
+
+} // namespace renderer
@@ -0,0 +1,121 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+// vulkan
+#include <vulkan/vulkan.h>
+
+namespace renderer {
+
+// Resources bound to an allocation. Linear (buffers, linear images) and optimal (images)
+// resources are served from separate blocks, so they never share a bufferImageGranularity page.
+enum class AllocationKind
+{
+    Linear,
+    Optimal
+};
+
+struct Allocation
+{
+    VkDeviceMemory memory_ = VK_NULL_HANDLE;
+    VkDeviceSize offset_ = 0;
+    VkDeviceSize size_ = 0;
+
+    // persistently mapped pointer to offset_, nullptr for memory that is not host visible
+    void* mapped_ = nullptr;
+
+    // bookkeeping for MemoryAllocator::Free
+    uint32_t pool_index_ = 0;
+    uint32_t block_index_ = 0;
+    uint32_t order_ = 0;
+};
+
+struct AllocatorStats
+{
+    VkDeviceSize bytes_used_ = 0;      // requested by resources
+    VkDeviceSize bytes_wasted_ = 0;    // padding from rounding allocations up to buddy sizes
+    VkDeviceSize bytes_reserved_ = 0;  // device memory held by blocks
+    uint32_t block_count_ = 0;         // vkAllocateMemory calls currently alive
+    uint32_t allocation_count_ = 0;
+};
+
+// Sub-allocates resources from large per-memory-type blocks with a buddy allocator.
+// Requests bigger than a block get a dedicated vkAllocateMemory.
+class MemoryAllocator
+{
+public:
+    static constexpr VkDeviceSize s_default_block_size_ = 64ull * 1024 * 1024;
+    static constexpr VkDeviceSize s_min_allocation_size_ = 256;
+
+public:
+    MemoryAllocator(VkDevice device, VkPhysicalDevice physical_device, VkDeviceSize block_size = s_default_block_size_);
+    ~MemoryAllocator();
+
+    MemoryAllocator(const MemoryAllocator&) = delete;
+    MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+    Allocation Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, AllocationKind kind);
+    void Free(Allocation& allocation);
+
+    // flushes a host visible, non coherent range, widened to nonCoherentAtomSize
+    VkResult Flush(const Allocation& allocation, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+
+    uint32_t FindMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties);
+
+    AllocatorStats GetStats();
+    void PrintStats();
+
+private:
+    struct Block
+    {
+        VkDeviceMemory memory_ = VK_NULL_HANDLE;
+        void* mapped_ = nullptr;
+        VkDeviceSize size_ = 0;
+        uint32_t allocation_count_ = 0;
+        bool dedicated_ = false;
+
+        // free offsets per buddy order, order k holds s_min_allocation_size_ << k sized ranges
+        std::vector<std::set<VkDeviceSize>> free_lists_;
+    };
+
+    struct Pool
+    {
+        uint32_t memory_type_ = 0;
+        AllocationKind kind_ = AllocationKind::Linear;
+        VkDeviceSize block_size_ = 0;
+
+        // freed blocks leave a nullptr slot so Allocation::block_index_ stays valid
+        std::vector<std::unique_ptr<Block>> blocks_;
+    };
+
+private:
+    uint32_t GetPool(uint32_t memory_type, AllocationKind kind);
+    uint32_t CreateBlock(Pool& pool, VkDeviceSize size, bool dedicated);
+    void DestroyBlock(Pool& pool, uint32_t block_index);
+
+    bool TryAllocateFromBlock(Block& block, uint32_t order, VkDeviceSize& offset);
+    void FreeToBlock(Block& block, VkDeviceSize offset, uint32_t order);
+
+    uint32_t OrderForSize(VkDeviceSize size);
+    VkDeviceSize SizeForOrder(uint32_t order) { return s_min_allocation_size_ << order; }
+
+private:
+    static constexpr uint32_t s_dedicated_order_ = UINT32_MAX;
+
+    VkDevice device_;
+    VkPhysicalDeviceMemoryProperties memory_properties_{};
+    VkPhysicalDeviceLimits limits_{};
+    VkDeviceSize block_size_;
+
+    std::vector<Pool> pools_;
+    AllocatorStats stats_{};
+
+    std::mutex mutex_;
+};
+
+} // namespace renderer
@@ -0,0 +1,650 @@
+#include <renderer/renderer/mesh/mesh_importer.hpp>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+// renderer includes
+#include <renderer/renderer/mapped_file.hpp>
+#include <renderer/renderer/parallel_for.hpp>
+#include <renderer/renderer/mesh/json.hpp>
+
+namespace renderer::mesh {
+
+namespace {
+
+constexpr uint32_t s_glb_magic = 0x46546c67;        // "glTF"
+constexpr uint32_t s_glb_json_chunk = 0x4e4f534a;   // "JSON"
+constexpr uint32_t s_glb_binary_chunk = 0x004e4942; // "BIN\0"
+
+// accessor elements decoded per task
+constexpr size_t s_elements_per_task = 1 << 16;
+
+enum ComponentType : uint32_t
+{
+    Byte = 5120,
+    UnsignedByte = 5121,
+    Short = 5122,
+    UnsignedShort = 5123,
+    UnsignedInt = 5125,
+    Float = 5126,
+};
+
+constexpr uint32_t s_mode_triangles = 4;
+
+// largest double every smaller integer of which is exact
+constexpr double s_max_exact_integer = 9007199254740992.0;
+
+// Byte offsets, lengths, strides and counts arrive as JSON doubles: anything negative,
+// fractional or too large to be exact is rejected before it becomes a size_t
+size_t GetSize(const JsonValue& json, std::string_view key)
+{
+    const JsonValue* value = json.Find(key);
+    if (value == nullptr)
+    {
+        return 0;
+    }
+
+    double number = value->GetNumber(-1.0);
+    if (!(number >= 0.0) || number > s_max_exact_integer || std::floor(number) != number
+        || number > static_cast<double>(std::numeric_limits<size_t>::max()))
+    {
+        throw std::runtime_error("glTF " + std::string(key) + " is not a non negative integer");
+    }
+    return static_cast<size_t>(number);
+}
+
+// accessor size arithmetic, throwing instead of wrapping
+size_t CheckedMultiply(size_t a, size_t b)
+{
+    if (b != 0 && a > std::numeric_limits<size_t>::max() / b)
+    {
+        throw std::runtime_error("glTF accessor exceeds its buffer");
+    }
+    return a * b;
+}
+
+size_t CheckedAdd(size_t a, size_t b)
+{
+    if (a > std::numeric_limits<size_t>::max() - b)
+    {
+        throw std::runtime_error("glTF accessor exceeds its buffer");
+    }
+    return a + b;
+}
+
+struct GltfDocument
+{
+    JsonValue json_;
+
+    // storage backing buffers_
+    std::vector<std::unique_ptr<MappedFile>> files_;
+    std::vector<std::vector<std::byte>> decoded_;
+
+    std::vector<std::span<const std::byte>> buffers_;
+};
+
+struct Accessor
+{
+    const std::byte* data_ = nullptr;
+    size_t count_ = 0;
+    size_t stride_ = 0;
+    uint32_t component_type_ = Float;
+    uint32_t component_count_ = 0;
+    bool normalized_ = false;
+};
+
+enum class AttributeKind
+{
+    Position,
+    Normal,
+    Tangent,
+    TexCoord,
+    Color,
+    Indices,
+};
+
+struct Primitive
+{
+    int64_t attributes_[5] = {-1, -1, -1, -1, -1};
+    int64_t indices_ = -1;
+
+    uint32_t material_ = 0;
+    size_t vertex_count_ = 0;
+    size_t index_count_ = 0;
+
+    // placement in the merged mesh
+    size_t first_vertex_ = 0;
+    size_t first_index_ = 0;
+};
+
+struct DecodeTask
+{
+    size_t primitive_;
+    AttributeKind kind_;
+    size_t begin_;
+    size_t end_;
+};
+
+uint32_t ComponentSize(uint32_t component_type)
+{
+    switch (component_type)
+    {
+    case Byte:
+    case UnsignedByte: return 1;
+    case Short:
+    case UnsignedShort: return 2;
+    case UnsignedInt:
+    case Float: return 4;
+    }
+    throw std::runtime_error("Unsupported glTF component type " + std::to_string(component_type));
+}
+
+uint32_t ComponentCount(const std::string& type)
+{
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    throw std::runtime_error("Unsupported glTF accessor type " + type);
+}
+
+std::vector<std::byte> DecodeBase64(std::string_view text)
+{
+    auto value = [](char c) -> int
+    {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        return -1;
+    };
+
+    std::vector<std::byte> result;
+    result.reserve(text.size() / 4 * 3);
+
+    uint32_t bits = 0;
+    int bit_count = 0;
+    for (char c : text)
+    {
+        int v = value(c);
+        if (v < 0)
+        {
+            // padding ends the data, whitespace is skipped
+            if (c == '=')
+            {
+                break;
+            }
+            continue;
+        }
+
+        bits = (bits << 6) | static_cast<uint32_t>(v);
+        bit_count += 6;
+        if (bit_count >= 8)
+        {
+            bit_count -= 8;
+            result.push_back(static_cast<std::byte>((bits >> bit_count) & 0xff));
+        }
+    }
+
+    return result;
+}
+
+uint32_t ReadU32(const std::byte* data)
+{
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// JSON text of a .gltf or .glb, binary_chunk receives the glb binary chunk if there is one
+std::string_view SplitContainer(std::span<const std::byte> bytes, const std::string& path, std::span<const std::byte>& binary_chunk)
+{
+    std::string_view json_text;
+    if (bytes.size() >= 12 && ReadU32(bytes.data()) == s_glb_magic)
+    {
+        // .glb: 12 byte header, JSON chunk, optional binary chunk
+        size_t offset = 12;
+        while (offset + 8 <= bytes.size())
+        {
+            uint32_t chunk_length = ReadU32(bytes.data() + offset);
+            uint32_t chunk_type = ReadU32(bytes.data() + offset + 4);
+            offset += 8;
+
+            if (chunk_length > bytes.size() - offset)
+            {
+                throw std::runtime_error("Truncated glb chunk: " + path);
+            }
+
+            if (chunk_type == s_glb_json_chunk)
+            {
+                json_text = std::string_view(reinterpret_cast<const char*>(bytes.data() + offset), chunk_length);
+            }
+            else if (chunk_type == s_glb_binary_chunk)
+            {
+                binary_chunk = bytes.subspan(offset, chunk_length);
+            }
+            offset += (chunk_length + 3) & ~3u;
+        }
+    }
+    else
+    {
+        json_text = std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+
+    return json_text;
+}
+
+bool IsDataUri(const std::string& uri)
+{
+    return uri.rfind("data:", 0) == 0;
+}
+
+GltfDocument LoadDocument(const std::string& path, std::unique_ptr<MappedFile> file)
+{
+    GltfDocument document{};
+
+    std::span<const std::byte> binary_chunk;
+    document.json_ = JsonValue::Parse(SplitContainer(file->GetBytes(), path, binary_chunk));
+    document.files_.push_back(std::move(file));
+
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+
+    if (const JsonValue* buffers = document.json_.Find("buffers"))
+    {
+        for (const JsonValue& buffer : buffers->GetArray())
+        {
+            size_t byte_length = GetSize(buffer, "byteLength");
+            const JsonValue* uri = buffer.Find("uri");
+
+            std::span<const std::byte> data;
+            if (uri == nullptr)
+            {
+                // the glb binary chunk, which may be padded past byteLength
+                data = binary_chunk;
+            }
+            else if (IsDataUri(uri->GetString()))
+            {
+                const std::string& text = uri->GetString();
+                size_t comma = text.find(',');
+                if (comma == std::string::npos || text.find(";base64") > comma)
+                {
+                    throw std::runtime_error("Unsupported glTF data URI: " + path);
+                }
+
+                document.decoded_.push_back(DecodeBase64(std::string_view(text).substr(comma + 1)));
+                data = document.decoded_.back();
+            }
+            else
+            {
+                document.files_.push_back(std::make_unique<MappedFile>((directory / uri->GetString()).string()));
+                data = document.files_.back()->GetBytes();
+            }
+
+            if (data.size() < byte_length)
+            {
+                throw std::runtime_error("glTF buffer shorter than its byteLength: " + path);
+            }
+            document.buffers_.push_back(data.first(byte_length));
+        }
+    }
+
+    return document;
+}
+
+Accessor GetAccessor(const GltfDocument& document, int64_t index)
+{
+    const JsonValue* accessors = document.json_.Find("accessors");
+    if (accessors == nullptr || index < 0 || static_cast<size_t>(index) >= accessors->Size())
+    {
+        throw std::runtime_error("glTF accessor index out of range");
+    }
+
+    const JsonValue& json = (*accessors)[static_cast<size_t>(index)];
+    if (json.Find("sparse") != nullptr)
+    {
+        throw std::runtime_error("Sparse glTF accessors are not supported");
+    }
+
+    Accessor accessor{};
+    accessor.count_ = GetSize(json, "count");
+    accessor.component_type_ = static_cast<uint32_t>(json.GetInt("componentType", Float));
+    accessor.component_count_ = ComponentCount(json.Find("type") ? json.Find("type")->GetString() : "");
+    accessor.normalized_ = json.Find("normalized") ? json.Find("normalized")->GetBool() : false;
+
+    size_t element_size = ComponentSize(accessor.component_type_) * accessor.component_count_;
+
+    const JsonValue* views = document.json_.Find("bufferViews");
+    int64_t view_index = json.GetInt("bufferView", -1);
+    if (views == nullptr || view_index < 0 || static_cast<size_t>(view_index) >= views->Size())
+    {
+        throw std::runtime_error("glTF accessor without a valid buffer view");
+    }
+
+    const JsonValue& view = (*views)[static_cast<size_t>(view_index)];
+    int64_t buffer_index = view.GetInt("buffer", -1);
+    if (buffer_index < 0 || static_cast<size_t>(buffer_index) >= document.buffers_.size())
+    {
+        throw std::runtime_error("glTF buffer view without a valid buffer");
+    }
+
+    std::span<const std::byte> buffer = document.buffers_[static_cast<size_t>(buffer_index)];
+    size_t view_offset = GetSize(view, "byteOffset");
+    size_t view_length = GetSize(view, "byteLength");
+    size_t accessor_offset = GetSize(json, "byteOffset");
+
+    accessor.stride_ = GetSize(view, "byteStride");
+    if (accessor.stride_ == 0)
+    {
+        accessor.stride_ = element_size;
+    }
+
+    size_t required = 0;
+    if (accessor.count_ > 0)
+    {
+        required = CheckedAdd(CheckedAdd(CheckedMultiply(accessor.count_ - 1, accessor.stride_), element_size), accessor_offset);
+    }
+    if (view_offset > buffer.size() || view_length > buffer.size() - view_offset || required > view_length)
+    {
+        throw std::runtime_error("glTF accessor exceeds its buffer");
+    }
+
+    accessor.data_ = buffer.data() + view_offset + accessor_offset;
+    return accessor;
+}
+
+float ReadComponent(const std::byte* data, uint32_t component_type, bool normalized)
+{
+    switch (component_type)
+    {
+    case Float:
+    {
+        float value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    case UnsignedByte:
+    {
+        uint8_t value = static_cast<uint8_t>(*data);
+        return normalized ? value / 255.0f : value;
+    }
+    case Byte:
+    {
+        int8_t value = static_cast<int8_t>(*data);
+        return normalized ? std::max(value / 127.0f, -1.0f) : value;
+    }
+    case UnsignedShort:
+    {
+        uint16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return normalized ? value / 65535.0f : value;
+    }
+    case Short:
+    {
+        int16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+    }
+    case UnsignedInt:
+    {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return static_cast<float>(value);
+    }
+    }
+    return 0.0f;
+}
+
+glm::vec4 ReadElement(const Accessor& accessor, size_t index, glm::vec4 fallback)
+{
+    const std::byte* element = accessor.data_ + index * accessor.stride_;
+    uint32_t component_size = ComponentSize(accessor.component_type_);
+
+    glm::vec4 value = fallback;
+    for (uint32_t i = 0; i < accessor.component_count_; ++i)
+    {
+        value[i] = ReadComponent(element + i * component_size, accessor.component_type_, accessor.normalized_);
+    }
+    return value;
+}
+
+uint32_t ReadIndex(const Accessor& accessor, size_t index)
+{
+    const std::byte* element = accessor.data_ + index * accessor.stride_;
+    switch (accessor.component_type_)
+    {
+    case UnsignedByte: return static_cast<uint8_t>(*element);
+    case UnsignedShort:
+    {
+        uint16_t value;
+        std::memcpy(&value, element, sizeof(value));
+        return value;
+    }
+    case UnsignedInt: return ReadU32(element);
+    }
+    throw std::runtime_error("Invalid glTF index component type");
+}
+
+void Decode(const GltfDocument& document, const Primitive& primitive, const DecodeTask& task, ImportedMesh& mesh)
+{
+    if (task.kind_ == AttributeKind::Indices)
+    {
+        uint32_t* indices = mesh.indices_.data() + primitive.first_index_;
+        uint32_t first_vertex = static_cast<uint32_t>(primitive.first_vertex_);
+
+        if (primitive.indices_ < 0)
+        {
+            for (size_t i = task.begin_; i < task.end_; ++i)
+            {
+                indices[i] = first_vertex + static_cast<uint32_t>(i);
+            }
+            return;
+        }
+
+        Accessor accessor = GetAccessor(document, primitive.indices_);
+        for (size_t i = task.begin_; i < task.end_; ++i)
+        {
+            uint32_t index = ReadIndex(accessor, i);
+            if (index >= primitive.vertex_count_)
+            {
+                throw std::runtime_error("glTF index out of range");
+            }
+            indices[i] = first_vertex + index;
+        }
+        return;
+    }
+
+    Accessor accessor = GetAccessor(document, primitive.attributes_[static_cast<size_t>(task.kind_)]);
+    if (accessor.count_ < primitive.vertex_count_)
+    {
+        throw std::runtime_error("glTF attribute shorter than POSITION");
+    }
+
+    MeshVertex* vertices = mesh.vertices_.data() + primitive.first_vertex_;
+    for (size_t i = task.begin_; i < task.end_; ++i)
+    {
+        switch (task.kind_)
+        {
+        case AttributeKind::Position: vertices[i].pos_ = glm::vec3(ReadElement(accessor, i, glm::vec4(0.0f))); break;
+        case AttributeKind::Normal: vertices[i].normal_ = glm::vec3(ReadElement(accessor, i, glm::vec4(0.0f))); break;
+        case AttributeKind::Tangent: vertices[i].tangent_ = ReadElement(accessor, i, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)); break;
+        case AttributeKind::TexCoord:
+        {
+            glm::vec4 uv = ReadElement(accessor, i, glm::vec4(0.0f));
+            vertices[i].uv_ = glm::vec2(uv.x, uv.y);
+            break;
+        }
+        case AttributeKind::Color: vertices[i].col_ = ReadElement(accessor, i, glm::vec4(1.0f)); break;
+        default: break;
+        }
+    }
+}
+
+} // namespace
+
+std::vector<std::string> GetGltfDependencies(const std::string& path)
+{
+    MappedFile file(path);
+
+    std::span<const std::byte> binary_chunk;
+    JsonValue json = JsonValue::Parse(SplitContainer(file.GetBytes(), path, binary_chunk));
+
+    std::vector<std::string> dependencies;
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    if (const JsonValue* buffers = json.Find("buffers"))
+    {
+        for (const JsonValue& buffer : buffers->GetArray())
+        {
+            const JsonValue* uri = buffer.Find("uri");
+            if (uri != nullptr && !IsDataUri(uri->GetString()))
+            {
+                dependencies.push_back((directory / uri->GetString()).string());
+            }
+        }
+    }
+    return dependencies;
+}
+
+ImportedMesh ImportGltf(const std::string& path, const ImportOptions& options)
+{
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    auto file = std::make_unique<MappedFile>(path);
+    size_t source_bytes = file->GetSize();
+
+    GltfDocument document = LoadDocument(path, std::move(file));
+
+    // gather triangle primitives and place them in the merged buffers
+    std::vector<Primitive> primitives;
+    size_t vertex_total = 0;
+    size_t index_total = 0;
+
+    static const char* s_attribute_names[] = {"POSITION", "NORMAL", "TANGENT", "TEXCOORD_0", "COLOR_0"};
+
+    if (const JsonValue* meshes = document.json_.Find("meshes"))
+    {
+        for (const JsonValue& json_mesh : meshes->GetArray())
+        {
+            const JsonValue* json_primitives = json_mesh.Find("primitives");
+            if (json_primitives == nullptr)
+            {
+                continue;
+            }
+
+            for (const JsonValue& json_primitive : json_primitives->GetArray())
+            {
+                if (json_primitive.GetInt("mode", s_mode_triangles) != s_mode_triangles)
+                {
+                    continue;
+                }
+
+                const JsonValue* attributes = json_primitive.Find("attributes");
+                if (attributes == nullptr || attributes->Find("POSITION") == nullptr)
+                {
+                    continue;
+                }
+
+                Primitive primitive{};
+                for (size_t i = 0; i < std::size(s_attribute_names); ++i)
+                {
+                    primitive.attributes_[i] = attributes->GetInt(s_attribute_names[i], -1);
+                }
+                primitive.indices_ = json_primitive.GetInt("indices", -1);
+                primitive.material_ = static_cast<uint32_t>(std::max<int64_t>(json_primitive.GetInt("material", 0), 0));
+
+                primitive.vertex_count_ = GetAccessor(document, primitive.attributes_[0]).count_;
+                primitive.index_count_ = primitive.indices_ >= 0 ? GetAccessor(document, primitive.indices_).count_ : primitive.vertex_count_;
+                primitive.index_count_ -= primitive.index_count_ % 3;
+
+                primitive.first_vertex_ = vertex_total;
+                primitive.first_index_ = index_total;
+                vertex_total += primitive.vertex_count_;
+                index_total += primitive.index_count_;
+
+                primitives.push_back(primitive);
+            }
+        }
+    }
+
+    ImportedMesh mesh{};
+    mesh.vertices_.resize(vertex_total);
+    mesh.indices_.resize(index_total);
+
+    // one task per attribute range, every task writes a disjoint range of the merged buffers
+    std::vector<DecodeTask> tasks;
+    for (size_t p = 0; p < primitives.size(); ++p)
+    {
+        const Primitive& primitive = primitives[p];
+
+        auto add_tasks = [&](AttributeKind kind, size_t count)
+        {
+            for (size_t begin = 0; begin < count; begin += s_elements_per_task)
+            {
+                tasks.push_back(DecodeTask{p, kind, begin, std::min(count, begin + s_elements_per_task)});
+            }
+        };
+
+        for (size_t i = 0; i < std::size(s_attribute_names); ++i)
+        {
+            if (primitive.attributes_[i] >= 0)
+            {
+                add_tasks(static_cast<AttributeKind>(i), primitive.vertex_count_);
+            }
+        }
+        add_tasks(AttributeKind::Indices, primitive.index_count_);
+
+        mesh.submeshes_.push_back(MeshFileSubmesh{
+            static_cast<uint32_t>(primitive.first_index_), static_cast<uint32_t>(primitive.index_count_), primitive.material_, 0, {}, {}});
+    }
+
+    uint32_t worker_count = GetWorkerCount(options.thread_count_);
+    ParallelFor(tasks.size(), worker_count, [&](size_t i)
+    {
+        Decode(document, primitives[tasks[i].primitive_], tasks[i], mesh);
+    });
+
+    // primitives without normals
+    if (options.generate_normals_)
+    {
+        for (const Primitive& primitive : primitives)
+        {
+            if (primitive.attributes_[static_cast<size_t>(AttributeKind::Normal)] >= 0)
+            {
+                continue;
+            }
+
+            auto first = mesh.vertices_.begin() + primitive.first_vertex_;
+            std::vector<MeshVertex> vertices(first, first + primitive.vertex_count_);
+            std::vector<uint32_t> indices(mesh.indices_.begin() + primitive.first_index_,
+                                          mesh.indices_.begin() + primitive.first_index_ + primitive.index_count_);
+            for (uint32_t& index : indices)
+            {
+                index -= static_cast<uint32_t>(primitive.first_vertex_);
+            }
+
+            GenerateNormals(vertices, indices);
+            std::copy(vertices.begin(), vertices.end(), first);
+        }
+    }
+
+    // the document itself plus external and embedded buffers
+    mesh.stats_.source_bytes_ = source_bytes;
+    for (size_t i = 1; i < document.files_.size(); ++i)
+    {
+        mesh.stats_.source_bytes_ += document.files_[i]->GetSize();
+    }
+    mesh.stats_.triangle_count_ = mesh.indices_.size() / 3;
+    mesh.stats_.thread_count_ = std::min<uint32_t>(worker_count, static_cast<uint32_t>(std::max<size_t>(tasks.size(), 1)));
+    mesh.stats_.seconds_ = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+
+    return mesh;
+}
+
+} // namespace renderer::mesh
@@ -0,0 +1,283 @@
+#include <renderer/renderer/mesh/json.hpp>
+
+// std
+#include <charconv>
+#include <stdexcept>
+
+namespace renderer::mesh {
+
+class JsonValue::Parser
+{
+public:
+    Parser(std::string_view text)
+        : text_{text}
+    {}
+
+    JsonValue ParseDocument()
+    {
+        JsonValue value = ParseValue(0);
+        SkipWhitespace();
+        if (position_ != text_.size())
+        {
+            Fail("trailing characters");
+        }
+        return value;
+    }
+
+private:
+    static constexpr uint32_t s_max_depth_ = 256;
+
+    [[noreturn]] void Fail(const char* message)
+    {
+        throw std::runtime_error("JSON parse error at offset " + std::to_string(position_) + ": " + message);
+    }
+
+    void SkipWhitespace()
+    {
+        while (position_ < text_.size() && (text_[position_] == ' ' || text_[position_] == '\n' || text_[position_] == '\r' || text_[position_] == '\t'))
+        {
+            ++position_;
+        }
+    }
+
+    bool Consume(char c)
+    {
+        SkipWhitespace();
+        if (position_ < text_.size() && text_[position_] == c)
+        {
+            ++position_;
+            return true;
+        }
+        return false;
+    }
+
+    void Expect(char c)
+    {
+        if (!Consume(c))
+        {
+            Fail("unexpected character");
+        }
+    }
+
+    bool ConsumeLiteral(std::string_view literal)
+    {
+        if (text_.substr(position_, literal.size()) == literal)
+        {
+            position_ += literal.size();
+            return true;
+        }
+        return false;
+    }
+
+    JsonValue ParseValue(uint32_t depth)
+    {
+        if (depth > s_max_depth_)
+        {
+            Fail("nesting too deep");
+        }
+
+        SkipWhitespace();
+        if (position_ >= text_.size())
+        {
+            Fail("unexpected end of input");
+        }
+
+        JsonValue value;
+        char c = text_[position_];
+
+        if (c == '{')
+        {
+            ++position_;
+            value.type_ = Type::Object;
+            if (!Consume('}'))
+            {
+                do
+                {
+                    SkipWhitespace();
+                    std::string key = ParseString();
+                    Expect(':');
+                    value.object_.emplace_back(std::move(key), ParseValue(depth + 1));
+                } while (Consume(','));
+                Expect('}');
+            }
+        }
+        else if (c == '[')
+        {
+            ++position_;
+            value.type_ = Type::Array;
+            if (!Consume(']'))
+            {
+                do
+                {
+                    value.array_.push_back(ParseValue(depth + 1));
+                } while (Consume(','));
+                Expect(']');
+            }
+        }
+        else if (c == '"')
+        {
+            value.type_ = Type::String;
+            value.string_ = ParseString();
+        }
+        else if (ConsumeLiteral("true"))
+        {
+            value.type_ = Type::Bool;
+            value.bool_ = true;
+        }
+        else if (ConsumeLiteral("false"))
+        {
+            value.type_ = Type::Bool;
+        }
+        else if (ConsumeLiteral("null"))
+        {
+            value.type_ = Type::Null;
+        }
+        else
+        {
+            value.type_ = Type::Number;
+            const char* begin = text_.data() + position_;
+            const char* end = text_.data() + text_.size();
+            auto [next, error] = std::from_chars(begin, end, value.number_);
+            if (error != std::errc())
+            {
+                Fail("invalid number");
+            }
+            position_ += static_cast<size_t>(next - begin);
+        }
+
+        return value;
+    }
+
+    uint32_t ParseHex4()
+    {
+        if (position_ + 4 > text_.size())
+        {
+            Fail("truncated unicode escape");
+        }
+
+        uint32_t code = 0;
+        auto [next, error] = std::from_chars(text_.data() + position_, text_.data() + position_ + 4, code, 16);
+        if (error != std::errc() || next != text_.data() + position_ + 4)
+        {
+            Fail("invalid unicode escape");
+        }
+        position_ += 4;
+        return code;
+    }
+
+    static void AppendUtf8(std::string& out, uint32_t code)
+    {
+        if (code < 0x80)
+        {
+            out += static_cast<char>(code);
+        }
+        else if (code < 0x800)
+        {
+            out += static_cast<char>(0xc0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        }
+        else if (code < 0x10000)
+        {
+            out += static_cast<char>(0xe0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        }
+        else
+        {
+            out += static_cast<char>(0xf0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        }
+    }
+
+    std::string ParseString()
+    {
+        if (position_ >= text_.size() || text_[position_] != '"')
+        {
+            Fail("expected string");
+        }
+        ++position_;
+
+        std::string result;
+        while (true)
+        {
+            if (position_ >= text_.size())
+            {
+                Fail("unterminated string");
+            }
+
+            char c = text_[position_++];
+            if (c == '"')
+            {
+                return result;
+            }
+            if (c != '\\')
+            {
+                result += c;
+                continue;
+            }
+
+            if (position_ >= text_.size())
+            {
+                Fail("unterminated escape");
+            }
+
+            char escape = text_[position_++];
+            switch (escape)
+            {
+            case '"': result += '"'; break;
+            case '\\': result += '\\'; break;
+            case '/': result += '/'; break;
+            case 'b': result += '\b'; break;
+            case 'f': result += '\f'; break;
+            case 'n': result += '\n'; break;
+            case 'r': result += '\r'; break;
+            case 't': result += '\t'; break;
+            case 'u':
+            {
+                uint32_t code = ParseHex4();
+                // surrogate pair
+                if (code >= 0xd800 && code < 0xdc00 && ConsumeLiteral("\\u"))
+                {
+                    uint32_t low = ParseHex4();
+                    code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                }
+                AppendUtf8(result, code);
+                break;
+            }
+            default:
+                Fail("invalid escape");
+            }
+        }
+    }
+
+private:
+    std::string_view text_;
+    size_t position_ = 0;
+};
+
+JsonValue JsonValue::Parse(std::string_view text)
+{
+    return Parser(text).ParseDocument();
+}
+
+const JsonValue* JsonValue::Find(std::string_view key) const
+{
+    for (const auto& [name, value] : object_)
+    {
+        if (name == key)
+        {
+            return &value;
+        }
+    }
+    return nullptr;
+}
+
+int64_t JsonValue::GetInt(std::string_view key, int64_t fallback) const
+{
+    const JsonValue* value = Find(key);
+    return value ? value->GetInt(fallback) : fallback;
+}
+
+} // namespace renderer::mesh
@@ -0,0 +1,62 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace renderer::mesh {
+
+// Small JSON DOM, enough for glTF documents. Parse throws std::runtime_error on malformed input.
+class JsonValue
+{
+public:
+    enum class Type
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object,
+    };
+
+public:
+    static JsonValue Parse(std::string_view text);
+
+    Type GetType() const { return type_; }
+    bool IsNull() const { return type_ == Type::Null; }
+    bool IsNumber() const { return type_ == Type::Number; }
+    bool IsString() const { return type_ == Type::String; }
+    bool IsArray() const { return type_ == Type::Array; }
+    bool IsObject() const { return type_ == Type::Object; }
+
+    bool GetBool(bool fallback = false) const { return type_ == Type::Bool ? bool_ : fallback; }
+    double GetNumber(double fallback = 0.0) const { return type_ == Type::Number ? number_ : fallback; }
+    int64_t GetInt(int64_t fallback = 0) const { return type_ == Type::Number ? static_cast<int64_t>(number_) : fallback; }
+    const std::string& GetString() const { return string_; }
+
+    // arrays
+    size_t Size() const { return array_.size(); }
+    const JsonValue& operator[](size_t index) const { return array_[index]; }
+    const std::vector<JsonValue>& GetArray() const { return array_; }
+
+    // objects, nullptr for missing members
+    const JsonValue* Find(std::string_view key) const;
+    int64_t GetInt(std::string_view key, int64_t fallback) const;
+
+private:
+    class Parser;
+
+    Type type_ = Type::Null;
+    bool bool_ = false;
+    double number_ = 0.0;
+    std::string string_;
+    std::vector<JsonValue> array_;
+    std::vector<std::pair<std::string, JsonValue>> object_;
+};
+
+} // namespace renderer::mesh
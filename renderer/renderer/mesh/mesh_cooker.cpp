@@ -0,0 +1,344 @@
+#include <renderer/renderer/mesh/mesh_cooker.hpp>
+
+// std
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+// renderer includes
+#include <renderer/renderer/parallel_for.hpp>
+#include <renderer/renderer/mesh/mesh_simplifier.hpp>
+#include <renderer/renderer/mesh/vertex_quantization.hpp>
+
+namespace renderer::mesh {
+
+namespace {
+
+// a level keeping more than this share of the previous one is not worth storing
+constexpr float s_min_lod_reduction = 0.9f;
+
+// Index range renumbered to the vertices it references, in first use order. The optimizers and
+// the simplifier size their tables by vertex count, so ranges of multi-submesh meshes are
+// renumbered first. A whole mesh range keeps its indices and leaves global_indices_ empty.
+struct LocalRange
+{
+    std::vector<uint32_t> indices_;
+    std::vector<glm::vec3> positions_;
+    std::vector<uint32_t> global_indices_;
+
+    uint32_t ToGlobal(uint32_t index) const
+    {
+        return global_indices_.empty() ? index : global_indices_[index];
+    }
+};
+
+LocalRange MakeLocalRange(std::span<const uint32_t> range, const std::vector<MeshVertex>& vertices, bool whole_mesh)
+{
+    LocalRange local_range;
+    local_range.indices_.assign(range.begin(), range.end());
+
+    if (whole_mesh)
+    {
+        local_range.positions_.resize(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            local_range.positions_[i] = vertices[i].pos_;
+        }
+    }
+    else
+    {
+        std::unordered_map<uint32_t, uint32_t> local;
+        for (uint32_t& index : local_range.indices_)
+        {
+            auto [it, inserted] = local.emplace(index, static_cast<uint32_t>(local_range.global_indices_.size()));
+            if (inserted)
+            {
+                local_range.global_indices_.push_back(index);
+                local_range.positions_.push_back(vertices[index].pos_);
+            }
+            index = it->second;
+        }
+    }
+
+    return local_range;
+}
+
+// triangle order of one index range
+void OptimizeRange(std::span<uint32_t> range, const std::vector<MeshVertex>& vertices, bool whole_mesh)
+{
+    if (range.empty())
+    {
+        return;
+    }
+
+    LocalRange local_range = MakeLocalRange(range, vertices, whole_mesh);
+    std::vector<uint32_t>& local_indices = local_range.indices_;
+    const std::vector<glm::vec3>& positions = local_range.positions_;
+
+    OptimizeVertexCache(local_indices, positions.size());
+    OptimizeOverdraw(local_indices, &positions[0].x, positions.size(), sizeof(glm::vec3));
+
+    for (size_t i = 0; i < range.size(); ++i)
+    {
+        range[i] = local_range.ToGlobal(local_indices[i]);
+    }
+}
+
+template<typename Vertex>
+std::span<const std::byte> AsBytes(const std::vector<Vertex>& vertices)
+{
+    return std::as_bytes(std::span<const Vertex>(vertices));
+}
+
+} // namespace
+
+void OptimizeImportedMesh(ImportedMesh& mesh, uint32_t thread_count)
+{
+    if (mesh.indices_.empty())
+    {
+        return;
+    }
+
+    if (mesh.submeshes_.empty())
+    {
+        OptimizeRange(mesh.indices_, mesh.vertices_, true);
+    }
+    else
+    {
+        bool whole_mesh = mesh.submeshes_.size() == 1;
+        ParallelFor(mesh.submeshes_.size(), thread_count, [&](size_t i)
+        {
+            const MeshFileSubmesh& submesh = mesh.submeshes_[i];
+            if (static_cast<size_t>(submesh.first_index_) + submesh.index_count_ > mesh.indices_.size())
+            {
+                throw std::runtime_error("Submesh index range exceeds the index buffer");
+            }
+            OptimizeRange(std::span<uint32_t>(mesh.indices_).subspan(submesh.first_index_, submesh.index_count_), mesh.vertices_, whole_mesh);
+        });
+    }
+
+    std::vector<uint32_t> remap;
+    size_t fetched_count = OptimizeVertexFetchRemap(remap, mesh.indices_, mesh.vertices_.size());
+
+    std::vector<MeshVertex> vertices(fetched_count);
+    RemapVertexBuffer(vertices.data(), mesh.vertices_.data(), mesh.vertices_.size(), sizeof(MeshVertex), remap);
+    RemapIndexBuffer(mesh.indices_, remap);
+    mesh.vertices_ = std::move(vertices);
+}
+
+std::vector<Meshlet> BuildMeshMeshlets(ImportedMesh& mesh, const MeshletSettings& settings, uint32_t thread_count)
+{
+    if (mesh.vertices_.empty() || mesh.indices_.empty())
+    {
+        return {};
+    }
+
+    std::vector<MeshFileSubmesh> submeshes = mesh.submeshes_;
+    if (submeshes.empty())
+    {
+        submeshes.push_back(MeshFileSubmesh{0, static_cast<uint32_t>(mesh.indices_.size()), 0, 0, {}, {}});
+    }
+
+    // submesh ranges are disjoint, so they are clustered in place concurrently, each over the
+    // vertices it references
+    bool whole_mesh = submeshes.size() == 1;
+    std::vector<std::vector<Meshlet>> submesh_meshlets(submeshes.size());
+    ParallelFor(submeshes.size(), thread_count, [&](size_t i)
+    {
+        const MeshFileSubmesh& submesh = submeshes[i];
+        if (static_cast<size_t>(submesh.first_index_) + submesh.index_count_ > mesh.indices_.size())
+        {
+            throw std::runtime_error("Submesh index range exceeds the index buffer");
+        }
+        std::span<uint32_t> range = std::span<uint32_t>(mesh.indices_).subspan(submesh.first_index_, submesh.index_count_);
+        if (range.empty())
+        {
+            return;
+        }
+
+        LocalRange local_range = MakeLocalRange(range, mesh.vertices_, whole_mesh);
+        submesh_meshlets[i] = BuildMeshlets(local_range.indices_,
+                                            submesh.first_index_,
+                                            &local_range.positions_[0].x,
+                                            local_range.positions_.size(),
+                                            sizeof(glm::vec3),
+                                            settings);
+        for (size_t k = 0; k < range.size(); ++k)
+        {
+            range[k] = local_range.ToGlobal(local_range.indices_[k]);
+        }
+    });
+
+    std::vector<Meshlet> meshlets;
+    for (const std::vector<Meshlet>& range : submesh_meshlets)
+    {
+        meshlets.insert(meshlets.end(), range.begin(), range.end());
+    }
+    return meshlets;
+}
+
+std::vector<MeshFileLod> GenerateLodChain(ImportedMesh& mesh,
+                                          uint32_t lod_count,
+                                          float reduction,
+                                          float max_relative_error,
+                                          uint32_t thread_count)
+{
+    std::vector<MeshFileLod> lods;
+    lods.push_back(MeshFileLod{0, static_cast<uint32_t>(mesh.indices_.size()), 0.0f, 0});
+    if (mesh.vertices_.empty() || mesh.indices_.empty())
+    {
+        return lods;
+    }
+
+    std::vector<MeshFileSubmesh> submeshes = mesh.submeshes_;
+    if (submeshes.empty())
+    {
+        submeshes.push_back(MeshFileSubmesh{0, static_cast<uint32_t>(mesh.indices_.size()), 0, 0, {}, {}});
+    }
+
+    float max_error = ComputeBoundingSphere(mesh.vertices_).w * max_relative_error;
+
+    // Later levels only collapse onto vertices of the level before, so every submesh is simplified
+    // over the vertices its first level references. Ranges of the previous level are kept local.
+    bool whole_mesh = submeshes.size() == 1;
+    std::vector<LocalRange> previous(submeshes.size());
+    for (size_t i = 0; i < submeshes.size(); ++i)
+    {
+        if (static_cast<size_t>(submeshes[i].first_index_) + submeshes[i].index_count_ > mesh.indices_.size())
+        {
+            throw std::runtime_error("Submesh index range exceeds the index buffer");
+        }
+        previous[i] = MakeLocalRange(std::span<const uint32_t>(mesh.indices_).subspan(submeshes[i].first_index_, submeshes[i].index_count_),
+                                     mesh.vertices_,
+                                     whole_mesh);
+    }
+
+    while (lods.size() < std::min(lod_count, s_max_mesh_lods_))
+    {
+        std::vector<std::vector<uint32_t>> simplified(submeshes.size());
+        std::vector<float> errors(submeshes.size(), 0.0f);
+
+        ParallelFor(submeshes.size(), thread_count, [&](size_t i)
+        {
+            const LocalRange& range = previous[i];
+            if (range.indices_.empty())
+            {
+                return;
+            }
+
+            size_t target = static_cast<size_t>(range.indices_.size() / 3 * reduction) * 3;
+            simplified[i] = SimplifyMesh(range.indices_, &range.positions_[0].x, range.positions_.size(), sizeof(glm::vec3), target, max_error, &errors[i]);
+            OptimizeVertexCache(simplified[i], range.positions_.size());
+        });
+
+        size_t previous_count = 0;
+        size_t level_count = 0;
+        for (size_t i = 0; i < submeshes.size(); ++i)
+        {
+            previous_count += previous[i].indices_.size();
+            level_count += simplified[i].size();
+        }
+        if (level_count == 0 || level_count > previous_count * s_min_lod_reduction)
+        {
+            break;
+        }
+
+        // every level is simplified from the previous one, so their errors add up
+        MeshFileLod lod{static_cast<uint32_t>(mesh.indices_.size()), static_cast<uint32_t>(level_count), lods.back().error_, 0};
+        lod.error_ += *std::max_element(errors.begin(), errors.end());
+        for (size_t i = 0; i < submeshes.size(); ++i)
+        {
+            for (uint32_t index : simplified[i])
+            {
+                mesh.indices_.push_back(previous[i].ToGlobal(index));
+            }
+            previous[i].indices_ = std::move(simplified[i]);
+        }
+        lods.push_back(lod);
+    }
+
+    return lods;
+}
+
+CookReport CookMesh(ImportedMesh& mesh, const std::string& output_path, const CookOptions& options)
+{
+    CookReport report{};
+    report.before_ = AnalyzeVertexCache(mesh.indices_, mesh.vertices_.size());
+
+    if (options.optimize_)
+    {
+        OptimizeImportedMesh(mesh, options.thread_count_);
+    }
+
+    std::vector<Meshlet> meshlets;
+    if (options.build_meshlets_)
+    {
+        meshlets = BuildMeshMeshlets(mesh, options.meshlet_settings_, options.thread_count_);
+    }
+
+    report.after_ = AnalyzeVertexCache(mesh.indices_, mesh.vertices_.size());
+
+    // after the vertex order is final, the levels only append indices
+    report.lods_ = GenerateLodChain(mesh, options.lod_count_, options.lod_reduction_, options.lod_max_error_, options.thread_count_);
+
+    MeshFileContents contents{};
+    contents.vertex_format_ = options.vertex_format_;
+    contents.vertex_count_ = static_cast<uint32_t>(mesh.vertices_.size());
+    contents.indices_ = mesh.indices_;
+    contents.submeshes_ = mesh.submeshes_;
+    contents.lods_ = report.lods_;
+    contents.meshlets_ = meshlets;
+
+    // keeps the converted vertex stream alive until the file is written
+    std::vector<Vertex> standard_vertices;
+    QuantizedMesh quantized;
+
+    switch (options.vertex_format_)
+    {
+    case MeshVertexFormat::Standard:
+        standard_vertices = ToStandardVertices(mesh.vertices_);
+        contents.vertices_ = AsBytes(standard_vertices);
+        break;
+    case MeshVertexFormat::Full:
+        contents.vertices_ = AsBytes(mesh.vertices_);
+        break;
+    case MeshVertexFormat::Quantized:
+        quantized = QuantizeMesh(mesh.vertices_, mesh.indices_);
+        contents.vertices_ = AsBytes(quantized.vertices_);
+        contents.dequantization_ = quantized.dequantization_;
+        break;
+    default:
+        throw std::runtime_error("Unknown vertex format");
+    }
+
+    WriteMeshFile(output_path, contents);
+
+    report.vertex_count_ = mesh.vertices_.size();
+    report.index_count_ = report.lods_[0].index_count_;
+    report.submesh_count_ = std::max<size_t>(mesh.submeshes_.size(), 1);
+    report.meshlet_count_ = meshlets.size();
+    report.file_size_ = static_cast<size_t>(std::filesystem::file_size(output_path));
+
+    return report;
+}
+
+void PrintReport(const char* name, const CookReport& report)
+{
+    std::cout << std::fixed << std::setprecision(3)
+              << "Cooked " << name << ": " << report.vertex_count_ << " vertices, " << report.index_count_ << " indices, "
+              << report.submesh_count_ << " submeshes, " << report.meshlet_count_ << " meshlets, " << report.file_size_ << " bytes"
+              << ", ACMR " << report.before_.acmr_ << " -> " << report.after_.acmr_
+              << std::defaultfloat << std::endl;
+
+    for (size_t i = 1; i < report.lods_.size(); ++i)
+    {
+        std::cout << "    LOD " << i << ": " << report.lods_[i].index_count_ / 3 << " triangles, error " << report.lods_[i].error_ << std::endl;
+    }
+}
+
+} // namespace renderer::mesh
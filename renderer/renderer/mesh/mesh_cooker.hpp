@@ -0,0 +1,75 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// renderer includes
+#include <renderer/renderer/mesh/mesh_file.hpp>
+#include <renderer/renderer/mesh/mesh_importer.hpp>
+#include <renderer/renderer/mesh/mesh_optimizer.hpp>
+#include <renderer/renderer/mesh/meshlet.hpp>
+
+namespace renderer::mesh {
+
+struct CookOptions
+{
+    MeshVertexFormat vertex_format_ = MeshVertexFormat::Standard;
+    // vertex cache and overdraw order per submesh, vertex fetch order for the whole mesh
+    bool optimize_ = true;
+
+    // LOD 0 plus up to lod_count_ - 1 simplified levels
+    uint32_t lod_count_ = 4;
+    // index count of every level relative to the previous one
+    float lod_reduction_ = 0.5f;
+    // largest simplification error of a level, relative to the bounding sphere radius
+    float lod_max_error_ = 0.05f;
+
+    // clusters of LOD 0 for CPU culling, reorders triangles inside every submesh
+    bool build_meshlets_ = true;
+    MeshletSettings meshlet_settings_;
+
+    // 0 uses every hardware thread
+    uint32_t thread_count_ = 0;
+};
+
+struct CookReport
+{
+    size_t vertex_count_ = 0;
+    size_t index_count_ = 0;
+    size_t submesh_count_ = 0;
+    size_t file_size_ = 0;
+
+    std::vector<MeshFileLod> lods_;
+    size_t meshlet_count_ = 0;
+
+    VertexCacheStatistics before_;
+    VertexCacheStatistics after_;
+};
+
+// Reorders triangles inside every submesh and vertices for the whole mesh. Submesh ranges
+// keep their position in the index buffer, so the submesh table stays valid.
+void OptimizeImportedMesh(ImportedMesh& mesh, uint32_t thread_count = 0);
+
+// Splits every submesh into meshlets, reordering its triangles so that each meshlet is an index
+// sub-range. Only the current index buffer is covered, run it before GenerateLodChain.
+std::vector<Meshlet> BuildMeshMeshlets(ImportedMesh& mesh, const MeshletSettings& settings = {}, uint32_t thread_count = 0);
+
+// Appends simplified copies of the index buffer, each submesh simplified on its own, and returns
+// the LOD table with LOD 0 covering the original indices. Every level is simplified from the
+// previous one; the chain ends early once simplification stalls. Errors are in object space.
+std::vector<MeshFileLod> GenerateLodChain(ImportedMesh& mesh,
+                                          uint32_t lod_count,
+                                          float reduction,
+                                          float max_relative_error,
+                                          uint32_t thread_count = 0);
+
+// Runs the offline part of the mesh pipeline on an imported mesh (modified in place)
+// and writes it as a .rmesh file.
+CookReport CookMesh(ImportedMesh& mesh, const std::string& output_path, const CookOptions& options = {});
+
+void PrintReport(const char* name, const CookReport& report);
+
+} // namespace renderer::mesh
@@ -0,0 +1,318 @@
+#include <renderer/renderer/mesh/mesh_file.hpp>
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+// renderer includes
+#include <renderer/renderer/vertex_buffer.hpp>
+
+namespace renderer::mesh {
+
+namespace {
+
+uint64_t AlignUp(uint64_t value)
+{
+    return (value + s_mesh_file_alignment_ - 1) / s_mesh_file_alignment_ * s_mesh_file_alignment_;
+}
+
+template<typename Index>
+bool IndicesInRange(std::span<const std::byte> index_data, uint32_t vertex_count)
+{
+    const Index* indices = reinterpret_cast<const Index*>(index_data.data());
+    return std::all_of(indices, indices + index_data.size() / sizeof(Index), [vertex_count](Index index) { return index < vertex_count; });
+}
+
+glm::vec3 ReadPosition(const MeshFileContents& contents, uint32_t stride, uint32_t index)
+{
+    const std::byte* vertex = contents.vertices_.data() + static_cast<size_t>(index) * stride;
+
+    if (contents.vertex_format_ == MeshVertexFormat::Quantized)
+    {
+        Unorm16x4 position;
+        std::memcpy(&position, vertex + offsetof(QuantizedVertex, pos_), sizeof(position));
+
+        glm::vec3 normalized = glm::vec3(position.x_, position.y_, position.z_) / 65535.0f;
+        return glm::vec3(contents.dequantization_.position_offset_) + normalized * glm::vec3(contents.dequantization_.position_scale_);
+    }
+
+    // Vertex and MeshVertex both start with a float3 position
+    glm::vec3 position;
+    std::memcpy(&position, vertex, sizeof(position));
+    return position;
+}
+
+void ComputeBounds(const MeshFileContents& contents, uint32_t stride, uint32_t first_index, uint32_t index_count, float* bounds_min, float* bounds_max)
+{
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(std::numeric_limits<float>::lowest());
+
+    for (uint32_t i = first_index; i < first_index + index_count; ++i)
+    {
+        glm::vec3 position = ReadPosition(contents, stride, contents.indices_[i]);
+        min = glm::min(min, position);
+        max = glm::max(max, position);
+    }
+
+    if (index_count == 0)
+    {
+        min = max = glm::vec3(0.0f);
+    }
+
+    std::memcpy(bounds_min, &min, sizeof(float) * 3);
+    std::memcpy(bounds_max, &max, sizeof(float) * 3);
+}
+
+void WritePadding(std::ofstream& out, uint64_t position)
+{
+    static const char zeros[s_mesh_file_alignment_] = {};
+    out.write(zeros, static_cast<std::streamsize>(AlignUp(position) - position));
+}
+
+} // namespace
+
+uint32_t GetVertexStride(MeshVertexFormat format)
+{
+    switch (format)
+    {
+    case MeshVertexFormat::Standard: return sizeof(Vertex);
+    case MeshVertexFormat::Full: return sizeof(MeshVertex);
+    case MeshVertexFormat::Quantized: return sizeof(QuantizedVertex);
+    }
+    return 0;
+}
+
+void WriteMeshFile(const std::string& path, const MeshFileContents& contents)
+{
+    uint32_t stride = GetVertexStride(contents.vertex_format_);
+    if (stride == 0 || contents.vertices_.size() != static_cast<size_t>(stride) * contents.vertex_count_)
+    {
+        throw std::runtime_error("Mesh file vertex data does not match its format: " + path);
+    }
+
+    for (uint32_t index : contents.indices_)
+    {
+        if (index >= contents.vertex_count_)
+        {
+            throw std::runtime_error("Mesh file index out of range: " + path);
+        }
+    }
+
+    uint32_t index_count = static_cast<uint32_t>(contents.indices_.size());
+    uint32_t index_size = VertexBuffer::SelectIndexType(contents.vertex_count_) == VK_INDEX_TYPE_UINT16 ? 2 : 4;
+
+    std::vector<MeshFileSubmesh> submeshes = contents.submeshes_;
+    if (submeshes.empty())
+    {
+        submeshes.push_back(MeshFileSubmesh{0, index_count, 0, 0, {}, {}});
+    }
+
+    std::vector<MeshFileLod> lods = contents.lods_;
+    if (lods.empty())
+    {
+        lods.push_back(MeshFileLod{0, index_count, 0.0f, 0});
+    }
+    if (lods.size() > s_max_mesh_lods_)
+    {
+        throw std::runtime_error("Mesh file has too many LODs: " + path);
+    }
+    for (const MeshFileLod& lod : lods)
+    {
+        if (lod.first_index_ > index_count || lod.index_count_ > index_count - lod.first_index_)
+        {
+            throw std::runtime_error("Mesh file LOD out of range: " + path);
+        }
+    }
+
+    for (const Meshlet& meshlet : contents.meshlets_)
+    {
+        if (meshlet.first_index_ > index_count || meshlet.index_count_ > index_count - meshlet.first_index_)
+        {
+            throw std::runtime_error("Mesh file meshlet out of range: " + path);
+        }
+    }
+
+    for (MeshFileSubmesh& submesh : submeshes)
+    {
+        if (submesh.first_index_ > index_count || submesh.index_count_ > index_count - submesh.first_index_)
+        {
+            throw std::runtime_error("Mesh file submesh out of range: " + path);
+        }
+        ComputeBounds(contents, stride, submesh.first_index_, submesh.index_count_, submesh.bounds_min_, submesh.bounds_max_);
+    }
+
+    MeshFileHeader header{};
+    header.magic_ = s_mesh_file_magic_;
+    header.version_ = s_mesh_file_version_;
+    header.vertex_format_ = contents.vertex_format_;
+    header.vertex_stride_ = stride;
+    header.vertex_count_ = contents.vertex_count_;
+    header.index_size_ = index_size;
+    header.index_count_ = index_count;
+    header.submesh_count_ = static_cast<uint32_t>(submeshes.size());
+    header.lod_count_ = static_cast<uint32_t>(lods.size());
+    header.meshlet_count_ = static_cast<uint32_t>(contents.meshlets_.size());
+    header.dequantization_ = contents.dequantization_;
+
+    header.vertices_ = {AlignUp(sizeof(MeshFileHeader)), contents.vertices_.size()};
+    header.indices_ = {AlignUp(header.vertices_.offset_ + header.vertices_.size_), static_cast<uint64_t>(index_count) * index_size};
+    header.submeshes_ = {AlignUp(header.indices_.offset_ + header.indices_.size_), submeshes.size() * sizeof(MeshFileSubmesh)};
+    header.lods_ = {AlignUp(header.submeshes_.offset_ + header.submeshes_.size_), lods.size() * sizeof(MeshFileLod)};
+    header.meshlets_ = {AlignUp(header.lods_.offset_ + header.lods_.size_), contents.meshlets_.size() * sizeof(Meshlet)};
+
+    ComputeBounds(contents, stride, 0, index_count, header.bounds_min_, header.bounds_max_);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+    {
+        throw std::runtime_error("Failed to create mesh file: " + path);
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    WritePadding(out, sizeof(header));
+
+    out.write(reinterpret_cast<const char*>(contents.vertices_.data()), static_cast<std::streamsize>(header.vertices_.size_));
+    WritePadding(out, header.vertices_.offset_ + header.vertices_.size_);
+
+    if (index_size == 2)
+    {
+        std::vector<uint16_t> narrow_indices(contents.indices_.begin(), contents.indices_.end());
+        out.write(reinterpret_cast<const char*>(narrow_indices.data()), static_cast<std::streamsize>(header.indices_.size_));
+    }
+    else
+    {
+        out.write(reinterpret_cast<const char*>(contents.indices_.data()), static_cast<std::streamsize>(header.indices_.size_));
+    }
+    WritePadding(out, header.indices_.offset_ + header.indices_.size_);
+
+    out.write(reinterpret_cast<const char*>(submeshes.data()), static_cast<std::streamsize>(header.submeshes_.size_));
+    WritePadding(out, header.submeshes_.offset_ + header.submeshes_.size_);
+
+    out.write(reinterpret_cast<const char*>(lods.data()), static_cast<std::streamsize>(header.lods_.size_));
+    WritePadding(out, header.lods_.offset_ + header.lods_.size_);
+
+    out.write(reinterpret_cast<const char*>(contents.meshlets_.data()), static_cast<std::streamsize>(header.meshlets_.size_));
+
+    if (!out.good())
+    {
+        throw std::runtime_error("Failed to write mesh file: " + path);
+    }
+}
+
+MeshFile::MeshFile(const std::string& path)
+    : file_{std::make_unique<MappedFile>(path)}
+{
+    if (file_->GetSize() < sizeof(MeshFileHeader))
+    {
+        throw std::runtime_error("Mesh file too small: " + path);
+    }
+
+    // the mapping is page aligned, the header can be read in place
+    header_ = reinterpret_cast<const MeshFileHeader*>(file_->GetData());
+
+    Validate();
+}
+
+std::span<const MeshFileSubmesh> MeshFile::GetSubmeshes() const
+{
+    auto bytes = Section(header_->submeshes_);
+    return {reinterpret_cast<const MeshFileSubmesh*>(bytes.data()), header_->submesh_count_};
+}
+
+std::span<const MeshFileLod> MeshFile::GetLods() const
+{
+    auto bytes = Section(header_->lods_);
+    return {reinterpret_cast<const MeshFileLod*>(bytes.data()), header_->lod_count_};
+}
+
+std::span<const Meshlet> MeshFile::GetMeshlets() const
+{
+    auto bytes = Section(header_->meshlets_);
+    return {reinterpret_cast<const Meshlet*>(bytes.data()), header_->meshlet_count_};
+}
+
+void MeshFile::Validate() const
+{
+    const std::string& path = file_->GetPath();
+    const MeshFileHeader& header = *header_;
+
+    if (header.magic_ != s_mesh_file_magic_)
+    {
+        throw std::runtime_error("Not a mesh file: " + path);
+    }
+
+    if (header.version_ != s_mesh_file_version_)
+    {
+        throw std::runtime_error("Unsupported mesh file version " + std::to_string(header.version_) + ", recook: " + path);
+    }
+
+    if (GetVertexStride(header.vertex_format_) == 0 || GetVertexStride(header.vertex_format_) != header.vertex_stride_)
+    {
+        throw std::runtime_error("Mesh file vertex format mismatch: " + path);
+    }
+
+    if (header.index_size_ != 2 && header.index_size_ != 4)
+    {
+        throw std::runtime_error("Mesh file index size invalid: " + path);
+    }
+
+    if (header.lod_count_ == 0 || header.lod_count_ > s_max_mesh_lods_)
+    {
+        throw std::runtime_error("Mesh file LOD count invalid: " + path);
+    }
+
+    auto check_section = [&](const MeshFileSection& section, uint64_t expected_size, const char* name)
+    {
+        if (section.offset_ % s_mesh_file_alignment_ != 0
+            || section.size_ != expected_size
+            || section.offset_ > file_->GetSize()
+            || section.size_ > file_->GetSize() - section.offset_)
+        {
+            throw std::runtime_error(std::string("Mesh file ") + name + " section corrupt: " + path);
+        }
+    };
+
+    check_section(header.vertices_, static_cast<uint64_t>(header.vertex_stride_) * header.vertex_count_, "vertex");
+    check_section(header.indices_, static_cast<uint64_t>(header.index_size_) * header.index_count_, "index");
+    check_section(header.submeshes_, static_cast<uint64_t>(header.submesh_count_) * sizeof(MeshFileSubmesh), "submesh");
+    check_section(header.lods_, static_cast<uint64_t>(header.lod_count_) * sizeof(MeshFileLod), "LOD");
+    check_section(header.meshlets_, static_cast<uint64_t>(header.meshlet_count_) * sizeof(Meshlet), "meshlet");
+
+    auto check_range = [&](uint32_t first, uint32_t count)
+    {
+        if (first > header.index_count_ || count > header.index_count_ - first)
+        {
+            throw std::runtime_error("Mesh file index range out of bounds: " + path);
+        }
+    };
+
+    for (const MeshFileSubmesh& submesh : GetSubmeshes())
+    {
+        check_range(submesh.first_index_, submesh.index_count_);
+    }
+
+    for (const MeshFileLod& lod : GetLods())
+    {
+        check_range(lod.first_index_, lod.index_count_);
+    }
+
+    for (const Meshlet& meshlet : GetMeshlets())
+    {
+        check_range(meshlet.first_index_, meshlet.index_count_);
+    }
+
+    // a corrupt or stale file must not make the GPU fetch past the vertices, one pass over the
+    // pages the upload reads next anyway
+    bool indices_valid = header.index_size_ == sizeof(uint16_t)
+                             ? IndicesInRange<uint16_t>(GetIndexData(), header.vertex_count_)
+                             : IndicesInRange<uint32_t>(GetIndexData(), header.vertex_count_);
+    if (!indices_valid)
+    {
+        throw std::runtime_error("Mesh file index out of range: " + path);
+    }
+}
+
+} // namespace renderer::mesh
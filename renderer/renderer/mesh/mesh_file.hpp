@@ -0,0 +1,149 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// renderer includes
+#include <renderer/renderer/mapped_file.hpp>
+#include <renderer/renderer/mesh/meshlet.hpp>
+#include <renderer/renderer/mesh/vertex_quantization.hpp>
+
+namespace renderer::mesh {
+
+// Cooked mesh container (.rmesh), little endian:
+//     MeshFileHeader | vertex stream | index buffer | submesh table | LOD table | meshlet table
+// Every section starts on a s_mesh_file_alignment_ boundary and is stored exactly as the GPU
+// (vertex and index streams) or the renderer (tables) consumes it, so loading is a mapping.
+
+static constexpr uint32_t s_mesh_file_magic_ = 0x48534d52; // "RMSH"
+static constexpr uint32_t s_mesh_file_version_ = 2;
+static constexpr uint64_t s_mesh_file_alignment_ = 64;
+// LOD 0 included
+static constexpr uint32_t s_max_mesh_lods_ = 8;
+
+enum class MeshVertexFormat : uint32_t
+{
+    Standard = 0,   // renderer::Vertex
+    Full = 1,       // MeshVertex
+    Quantized = 2,  // QuantizedVertex
+};
+
+uint32_t GetVertexStride(MeshVertexFormat format);
+
+struct MeshFileSection
+{
+    uint64_t offset_;
+    uint64_t size_;
+};
+
+struct MeshFileHeader
+{
+    uint32_t magic_;
+    uint32_t version_;
+
+    MeshVertexFormat vertex_format_;
+    uint32_t vertex_stride_;
+    uint32_t vertex_count_;
+
+    // 2 or 4 bytes, picked by the vertex count when cooking
+    uint32_t index_size_;
+    uint32_t index_count_;
+
+    uint32_t submesh_count_;
+    uint32_t lod_count_;
+    // meshlets of LOD 0, may be 0
+    uint32_t meshlet_count_;
+
+    MeshFileSection vertices_;
+    MeshFileSection indices_;
+    MeshFileSection submeshes_;
+    MeshFileSection lods_;
+    MeshFileSection meshlets_;
+
+    float bounds_min_[3];
+    float bounds_max_[3];
+
+    // quantized positions only
+    DequantizationConstants dequantization_;
+};
+
+// index range of the shared index buffer drawn with one material
+struct MeshFileSubmesh
+{
+    uint32_t first_index_;
+    uint32_t index_count_;
+    uint32_t material_index_;
+    uint32_t reserved_;
+
+    float bounds_min_[3];
+    float bounds_max_[3];
+};
+
+// LOD 0 is the full mesh, coarser levels are index ranges over the same vertices
+struct MeshFileLod
+{
+    uint32_t first_index_;
+    uint32_t index_count_;
+    // object space error of the simplification
+    float error_;
+    uint32_t reserved_;
+};
+
+// What the cooker writes. vertices_ must hold vertex_count_ * GetVertexStride(vertex_format_) bytes.
+struct MeshFileContents
+{
+    MeshVertexFormat vertex_format_ = MeshVertexFormat::Standard;
+    std::span<const std::byte> vertices_;
+    uint32_t vertex_count_ = 0;
+
+    std::span<const uint32_t> indices_;
+
+    // empty: one submesh covering all indices
+    std::vector<MeshFileSubmesh> submeshes_;
+    // empty: one LOD covering all indices
+    std::vector<MeshFileLod> lods_;
+    // optional, ranges must lie inside the index buffer
+    std::span<const Meshlet> meshlets_;
+
+    DequantizationConstants dequantization_;
+};
+
+void WriteMeshFile(const std::string& path, const MeshFileContents& contents);
+
+// Validated view of a mapped .rmesh file: sections, index ranges and index values are checked
+// on open, so untrusted files are safe to draw. All spans point into the mapping and stay valid
+// as long as the MeshFile lives.
+class MeshFile
+{
+public:
+    MeshFile(const std::string& path);
+
+    const MeshFileHeader& GetHeader() const { return *header_; }
+
+    std::span<const std::byte> GetVertexData() const { return Section(header_->vertices_); }
+    std::span<const std::byte> GetIndexData() const { return Section(header_->indices_); }
+    std::span<const MeshFileSubmesh> GetSubmeshes() const;
+    std::span<const MeshFileLod> GetLods() const;
+    std::span<const Meshlet> GetMeshlets() const;
+
+    size_t GetFileSize() const { return file_->GetSize(); }
+
+private:
+    std::span<const std::byte> Section(const MeshFileSection& section) const
+    {
+        return file_->GetBytes().subspan(section.offset_, section.size_);
+    }
+
+    void Validate() const;
+
+private:
+    std::unique_ptr<MappedFile> file_;
+    const MeshFileHeader* header_ = nullptr;
+};
+
+} // namespace renderer::mesh
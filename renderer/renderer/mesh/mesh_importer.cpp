@@ -0,0 +1,88 @@
+#include <renderer/renderer/mesh/mesh_importer.hpp>
+
+// std
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace renderer::mesh {
+
+namespace {
+
+std::string GetLowerExtension(const std::string& path)
+{
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension;
+}
+
+bool IsGltfExtension(const std::string& extension)
+{
+    return extension == ".gltf" || extension == ".glb";
+}
+
+} // namespace
+
+ImportedMesh ImportMesh(const std::string& path, const ImportOptions& options)
+{
+    std::string extension = GetLowerExtension(path);
+
+    if (extension == ".obj")
+    {
+        return ImportObj(path, options);
+    }
+    if (IsGltfExtension(extension))
+    {
+        return ImportGltf(path, options);
+    }
+
+    throw std::runtime_error("Unsupported mesh format: " + path);
+}
+
+bool IsImportableMesh(const std::string& path)
+{
+    std::string extension = GetLowerExtension(path);
+    return extension == ".obj" || IsGltfExtension(extension);
+}
+
+std::vector<std::string> GetImportDependencies(const std::string& path)
+{
+    // material libraries are not read by the OBJ importer
+    if (IsGltfExtension(GetLowerExtension(path)))
+    {
+        return GetGltfDependencies(path);
+    }
+    return {};
+}
+
+void PrintStats(const char* name, const ImportStats& stats)
+{
+    double seconds = std::max(stats.seconds_, 1e-9);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "Imported " << name << ": " << stats.triangle_count_ << " triangles, "
+              << stats.source_bytes_ / (1024.0 * 1024.0) << " MiB in " << stats.seconds_ * 1000.0 << " ms on "
+              << stats.thread_count_ << " threads (" << stats.source_bytes_ / (1024.0 * 1024.0) / seconds << " MiB/s, "
+              << stats.triangle_count_ / seconds / 1e6 << " Mtriangles/s)"
+              << std::defaultfloat << std::endl;
+}
+
+std::vector<Vertex> ToStandardVertices(const std::vector<MeshVertex>& vertices)
+{
+    std::vector<Vertex> result(vertices.size());
+    std::transform(vertices.begin(), vertices.end(), result.begin(), [](const MeshVertex& vertex)
+    {
+        return Vertex{vertex.pos_, glm::vec3(vertex.col_)};
+    });
+    return result;
+}
+
+std::unique_ptr<VertexBuffer> CreateVertexBuffer(Device& device, const ImportedMesh& mesh)
+{
+    return std::make_unique<VertexBuffer>(device, ToStandardVertices(mesh.vertices_), mesh.indices_);
+}
+
+} // namespace renderer::mesh
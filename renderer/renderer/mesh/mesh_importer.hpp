@@ -0,0 +1,68 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// renderer includes
+#include <renderer/renderer/device.hpp>
+#include <renderer/renderer/vertex_buffer.hpp>
+#include <renderer/renderer/mesh/mesh_vertex.hpp>
+#include <renderer/renderer/mesh/mesh_file.hpp>
+
+namespace renderer::mesh {
+
+struct ImportOptions
+{
+    // 0 uses every hardware thread
+    uint32_t thread_count_ = 0;
+    // for sources without normals
+    bool generate_normals_ = true;
+};
+
+struct ImportStats
+{
+    size_t source_bytes_ = 0;
+    size_t triangle_count_ = 0;
+    uint32_t thread_count_ = 0;
+    double seconds_ = 0.0;
+};
+
+// Triangulated, indexed geometry in engine layout. Submeshes index ranges of indices_,
+// one per OBJ material group or glTF primitive.
+struct ImportedMesh
+{
+    std::vector<MeshVertex> vertices_;
+    std::vector<uint32_t> indices_;
+    std::vector<MeshFileSubmesh> submeshes_;
+
+    ImportStats stats_;
+};
+
+// Wavefront OBJ: v (with optional vertex colors), vt, vn, f with any polygon size and
+// negative indices, usemtl starts a new submesh. Line ranges are parsed in parallel.
+ImportedMesh ImportObj(const std::string& path, const ImportOptions& options = {});
+
+// glTF 2.0 (.gltf with external or embedded base64 buffers, .glb): triangle primitives of every
+// mesh in mesh space, node transforms are not applied. Accessors are decoded in parallel.
+ImportedMesh ImportGltf(const std::string& path, const ImportOptions& options = {});
+
+// external .bin buffers referenced by a .gltf or .glb
+std::vector<std::string> GetGltfDependencies(const std::string& path);
+
+// picks the importer by file extension
+ImportedMesh ImportMesh(const std::string& path, const ImportOptions& options = {});
+bool IsImportableMesh(const std::string& path);
+
+// files besides path that ImportMesh reads, for change tracking
+std::vector<std::string> GetImportDependencies(const std::string& path);
+
+void PrintStats(const char* name, const ImportStats& stats);
+
+// standard Vertex layout (position, color)
+std::vector<Vertex> ToStandardVertices(const std::vector<MeshVertex>& vertices);
+std::unique_ptr<VertexBuffer> CreateVertexBuffer(Device& device, const ImportedMesh& mesh);
+
+} // namespace renderer::mesh
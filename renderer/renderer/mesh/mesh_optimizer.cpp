@@ -0,0 +1,535 @@
+#include <renderer/renderer/mesh/mesh_optimizer.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+
+namespace renderer::mesh {
+
+namespace {
+
+constexpr uint32_t s_invalid_index = ~0u;
+
+// Forsyth scoring parameters, tuned for a 32 entry LRU cache
+constexpr int s_forsyth_cache_size = 32;
+constexpr float s_forsyth_last_triangle_score = 0.75f;
+constexpr float s_forsyth_cache_decay_power = 1.5f;
+constexpr float s_forsyth_valence_boost_scale = 2.0f;
+constexpr float s_forsyth_valence_boost_power = 0.5f;
+
+float ForsythVertexScore(int cache_position, uint32_t live_triangles)
+{
+    // vertices without triangles left are never needed again
+    if (live_triangles == 0)
+    {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cache_position >= 0)
+    {
+        if (cache_position < 3)
+        {
+            // used by the last triangle: fixed score so the next triangle does not simply repeat it
+            score = s_forsyth_last_triangle_score;
+        }
+        else
+        {
+            float scaler = 1.0f / (s_forsyth_cache_size - 3);
+            score = std::pow(1.0f - (cache_position - 3) * scaler, s_forsyth_cache_decay_power);
+        }
+    }
+
+    // boost vertices with few triangles left, so they get finished and leave the working set
+    score += s_forsyth_valence_boost_scale * std::pow(static_cast<float>(live_triangles), -s_forsyth_valence_boost_power);
+    return score;
+}
+
+// FIFO post-transform cache simulation with timestamps, O(1) per access
+class FifoCache
+{
+public:
+    FifoCache(size_t vertex_count, uint32_t cache_size)
+        : timestamps_(vertex_count, 0)
+        , cache_size_{cache_size}
+        , time_{cache_size + 1}
+    {}
+
+    // returns true on a miss
+    bool Access(uint32_t vertex)
+    {
+        if (time_ - timestamps_[vertex] > cache_size_)
+        {
+            timestamps_[vertex] = time_++;
+            return true;
+        }
+        return false;
+    }
+
+    void Reset() { time_ += cache_size_ + 1; }
+
+private:
+    std::vector<uint32_t> timestamps_;
+    uint32_t cache_size_;
+    uint32_t time_;
+};
+
+uint32_t HashVertex(const unsigned char* vertex, size_t vertex_size)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < vertex_size; ++i)
+    {
+        hash ^= vertex[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+struct Float3
+{
+    float x_, y_, z_;
+};
+
+Float3 ReadPosition(const float* positions, size_t stride, uint32_t index)
+{
+    const float* p = reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(positions) + index * stride);
+    return Float3{p[0], p[1], p[2]};
+}
+
+} // namespace
+
+size_t GenerateVertexRemap(std::vector<uint32_t>& remap,
+                           const std::vector<uint32_t>& indices,
+                           const void* vertices,
+                           size_t vertex_count,
+                           size_t vertex_size)
+{
+    remap.assign(vertex_count, s_invalid_index);
+
+    const unsigned char* data = static_cast<const unsigned char*>(vertices);
+
+    // open addressing table of representative vertices, at most half full
+    size_t table_size = 1;
+    while (table_size < vertex_count * 2)
+    {
+        table_size <<= 1;
+    }
+    std::vector<uint32_t> table(table_size, s_invalid_index);
+    size_t mask = table_size - 1;
+
+    uint32_t next_index = 0;
+    auto process = [&](uint32_t vertex)
+    {
+        if (remap[vertex] != s_invalid_index)
+        {
+            return;
+        }
+
+        const unsigned char* bytes = data + vertex * vertex_size;
+        size_t slot = HashVertex(bytes, vertex_size) & mask;
+
+        while (table[slot] != s_invalid_index)
+        {
+            uint32_t candidate = table[slot];
+            if (std::memcmp(data + candidate * vertex_size, bytes, vertex_size) == 0)
+            {
+                remap[vertex] = remap[candidate];
+                return;
+            }
+            slot = (slot + 1) & mask;
+        }
+
+        table[slot] = vertex;
+        remap[vertex] = next_index++;
+    };
+
+    if (indices.empty())
+    {
+        for (uint32_t i = 0; i < vertex_count; ++i)
+        {
+            process(i);
+        }
+    }
+    else
+    {
+        for (uint32_t index : indices)
+        {
+            process(index);
+        }
+    }
+
+    return next_index;
+}
+
+void RemapVertexBuffer(void* destination, const void* vertices, size_t vertex_count, size_t vertex_size, const std::vector<uint32_t>& remap)
+{
+    unsigned char* dst = static_cast<unsigned char*>(destination);
+    const unsigned char* src = static_cast<const unsigned char*>(vertices);
+
+    for (size_t i = 0; i < vertex_count; ++i)
+    {
+        if (remap[i] != s_invalid_index)
+        {
+            std::memcpy(dst + remap[i] * vertex_size, src + i * vertex_size, vertex_size);
+        }
+    }
+}
+
+void RemapIndexBuffer(std::vector<uint32_t>& indices, const std::vector<uint32_t>& remap)
+{
+    for (uint32_t& index : indices)
+    {
+        index = remap[index];
+    }
+}
+
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertex_count)
+{
+    size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0)
+    {
+        return;
+    }
+
+    // vertex -> triangle adjacency, live_triangles[v] entries starting at offsets[v] are still unemitted
+    std::vector<uint32_t> live_triangles(vertex_count, 0);
+    for (uint32_t index : indices)
+    {
+        ++live_triangles[index];
+    }
+
+    std::vector<uint32_t> offsets(vertex_count, 0);
+    std::exclusive_scan(live_triangles.begin(), live_triangles.end(), offsets.begin(), 0u);
+
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill = offsets;
+        for (uint32_t triangle = 0; triangle < triangle_count; ++triangle)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                adjacency[fill[indices[triangle * 3 + k]]++] = triangle;
+            }
+        }
+    }
+
+    std::vector<int> cache_position(vertex_count, -1);
+    std::vector<float> vertex_score(vertex_count);
+    for (size_t v = 0; v < vertex_count; ++v)
+    {
+        vertex_score[v] = ForsythVertexScore(-1, live_triangles[v]);
+    }
+
+    std::vector<float> triangle_score(triangle_count);
+    std::vector<bool> emitted(triangle_count, false);
+
+    uint32_t best_triangle = 0;
+    for (uint32_t triangle = 0; triangle < triangle_count; ++triangle)
+    {
+        const uint32_t* tri = &indices[triangle * 3];
+        triangle_score[triangle] = vertex_score[tri[0]] + vertex_score[tri[1]] + vertex_score[tri[2]];
+        if (triangle_score[triangle] > triangle_score[best_triangle])
+        {
+            best_triangle = triangle;
+        }
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> new_cache;
+    cache.reserve(s_forsyth_cache_size + 3);
+    new_cache.reserve(s_forsyth_cache_size + 3);
+
+    uint32_t scan_cursor = 0;
+
+    for (size_t emitted_count = 0; emitted_count < triangle_count; ++emitted_count)
+    {
+        if (best_triangle == s_invalid_index)
+        {
+            // nothing adjacent to the cache is left: continue with the next triangle in input order
+            while (emitted[scan_cursor])
+            {
+                ++scan_cursor;
+            }
+            best_triangle = scan_cursor;
+        }
+
+        const uint32_t tri[3] = {indices[best_triangle * 3 + 0], indices[best_triangle * 3 + 1], indices[best_triangle * 3 + 2]};
+        result.insert(result.end(), tri, tri + 3);
+        emitted[best_triangle] = true;
+
+        for (uint32_t vertex : tri)
+        {
+            // swap-remove the triangle from the vertex's live adjacency
+            uint32_t* begin = &adjacency[offsets[vertex]];
+            uint32_t* end = begin + live_triangles[vertex];
+            uint32_t* it = std::find(begin, end, best_triangle);
+            if (it != end)
+            {
+                *it = *(end - 1);
+                --live_triangles[vertex];
+            }
+        }
+
+        // LRU update: the triangle's vertices move to the front
+        new_cache.assign(tri, tri + 3);
+        for (uint32_t vertex : cache)
+        {
+            if (vertex != tri[0] && vertex != tri[1] && vertex != tri[2])
+            {
+                new_cache.push_back(vertex);
+            }
+        }
+
+        for (size_t i = 0; i < new_cache.size(); ++i)
+        {
+            uint32_t vertex = new_cache[i];
+            cache_position[vertex] = i < s_forsyth_cache_size ? static_cast<int>(i) : -1;
+            vertex_score[vertex] = ForsythVertexScore(cache_position[vertex], live_triangles[vertex]);
+        }
+
+        // only triangles touching changed vertices change score, the best next triangle is among them
+        best_triangle = s_invalid_index;
+        float best_score = -1.0f;
+        for (uint32_t vertex : new_cache)
+        {
+            for (uint32_t i = 0; i < live_triangles[vertex]; ++i)
+            {
+                uint32_t triangle = adjacency[offsets[vertex] + i];
+                const uint32_t* t = &indices[triangle * 3];
+                float score = vertex_score[t[0]] + vertex_score[t[1]] + vertex_score[t[2]];
+                triangle_score[triangle] = score;
+
+                if (score > best_score)
+                {
+                    best_score = score;
+                    best_triangle = triangle;
+                }
+            }
+        }
+
+        if (new_cache.size() > s_forsyth_cache_size)
+        {
+            new_cache.resize(s_forsyth_cache_size);
+        }
+        std::swap(cache, new_cache);
+    }
+
+    indices = std::move(result);
+}
+
+void OptimizeOverdraw(std::vector<uint32_t>& indices,
+                      const float* positions,
+                      size_t vertex_count,
+                      size_t position_stride,
+                      float threshold)
+{
+    size_t triangle_count = indices.size() / 3;
+    if (triangle_count < 2)
+    {
+        return;
+    }
+
+    // hard boundaries: triangles where the cache restarts from scratch (three misses)
+    // the first cluster starts at triangle 0 whatever its misses
+    std::vector<uint32_t> hard_clusters{0};
+    {
+        FifoCache cache(vertex_count, s_default_cache_size_);
+        for (uint32_t triangle = 0; triangle < triangle_count; ++triangle)
+        {
+            int misses = cache.Access(indices[triangle * 3 + 0])
+                       + cache.Access(indices[triangle * 3 + 1])
+                       + cache.Access(indices[triangle * 3 + 2]);
+            if (misses == 3 && triangle != 0)
+            {
+                hard_clusters.push_back(triangle);
+            }
+        }
+    }
+    hard_clusters.push_back(static_cast<uint32_t>(triangle_count));
+
+    // soft boundaries: split a hard cluster wherever the prefix stays within threshold of its ACMR,
+    // smaller clusters give the sort more freedom at a bounded vertex cache cost
+    std::vector<uint32_t> clusters;
+    {
+        FifoCache cache(vertex_count, s_default_cache_size_);
+        for (size_t c = 0; c + 1 < hard_clusters.size(); ++c)
+        {
+            uint32_t begin = hard_clusters[c];
+            uint32_t end = hard_clusters[c + 1];
+
+            cache.Reset();
+            uint32_t cluster_misses = 0;
+            for (uint32_t triangle = begin; triangle < end; ++triangle)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    cluster_misses += cache.Access(indices[triangle * 3 + k]);
+                }
+            }
+            float cluster_acmr = static_cast<float>(cluster_misses) / (end - begin);
+
+            cache.Reset();
+            clusters.push_back(begin);
+            uint32_t running_misses = 0;
+            uint32_t running_triangles = 0;
+            for (uint32_t triangle = begin; triangle < end; ++triangle)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    running_misses += cache.Access(indices[triangle * 3 + k]);
+                }
+                ++running_triangles;
+
+                if (triangle + 1 < end && static_cast<float>(running_misses) / running_triangles <= cluster_acmr * threshold)
+                {
+                    clusters.push_back(triangle + 1);
+                    cache.Reset();
+                    running_misses = 0;
+                    running_triangles = 0;
+                }
+            }
+        }
+    }
+    clusters.push_back(static_cast<uint32_t>(triangle_count));
+
+    size_t cluster_count = clusters.size() - 1;
+
+    // area weighted centroid and normal per cluster
+    std::vector<Float3> cluster_centroids(cluster_count, Float3{0, 0, 0});
+    std::vector<Float3> cluster_normals(cluster_count, Float3{0, 0, 0});
+    Float3 mesh_centroid{0, 0, 0};
+    float mesh_area = 0.0f;
+
+    for (size_t c = 0; c < cluster_count; ++c)
+    {
+        float cluster_area = 0.0f;
+        for (uint32_t triangle = clusters[c]; triangle < clusters[c + 1]; ++triangle)
+        {
+            Float3 a = ReadPosition(positions, position_stride, indices[triangle * 3 + 0]);
+            Float3 b = ReadPosition(positions, position_stride, indices[triangle * 3 + 1]);
+            Float3 d = ReadPosition(positions, position_stride, indices[triangle * 3 + 2]);
+
+            Float3 e0{b.x_ - a.x_, b.y_ - a.y_, b.z_ - a.z_};
+            Float3 e1{d.x_ - a.x_, d.y_ - a.y_, d.z_ - a.z_};
+            Float3 n{e0.y_ * e1.z_ - e0.z_ * e1.y_, e0.z_ * e1.x_ - e0.x_ * e1.z_, e0.x_ * e1.y_ - e0.y_ * e1.x_};
+            float area = std::sqrt(n.x_ * n.x_ + n.y_ * n.y_ + n.z_ * n.z_);
+
+            Float3 centroid{(a.x_ + b.x_ + d.x_) / 3.0f, (a.y_ + b.y_ + d.y_) / 3.0f, (a.z_ + b.z_ + d.z_) / 3.0f};
+
+            cluster_centroids[c].x_ += centroid.x_ * area;
+            cluster_centroids[c].y_ += centroid.y_ * area;
+            cluster_centroids[c].z_ += centroid.z_ * area;
+            cluster_normals[c].x_ += n.x_;
+            cluster_normals[c].y_ += n.y_;
+            cluster_normals[c].z_ += n.z_;
+            cluster_area += area;
+        }
+
+        mesh_centroid.x_ += cluster_centroids[c].x_;
+        mesh_centroid.y_ += cluster_centroids[c].y_;
+        mesh_centroid.z_ += cluster_centroids[c].z_;
+        mesh_area += cluster_area;
+
+        float inverse_area = cluster_area > 0.0f ? 1.0f / cluster_area : 0.0f;
+        cluster_centroids[c].x_ *= inverse_area;
+        cluster_centroids[c].y_ *= inverse_area;
+        cluster_centroids[c].z_ *= inverse_area;
+    }
+
+    float inverse_mesh_area = mesh_area > 0.0f ? 1.0f / mesh_area : 0.0f;
+    mesh_centroid.x_ *= inverse_mesh_area;
+    mesh_centroid.y_ *= inverse_mesh_area;
+    mesh_centroid.z_ *= inverse_mesh_area;
+
+    // clusters facing away from the mesh center occlude the ones behind them, draw them first
+    std::vector<float> sort_keys(cluster_count);
+    for (size_t c = 0; c < cluster_count; ++c)
+    {
+        Float3 n = cluster_normals[c];
+        float length = std::sqrt(n.x_ * n.x_ + n.y_ * n.y_ + n.z_ * n.z_);
+        float inverse_length = length > 0.0f ? 1.0f / length : 0.0f;
+
+        sort_keys[c] = ((cluster_centroids[c].x_ - mesh_centroid.x_) * n.x_
+                      + (cluster_centroids[c].y_ - mesh_centroid.y_) * n.y_
+                      + (cluster_centroids[c].z_ - mesh_centroid.z_) * n.z_) * inverse_length;
+    }
+
+    std::vector<uint32_t> order(cluster_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) { return sort_keys[lhs] > sort_keys[rhs]; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (uint32_t c : order)
+    {
+        result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+    }
+
+    indices = std::move(result);
+}
+
+size_t OptimizeVertexFetchRemap(std::vector<uint32_t>& remap, const std::vector<uint32_t>& indices, size_t vertex_count)
+{
+    remap.assign(vertex_count, s_invalid_index);
+
+    uint32_t next_index = 0;
+    for (uint32_t index : indices)
+    {
+        if (remap[index] == s_invalid_index)
+        {
+            remap[index] = next_index++;
+        }
+    }
+
+    return next_index;
+}
+
+VertexCacheStatistics AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertex_count, uint32_t cache_size)
+{
+    VertexCacheStatistics statistics{};
+
+    size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0)
+    {
+        return statistics;
+    }
+
+    FifoCache cache(vertex_count, cache_size);
+    std::vector<bool> referenced(vertex_count, false);
+    uint32_t unique_vertices = 0;
+
+    for (uint32_t index : indices)
+    {
+        statistics.vertices_transformed_ += cache.Access(index);
+        if (!referenced[index])
+        {
+            referenced[index] = true;
+            ++unique_vertices;
+        }
+    }
+
+    statistics.acmr_ = static_cast<float>(statistics.vertices_transformed_) / triangle_count;
+    statistics.atvr_ = static_cast<float>(statistics.vertices_transformed_) / unique_vertices;
+
+    return statistics;
+}
+
+void PrintReport(const char* name, const MeshOptimizationReport& report)
+{
+    std::cout << std::fixed << std::setprecision(3)
+              << "Mesh " << name << ": vertices " << report.vertex_count_before_ << " -> " << report.vertex_count_after_
+              << ", indices " << report.index_count_
+              << ", ACMR " << report.before_.acmr_ << " -> " << report.after_.acmr_
+              << ", ATVR " << report.before_.atvr_ << " -> " << report.after_.atvr_
+              << std::defaultfloat << std::endl;
+}
+
+} // namespace renderer::mesh
@@ -0,0 +1,119 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace renderer::mesh {
+
+// Post-transform cache statistics of an index buffer, simulated with a FIFO cache.
+// ACMR: transformed vertices per triangle (0.5 is ideal for large grids, 3.0 is unindexed).
+// ATVR: transformed vertices per unique vertex (1.0 is ideal).
+struct VertexCacheStatistics
+{
+    uint32_t vertices_transformed_ = 0;
+    float acmr_ = 0.0f;
+    float atvr_ = 0.0f;
+};
+
+struct MeshOptimizationReport
+{
+    size_t vertex_count_before_ = 0;
+    size_t vertex_count_after_ = 0;
+    size_t index_count_ = 0;
+
+    VertexCacheStatistics before_;
+    VertexCacheStatistics after_;
+};
+
+static constexpr uint32_t s_default_cache_size_ = 16;
+
+// Builds a remap table that maps every vertex to its first bitwise identical occurrence,
+// renumbered densely. Returns the number of unique vertices. indices may be empty (unindexed).
+size_t GenerateVertexRemap(std::vector<uint32_t>& remap,
+                           const std::vector<uint32_t>& indices,
+                           const void* vertices,
+                           size_t vertex_count,
+                           size_t vertex_size);
+
+// Applies a remap table: vertices move to remap[i], ~0u entries are dropped.
+void RemapVertexBuffer(void* destination, const void* vertices, size_t vertex_count, size_t vertex_size, const std::vector<uint32_t>& remap);
+void RemapIndexBuffer(std::vector<uint32_t>& indices, const std::vector<uint32_t>& remap);
+
+// Reorders triangles for the post-transform vertex cache (Forsyth, linear speed vertex cache optimisation).
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertex_count);
+
+// Reorders the clusters of a cache optimized index buffer so outward facing geometry is drawn
+// first (Sander et al.). threshold bounds the allowed ACMR increase, 1.05 allows 5%.
+void OptimizeOverdraw(std::vector<uint32_t>& indices,
+                      const float* positions,
+                      size_t vertex_count,
+                      size_t position_stride,
+                      float threshold = 1.05f);
+
+// Builds a remap table ordering vertices by first use in the index buffer. Unreferenced vertices
+// map to ~0u. Returns the number of referenced vertices.
+size_t OptimizeVertexFetchRemap(std::vector<uint32_t>& remap, const std::vector<uint32_t>& indices, size_t vertex_count);
+
+VertexCacheStatistics AnalyzeVertexCache(const std::vector<uint32_t>& indices,
+                                         size_t vertex_count,
+                                         uint32_t cache_size = s_default_cache_size_);
+
+void PrintReport(const char* name, const MeshOptimizationReport& report);
+
+// Runs the whole pipeline on a vertex type with a float3 pos_ member: deduplication (which turns
+// unindexed meshes into indexed ones), vertex cache, overdraw and vertex fetch ordering.
+template<typename Vertex>
+MeshOptimizationReport OptimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+    MeshOptimizationReport report{};
+    report.vertex_count_before_ = vertices.size();
+    if (vertices.empty())
+    {
+        return report;
+    }
+
+    std::vector<uint32_t> identity;
+    const std::vector<uint32_t>* source_indices = &indices;
+    if (indices.empty())
+    {
+        identity.resize(vertices.size());
+        for (uint32_t i = 0; i < identity.size(); ++i)
+        {
+            identity[i] = i;
+        }
+        source_indices = &identity;
+    }
+    report.before_ = AnalyzeVertexCache(*source_indices, vertices.size());
+
+    // deduplication
+    std::vector<uint32_t> remap;
+    size_t unique_count = GenerateVertexRemap(remap, indices, vertices.data(), vertices.size(), sizeof(Vertex));
+
+    std::vector<uint32_t> new_indices = *source_indices;
+    RemapIndexBuffer(new_indices, remap);
+
+    std::vector<Vertex> unique_vertices(unique_count);
+    RemapVertexBuffer(unique_vertices.data(), vertices.data(), vertices.size(), sizeof(Vertex), remap);
+
+    // triangle order
+    OptimizeVertexCache(new_indices, unique_vertices.size());
+    OptimizeOverdraw(new_indices, &unique_vertices.data()->pos_[0], unique_vertices.size(), sizeof(Vertex));
+
+    // vertex order
+    size_t fetched_count = OptimizeVertexFetchRemap(remap, new_indices, unique_vertices.size());
+    vertices.resize(fetched_count);
+    RemapVertexBuffer(vertices.data(), unique_vertices.data(), unique_vertices.size(), sizeof(Vertex), remap);
+    RemapIndexBuffer(new_indices, remap);
+
+    indices = std::move(new_indices);
+
+    report.vertex_count_after_ = vertices.size();
+    report.index_count_ = indices.size();
+    report.after_ = AnalyzeVertexCache(indices, vertices.size());
+
+    return report;
+}
+
+} // namespace renderer::mesh
@@ -0,0 +1,352 @@
+#include <renderer/renderer/mesh/mesh_simplifier.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_set>
+
+// glm
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// renderer includes
+#include <renderer/renderer/mesh/mesh_optimizer.hpp>
+
+namespace renderer::mesh {
+
+namespace {
+
+constexpr double s_infinity = std::numeric_limits<double>::infinity();
+// about 75 degrees
+constexpr double s_max_normal_rotation_cos = 0.25;
+
+// Sum of squared distances to a set of planes, p^T Q p with p = (x, y, z, 1). Only the upper
+// triangle of the symmetric 4x4 matrix is stored.
+struct Quadric
+{
+    double a00_ = 0.0, a01_ = 0.0, a02_ = 0.0, a03_ = 0.0;
+    double a11_ = 0.0, a12_ = 0.0, a13_ = 0.0;
+    double a22_ = 0.0, a23_ = 0.0;
+    double a33_ = 0.0;
+    // summed area of the planes, errors are averaged by it
+    double weight_ = 0.0;
+};
+
+Quadric MakePlaneQuadric(const glm::dvec3& normal, double distance, double weight)
+{
+    Quadric q{};
+    q.a00_ = weight * normal.x * normal.x;
+    q.a01_ = weight * normal.x * normal.y;
+    q.a02_ = weight * normal.x * normal.z;
+    q.a03_ = weight * normal.x * distance;
+    q.a11_ = weight * normal.y * normal.y;
+    q.a12_ = weight * normal.y * normal.z;
+    q.a13_ = weight * normal.y * distance;
+    q.a22_ = weight * normal.z * normal.z;
+    q.a23_ = weight * normal.z * distance;
+    q.a33_ = weight * distance * distance;
+    q.weight_ = weight;
+    return q;
+}
+
+void AddQuadric(Quadric& result, const Quadric& q)
+{
+    result.a00_ += q.a00_; result.a01_ += q.a01_; result.a02_ += q.a02_; result.a03_ += q.a03_;
+    result.a11_ += q.a11_; result.a12_ += q.a12_; result.a13_ += q.a13_;
+    result.a22_ += q.a22_; result.a23_ += q.a23_;
+    result.a33_ += q.a33_;
+    result.weight_ += q.weight_;
+}
+
+// area weighted RMS distance of p to the planes of q
+double EvaluateQuadric(const Quadric& q, const glm::dvec3& p)
+{
+    if (q.weight_ <= 0.0)
+    {
+        return 0.0;
+    }
+
+    double value = q.a00_ * p.x * p.x + 2.0 * q.a01_ * p.x * p.y + 2.0 * q.a02_ * p.x * p.z + 2.0 * q.a03_ * p.x
+                 + q.a11_ * p.y * p.y + 2.0 * q.a12_ * p.y * p.z + 2.0 * q.a13_ * p.y
+                 + q.a22_ * p.z * p.z + 2.0 * q.a23_ * p.z
+                 + q.a33_;
+    return std::sqrt(std::fabs(value) / q.weight_);
+}
+
+struct Collapse
+{
+    uint32_t from_;
+    uint32_t to_;
+    double error_;
+};
+
+// Marks vertices that must not move: on an open edge, or sharing their position with another
+// referenced vertex (attribute seams, where collapsing one copy alone would tear the surface).
+std::vector<uint8_t> FindLockedVertices(const std::vector<uint32_t>& indices, const std::vector<glm::dvec3>& positions)
+{
+    size_t vertex_count = positions.size();
+    std::vector<uint8_t> locked(vertex_count, 0);
+
+    std::vector<uint8_t> referenced(vertex_count, 0);
+    for (uint32_t index : indices)
+    {
+        referenced[index] = 1;
+    }
+
+    std::vector<glm::vec3> packed(vertex_count);
+    for (size_t i = 0; i < vertex_count; ++i)
+    {
+        packed[i] = glm::vec3(positions[i]);
+    }
+
+    std::vector<uint32_t> position_remap;
+    size_t unique_count = GenerateVertexRemap(position_remap, {}, packed.data(), vertex_count, sizeof(glm::vec3));
+
+    std::vector<uint32_t> copies(unique_count, 0);
+    for (size_t i = 0; i < vertex_count; ++i)
+    {
+        copies[position_remap[i]] += referenced[i];
+    }
+    for (size_t i = 0; i < vertex_count; ++i)
+    {
+        locked[i] = copies[position_remap[i]] > 1;
+    }
+
+    std::unordered_set<uint64_t> half_edges;
+    half_edges.reserve(indices.size());
+    auto edge_key = [](uint32_t a, uint32_t b) { return (static_cast<uint64_t>(a) << 32) | b; };
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        for (size_t k = 0; k < 3; ++k)
+        {
+            half_edges.insert(edge_key(indices[i + k], indices[i + (k + 1) % 3]));
+        }
+    }
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        for (size_t k = 0; k < 3; ++k)
+        {
+            uint32_t a = indices[i + k];
+            uint32_t b = indices[i + (k + 1) % 3];
+            if (half_edges.find(edge_key(b, a)) == half_edges.end())
+            {
+                locked[a] = 1;
+                locked[b] = 1;
+            }
+        }
+    }
+
+    return locked;
+}
+
+// true when moving from_ onto to_ turns a surviving triangle around or tilts it too far
+bool FlipsTriangle(const Collapse& collapse,
+                   const std::vector<uint32_t>& indices,
+                   const std::vector<glm::dvec3>& positions,
+                   const std::vector<uint32_t>& adjacency_offsets,
+                   const std::vector<uint32_t>& adjacency)
+{
+    for (uint32_t i = adjacency_offsets[collapse.from_]; i < adjacency_offsets[collapse.from_ + 1]; ++i)
+    {
+        const uint32_t* triangle = &indices[adjacency[i] * 3];
+        if (triangle[0] == collapse.to_ || triangle[1] == collapse.to_ || triangle[2] == collapse.to_)
+        {
+            // removed by the collapse
+            continue;
+        }
+
+        glm::dvec3 p[3];
+        glm::dvec3 moved[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            p[k] = positions[triangle[k]];
+            moved[k] = triangle[k] == collapse.from_ ? positions[collapse.to_] : p[k];
+        }
+
+        glm::dvec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+        glm::dvec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+        // rejecting large rotations as well keeps slivers from folding over in later collapses
+        if (glm::dot(before, after) <= s_max_normal_rotation_cos * glm::length(before) * glm::length(after))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+std::vector<uint32_t> SimplifyMesh(const std::vector<uint32_t>& indices,
+                                   const float* positions,
+                                   size_t vertex_count,
+                                   size_t position_stride,
+                                   size_t target_index_count,
+                                   float target_error,
+                                   float* result_error)
+{
+    std::vector<glm::dvec3> points(vertex_count);
+    for (size_t i = 0; i < vertex_count; ++i)
+    {
+        const float* p = reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(positions) + i * position_stride);
+        points[i] = glm::dvec3(p[0], p[1], p[2]);
+    }
+
+    // drop degenerate input triangles up front
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        if (a != b && b != c && a != c)
+        {
+            result.insert(result.end(), {a, b, c});
+        }
+    }
+
+    std::vector<uint8_t> locked = FindLockedVertices(result, points);
+
+    std::vector<Quadric> quadrics(vertex_count);
+    for (size_t i = 0; i < result.size(); i += 3)
+    {
+        const glm::dvec3& p0 = points[result[i]];
+        glm::dvec3 normal = glm::cross(points[result[i + 1]] - p0, points[result[i + 2]] - p0);
+        double length = glm::length(normal);
+        if (length <= 0.0)
+        {
+            continue;
+        }
+
+        normal /= length;
+        Quadric plane = MakePlaneQuadric(normal, -glm::dot(normal, p0), length * 0.5);
+        for (size_t k = 0; k < 3; ++k)
+        {
+            AddQuadric(quadrics[result[i + k]], plane);
+        }
+    }
+
+    double max_error = 0.0;
+    std::vector<uint32_t> remap(vertex_count);
+    std::vector<uint8_t> touched(vertex_count);
+    std::vector<uint32_t> adjacency_offsets(vertex_count + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+
+    // Each pass collapses the cheapest edges whose neighbourhoods do not overlap, so quadrics and
+    // adjacency stay exact within a pass, then rebuilds the index buffer.
+    while (result.size() > target_index_count)
+    {
+        size_t triangle_count = result.size() / 3;
+
+        std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+        for (uint32_t index : result)
+        {
+            ++adjacency_offsets[index + 1];
+        }
+        std::partial_sum(adjacency_offsets.begin(), adjacency_offsets.end(), adjacency_offsets.begin());
+
+        adjacency.resize(result.size());
+        {
+            std::vector<uint32_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+            for (uint32_t triangle = 0; triangle < triangle_count; ++triangle)
+            {
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    adjacency[fill[result[triangle * 3 + k]]++] = triangle;
+                }
+            }
+        }
+
+        // every interior edge is seen once from each side, evaluate it from the a < b side
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            for (size_t k = 0; k < 3; ++k)
+            {
+                uint32_t a = result[i + k];
+                uint32_t b = result[i + (k + 1) % 3];
+                if (a > b || (locked[a] && locked[b]))
+                {
+                    continue;
+                }
+
+                Quadric combined = quadrics[a];
+                AddQuadric(combined, quadrics[b]);
+
+                double a_to_b = locked[a] ? s_infinity : EvaluateQuadric(combined, points[b]);
+                double b_to_a = locked[b] ? s_infinity : EvaluateQuadric(combined, points[a]);
+                collapses.push_back(a_to_b <= b_to_a ? Collapse{a, b, a_to_b} : Collapse{b, a, b_to_a});
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& l, const Collapse& r) { return l.error_ < r.error_; });
+
+        std::iota(remap.begin(), remap.end(), 0u);
+        std::fill(touched.begin(), touched.end(), 0);
+
+        size_t triangles_to_remove = (result.size() - target_index_count + 2) / 3;
+        size_t triangles_removed = 0;
+        size_t collapse_count = 0;
+
+        for (const Collapse& collapse : collapses)
+        {
+            if (collapse.error_ > target_error || triangles_removed >= triangles_to_remove)
+            {
+                break;
+            }
+            if (touched[collapse.from_] || touched[collapse.to_])
+            {
+                continue;
+            }
+            if (FlipsTriangle(collapse, result, points, adjacency_offsets, adjacency))
+            {
+                continue;
+            }
+
+            remap[collapse.from_] = collapse.to_;
+            AddQuadric(quadrics[collapse.to_], quadrics[collapse.from_]);
+            max_error = std::max(max_error, collapse.error_);
+            ++collapse_count;
+
+            // every triangle around from_ changes, keep later collapses of this pass away from them
+            for (uint32_t i = adjacency_offsets[collapse.from_]; i < adjacency_offsets[collapse.from_ + 1]; ++i)
+            {
+                const uint32_t* triangle = &result[adjacency[i] * 3];
+                bool removed = false;
+                for (int k = 0; k < 3; ++k)
+                {
+                    touched[triangle[k]] = 1;
+                    removed |= triangle[k] == collapse.to_;
+                }
+                triangles_removed += removed;
+            }
+        }
+
+        if (collapse_count == 0)
+        {
+            break;
+        }
+
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+            if (a != b && b != c && a != c)
+            {
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+        }
+        result.resize(write);
+    }
+
+    if (result_error)
+    {
+        *result_error = static_cast<float>(max_error);
+    }
+    return result;
+}
+
+} // namespace renderer::mesh
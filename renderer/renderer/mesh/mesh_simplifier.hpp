@@ -0,0 +1,25 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace renderer::mesh {
+
+// Quadric error metric edge collapse (Garland and Heckbert). Vertices only collapse onto other
+// existing vertices, so the result indexes the same vertex buffer and can be stored as another
+// index range next to the source. Open borders and attribute seams (several vertices sharing a
+// position) are kept in place, so neighbouring submeshes and UV islands stay watertight.
+//
+// Stops once the index count reaches target_index_count or no collapse stays below target_error,
+// an object space distance. result_error receives the largest error of the applied collapses.
+std::vector<uint32_t> SimplifyMesh(const std::vector<uint32_t>& indices,
+                                   const float* positions,
+                                   size_t vertex_count,
+                                   size_t position_stride,
+                                   size_t target_index_count,
+                                   float target_error,
+                                   float* result_error = nullptr);
+
+} // namespace renderer::mesh
@@ -0,0 +1,50 @@
+#include <renderer/renderer/mesh/mesh_vertex.hpp>
+
+namespace renderer::mesh {
+
+void GenerateNormals(std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    for (MeshVertex& vertex : vertices)
+    {
+        vertex.normal_ = glm::vec3(0.0f);
+    }
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        MeshVertex& a = vertices[indices[i + 0]];
+        MeshVertex& b = vertices[indices[i + 1]];
+        MeshVertex& c = vertices[indices[i + 2]];
+
+        // unnormalized cross product: its length is twice the triangle area
+        glm::vec3 normal = glm::cross(b.pos_ - a.pos_, c.pos_ - a.pos_);
+        a.normal_ += normal;
+        b.normal_ += normal;
+        c.normal_ += normal;
+    }
+
+    for (MeshVertex& vertex : vertices)
+    {
+        float length = glm::length(vertex.normal_);
+        vertex.normal_ = length > 0.0f ? vertex.normal_ / length : glm::vec3(0.0f, 0.0f, 1.0f);
+    }
+}
+
+glm::vec4 ComputeBoundingSphere(const std::vector<MeshVertex>& vertices)
+{
+    if (vertices.empty())
+    {
+        return glm::vec4(0.0f);
+    }
+
+    glm::vec3 min = vertices[0].pos_;
+    glm::vec3 max = vertices[0].pos_;
+    for (const MeshVertex& vertex : vertices)
+    {
+        min = glm::min(min, vertex.pos_);
+        max = glm::max(max, vertex.pos_);
+    }
+
+    return glm::vec4((min + max) * 0.5f, glm::length(max - min) * 0.5f);
+}
+
+} // namespace renderer::mesh
@@ -0,0 +1,50 @@
+#pragma once
+
+// std
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// glm
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// renderer includes
+#include <renderer/renderer/vertex_layout.hpp>
+
+namespace renderer::mesh {
+
+// Full precision vertex as produced by importers, before quantization.
+// tangent_.w holds the bitangent sign.
+struct MeshVertex
+{
+    glm::vec3 pos_{0.0f};
+    glm::vec3 normal_{0.0f};
+    glm::vec4 tangent_{0.0f};
+    glm::vec2 uv_{0.0f};
+    glm::vec4 col_{1.0f};
+};
+
+// Area weighted vertex normals from the triangles, for sources without normals.
+void GenerateNormals(std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices);
+
+// (center, radius) of the sphere around the bounding box
+glm::vec4 ComputeBoundingSphere(const std::vector<MeshVertex>& vertices);
+
+} // namespace renderer::mesh
+
+namespace renderer {
+
+template<>
+struct VertexAttributes<mesh::MeshVertex>
+{
+    static constexpr std::array s_attributes_ = {
+        RENDERER_VERTEX_ATTRIBUTE(mesh::MeshVertex, pos_),
+        RENDERER_VERTEX_ATTRIBUTE(mesh::MeshVertex, normal_),
+        RENDERER_VERTEX_ATTRIBUTE(mesh::MeshVertex, tangent_),
+        RENDERER_VERTEX_ATTRIBUTE(mesh::MeshVertex, uv_),
+        RENDERER_VERTEX_ATTRIBUTE(mesh::MeshVertex, col_),
+    };
+};
+
+} // namespace renderer
@@ -0,0 +1,255 @@
+#include <renderer/renderer/mesh/meshlet.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// glm
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+namespace renderer::mesh {
+
+namespace {
+
+// cone cutoff of meshlets whose normals spread over a hemisphere or more
+constexpr float s_never_cull = 2.0f;
+// weight of facing the meshlet's way against adding a vertex when picking the next triangle
+constexpr float s_normal_weight = 0.5f;
+
+glm::vec3 ReadPosition(const float* positions, size_t stride, uint32_t index)
+{
+    const float* p = reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(positions) + index * stride);
+    return glm::vec3(p[0], p[1], p[2]);
+}
+
+void ComputeBounds(Meshlet& meshlet,
+                   std::span<const uint32_t> indices,
+                   const std::vector<glm::vec3>& triangle_normals,
+                   std::span<const uint32_t> triangles,
+                   const float* positions,
+                   size_t stride)
+{
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(std::numeric_limits<float>::lowest());
+    glm::vec3 normal_sum(0.0f);
+
+    for (uint32_t triangle : triangles)
+    {
+        for (size_t k = 0; k < 3; ++k)
+        {
+            glm::vec3 position = ReadPosition(positions, stride, indices[triangle * 3 + k]);
+            min = glm::min(min, position);
+            max = glm::max(max, position);
+        }
+        normal_sum += triangle_normals[triangle];
+    }
+
+    glm::vec3 center = (min + max) * 0.5f;
+    float radius = 0.0f;
+    for (uint32_t triangle : triangles)
+    {
+        for (size_t k = 0; k < 3; ++k)
+        {
+            radius = std::max(radius, glm::length(ReadPosition(positions, stride, indices[triangle * 3 + k]) - center));
+        }
+    }
+
+    float axis_length = glm::length(normal_sum);
+    glm::vec3 axis = axis_length > 0.0f ? normal_sum / axis_length : glm::vec3(0.0f, 0.0f, 1.0f);
+
+    // cos of the cone half angle: the normal furthest from the axis
+    float min_dot = axis_length > 0.0f ? 1.0f : -1.0f;
+    for (uint32_t triangle : triangles)
+    {
+        const glm::vec3& normal = triangle_normals[triangle];
+        if (normal != glm::vec3(0.0f))
+        {
+            min_dot = std::min(min_dot, glm::dot(normal, axis));
+        }
+    }
+
+    meshlet.center_[0] = center.x;
+    meshlet.center_[1] = center.y;
+    meshlet.center_[2] = center.z;
+    meshlet.radius_ = radius;
+    meshlet.cone_axis_[0] = axis.x;
+    meshlet.cone_axis_[1] = axis.y;
+    meshlet.cone_axis_[2] = axis.z;
+    // back facing when the view direction is within 90 degrees minus the half angle of the axis
+    meshlet.cone_cutoff_ = min_dot > 0.0f ? std::sqrt(1.0f - min_dot * min_dot) : s_never_cull;
+}
+
+} // namespace
+
+std::vector<Meshlet> BuildMeshlets(std::span<uint32_t> indices,
+                                   uint32_t first_index,
+                                   const float* positions,
+                                   size_t vertex_count,
+                                   size_t position_stride,
+                                   const MeshletSettings& settings)
+{
+    size_t triangle_count = indices.size() / 3;
+    std::vector<Meshlet> meshlets;
+    if (triangle_count == 0)
+    {
+        return meshlets;
+    }
+
+    std::vector<glm::vec3> triangle_normals(triangle_count);
+    for (size_t triangle = 0; triangle < triangle_count; ++triangle)
+    {
+        glm::vec3 a = ReadPosition(positions, position_stride, indices[triangle * 3 + 0]);
+        glm::vec3 b = ReadPosition(positions, position_stride, indices[triangle * 3 + 1]);
+        glm::vec3 c = ReadPosition(positions, position_stride, indices[triangle * 3 + 2]);
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float length = glm::length(normal);
+        triangle_normals[triangle] = length > 0.0f ? normal / length : glm::vec3(0.0f);
+    }
+
+    // vertex -> triangle adjacency
+    std::vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+    for (uint32_t index : indices)
+    {
+        ++adjacency_offsets[index + 1];
+    }
+    for (size_t v = 0; v < vertex_count; ++v)
+    {
+        adjacency_offsets[v + 1] += adjacency_offsets[v];
+    }
+
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+        for (uint32_t triangle = 0; triangle < triangle_count; ++triangle)
+        {
+            for (size_t k = 0; k < 3; ++k)
+            {
+                adjacency[fill[indices[triangle * 3 + k]]++] = triangle;
+            }
+        }
+    }
+
+    std::vector<uint8_t> emitted(triangle_count, 0);
+    // id of the meshlet a vertex was last added to
+    std::vector<uint32_t> vertex_meshlet(vertex_count, ~0u);
+
+    std::vector<uint32_t> order;
+    order.reserve(triangle_count);
+    std::vector<uint32_t> candidates;
+
+    size_t seed = 0;
+    while (true)
+    {
+        // seeds follow the input order, which keeps the vertex cache order of optimized meshes
+        while (seed < triangle_count && emitted[seed])
+        {
+            ++seed;
+        }
+        if (seed == triangle_count)
+        {
+            break;
+        }
+
+        uint32_t id = static_cast<uint32_t>(meshlets.size());
+        size_t meshlet_begin = order.size();
+        uint32_t meshlet_vertices = 0;
+        glm::vec3 normal_sum(0.0f);
+
+        auto add_triangle = [&](uint32_t triangle)
+        {
+            emitted[triangle] = 1;
+            order.push_back(triangle);
+            normal_sum += triangle_normals[triangle];
+
+            for (size_t k = 0; k < 3; ++k)
+            {
+                uint32_t vertex = indices[triangle * 3 + k];
+                if (vertex_meshlet[vertex] == id)
+                {
+                    continue;
+                }
+
+                vertex_meshlet[vertex] = id;
+                ++meshlet_vertices;
+                for (uint32_t i = adjacency_offsets[vertex]; i < adjacency_offsets[vertex + 1]; ++i)
+                {
+                    if (!emitted[adjacency[i]])
+                    {
+                        candidates.push_back(adjacency[i]);
+                    }
+                }
+            }
+        };
+
+        candidates.clear();
+        add_triangle(static_cast<uint32_t>(seed));
+
+        while (order.size() - meshlet_begin < settings.max_triangles_)
+        {
+            float normal_length = glm::length(normal_sum);
+            glm::vec3 direction = normal_length > 0.0f ? normal_sum / normal_length : glm::vec3(0.0f);
+
+            uint32_t best = ~0u;
+            float best_score = std::numeric_limits<float>::max();
+
+            // drops emitted candidates while scanning
+            size_t write = 0;
+            for (uint32_t candidate : candidates)
+            {
+                if (emitted[candidate])
+                {
+                    continue;
+                }
+                candidates[write++] = candidate;
+
+                uint32_t new_vertices = 0;
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    new_vertices += vertex_meshlet[indices[candidate * 3 + k]] != id;
+                }
+                if (meshlet_vertices + new_vertices > settings.max_vertices_)
+                {
+                    continue;
+                }
+
+                float score = static_cast<float>(new_vertices) + (1.0f - glm::dot(triangle_normals[candidate], direction)) * s_normal_weight;
+                if (score < best_score)
+                {
+                    best_score = score;
+                    best = candidate;
+                }
+            }
+            candidates.resize(write);
+
+            if (best == ~0u)
+            {
+                break;
+            }
+            add_triangle(best);
+        }
+
+        std::span<const uint32_t> triangles(order.data() + meshlet_begin, order.size() - meshlet_begin);
+
+        Meshlet meshlet{};
+        meshlet.first_index_ = first_index + static_cast<uint32_t>(meshlet_begin * 3);
+        meshlet.index_count_ = static_cast<uint32_t>(triangles.size() * 3);
+        ComputeBounds(meshlet, indices, triangle_normals, triangles, positions, position_stride);
+        meshlets.push_back(meshlet);
+    }
+
+    std::vector<uint32_t> reordered(triangle_count * 3);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        for (size_t k = 0; k < 3; ++k)
+        {
+            reordered[i * 3 + k] = indices[order[i] * 3 + k];
+        }
+    }
+    std::copy(reordered.begin(), reordered.end(), indices.begin());
+
+    return meshlets;
+}
+
+} // namespace renderer::mesh
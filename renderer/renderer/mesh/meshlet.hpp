@@ -0,0 +1,50 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace renderer::mesh {
+
+static constexpr uint32_t s_meshlet_max_vertices_ = 64;
+static constexpr uint32_t s_meshlet_max_triangles_ = 124;
+
+// A cluster of nearby triangles, stored as a contiguous range of the index buffer so it can be
+// drawn as an index sub-range. Stored as is in .rmesh files.
+struct Meshlet
+{
+    uint32_t first_index_;
+    uint32_t index_count_;
+
+    // object space bounding sphere
+    float center_[3];
+    float radius_;
+
+    // Normal cone: every triangle faces away from a camera at position c when
+    // dot(center - c, cone_axis) >= cone_cutoff * |center - c| + radius.
+    // cone_cutoff_ is above 1 when the normals spread too far to ever cull.
+    float cone_axis_[3];
+    float cone_cutoff_;
+};
+
+struct MeshletSettings
+{
+    // 64 / 124 fit the common mesh shader output limits as well
+    uint32_t max_vertices_ = s_meshlet_max_vertices_;
+    uint32_t max_triangles_ = s_meshlet_max_triangles_;
+};
+
+// Partitions the triangles of indices into meshlets and reorders them in place so that every
+// meshlet is a contiguous range. Meshlets grow from a seed triangle over shared vertices,
+// preferring triangles that add no new vertex and face the same way as the meshlet.
+// first_index is the offset of indices in the full index buffer, used for Meshlet::first_index_.
+std::vector<Meshlet> BuildMeshlets(std::span<uint32_t> indices,
+                                   uint32_t first_index,
+                                   const float* positions,
+                                   size_t vertex_count,
+                                   size_t position_stride,
+                                   const MeshletSettings& settings = MeshletSettings{});
+
+} // namespace renderer::mesh
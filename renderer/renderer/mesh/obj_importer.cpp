@@ -0,0 +1,480 @@
+#include <renderer/renderer/mesh/mesh_importer.hpp>
+
+// std
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+// renderer includes
+#include <renderer/renderer/mapped_file.hpp>
+#include <renderer/renderer/parallel_for.hpp>
+#include <renderer/renderer/mesh/mesh_optimizer.hpp>
+
+namespace renderer::mesh {
+
+namespace {
+
+constexpr size_t s_min_chunk_size = 1 << 20;
+constexpr uint32_t s_chunks_per_worker = 4;
+// vertices built per task when expanding corners
+constexpr size_t s_vertex_batch = 1 << 16;
+
+// attribute indices of a face corner, uv_ and normal_ are 1-based with 0 for none
+struct ObjCorner
+{
+    uint32_t position_;
+    uint32_t uv_;
+    uint32_t normal_;
+};
+
+struct ObjChunk
+{
+    const char* begin_ = nullptr;
+    const char* end_ = nullptr;
+
+    // first pass: attributes declared in this chunk
+    std::vector<glm::vec3> positions_;
+    std::vector<glm::vec3> colors_;
+    std::vector<glm::vec2> uvs_;
+    std::vector<glm::vec3> normals_;
+
+    // attributes declared before this chunk
+    size_t position_base_ = 0;
+    size_t uv_base_ = 0;
+    size_t normal_base_ = 0;
+
+    // second pass: triangulated corners and the material groups starting in this chunk
+    std::vector<ObjCorner> corners_;
+    std::vector<std::pair<std::string, size_t>> material_starts_;
+};
+
+struct ObjAttributes
+{
+    std::vector<glm::vec3> positions_;
+    std::vector<glm::vec3> colors_;
+    std::vector<glm::vec2> uvs_;
+    std::vector<glm::vec3> normals_;
+    bool has_colors_ = false;
+};
+
+const char* SkipSpaces(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+    {
+        ++p;
+    }
+    return p;
+}
+
+const char* NextLine(const char* p, const char* end)
+{
+    const void* newline = std::memchr(p, '\n', static_cast<size_t>(end - p));
+    return newline ? static_cast<const char*>(newline) + 1 : end;
+}
+
+// line end without the line break
+const char* LineEnd(const char* p, const char* next_line)
+{
+    const char* end = next_line;
+    while (end > p && (end[-1] == '\n' || end[-1] == '\r'))
+    {
+        --end;
+    }
+    return end;
+}
+
+bool ParseFloat(const char*& p, const char* end, float& value)
+{
+    p = SkipSpaces(p, end);
+    if (p < end && *p == '+')
+    {
+        ++p;
+    }
+
+    auto [next, error] = std::from_chars(p, end, value);
+    if (error != std::errc())
+    {
+        return false;
+    }
+    p = next;
+    return true;
+}
+
+bool ParseInt(const char*& p, const char* end, int64_t& value)
+{
+    auto [next, error] = std::from_chars(p, end, value);
+    if (error != std::errc())
+    {
+        return false;
+    }
+    p = next;
+    return true;
+}
+
+// 1-based or negative (relative) OBJ index to 0-based, -1 when out of range
+int64_t ResolveIndex(int64_t index, size_t count)
+{
+    int64_t resolved = index > 0 ? index - 1 : static_cast<int64_t>(count) + index;
+    return resolved >= 0 && resolved < static_cast<int64_t>(count) ? resolved : -1;
+}
+
+bool IsKeyword(const char* p, const char* end, std::string_view keyword)
+{
+    size_t length = keyword.size();
+    return static_cast<size_t>(end - p) > length
+        && std::memcmp(p, keyword.data(), length) == 0
+        && (p[length] == ' ' || p[length] == '\t');
+}
+
+void ParseAttributes(ObjChunk& chunk)
+{
+    for (const char* line = chunk.begin_; line < chunk.end_; )
+    {
+        const char* next_line = NextLine(line, chunk.end_);
+        const char* end = LineEnd(line, next_line);
+        const char* p = SkipSpaces(line, end);
+
+        if (IsKeyword(p, end, "v"))
+        {
+            p += 1;
+            glm::vec3 position;
+            if (!ParseFloat(p, end, position.x) || !ParseFloat(p, end, position.y) || !ParseFloat(p, end, position.z))
+            {
+                throw std::runtime_error("Malformed OBJ vertex");
+            }
+
+            // optional vertex colors extension: v x y z r g b (a single extra value is w)
+            glm::vec3 color(1.0f);
+            if (ParseFloat(p, end, color.x) && ParseFloat(p, end, color.y))
+            {
+                if (!ParseFloat(p, end, color.z))
+                {
+                    throw std::runtime_error("Malformed OBJ vertex color");
+                }
+                if (chunk.colors_.size() < chunk.positions_.size())
+                {
+                    chunk.colors_.resize(chunk.positions_.size(), glm::vec3(1.0f));
+                }
+                chunk.colors_.push_back(color);
+            }
+
+            chunk.positions_.push_back(position);
+        }
+        else if (IsKeyword(p, end, "vt"))
+        {
+            p += 2;
+            glm::vec2 uv;
+            if (!ParseFloat(p, end, uv.x))
+            {
+                throw std::runtime_error("Malformed OBJ texture coordinate");
+            }
+            if (!ParseFloat(p, end, uv.y))
+            {
+                uv.y = 0.0f;
+            }
+            chunk.uvs_.push_back(uv);
+        }
+        else if (IsKeyword(p, end, "vn"))
+        {
+            p += 2;
+            glm::vec3 normal;
+            if (!ParseFloat(p, end, normal.x) || !ParseFloat(p, end, normal.y) || !ParseFloat(p, end, normal.z))
+            {
+                throw std::runtime_error("Malformed OBJ normal");
+            }
+            chunk.normals_.push_back(normal);
+        }
+
+        line = next_line;
+    }
+
+    if (!chunk.colors_.empty())
+    {
+        chunk.colors_.resize(chunk.positions_.size(), glm::vec3(1.0f));
+    }
+}
+
+void ParseFaces(ObjChunk& chunk)
+{
+    // attribute counts visible at the current line, for relative indices
+    size_t position_count = chunk.position_base_;
+    size_t uv_count = chunk.uv_base_;
+    size_t normal_count = chunk.normal_base_;
+
+    std::vector<ObjCorner> polygon;
+
+    for (const char* line = chunk.begin_; line < chunk.end_; )
+    {
+        const char* next_line = NextLine(line, chunk.end_);
+        const char* end = LineEnd(line, next_line);
+        const char* p = SkipSpaces(line, end);
+
+        if (IsKeyword(p, end, "v"))
+        {
+            ++position_count;
+        }
+        else if (IsKeyword(p, end, "vt"))
+        {
+            ++uv_count;
+        }
+        else if (IsKeyword(p, end, "vn"))
+        {
+            ++normal_count;
+        }
+        else if (IsKeyword(p, end, "usemtl"))
+        {
+            p = SkipSpaces(p + 6, end);
+            chunk.material_starts_.emplace_back(std::string(p, end), chunk.corners_.size());
+        }
+        else if (IsKeyword(p, end, "f"))
+        {
+            p += 1;
+            polygon.clear();
+
+            while (true)
+            {
+                p = SkipSpaces(p, end);
+                if (p >= end || *p == '#')
+                {
+                    break;
+                }
+
+                int64_t position_index = 0;
+                int64_t uv_index = 0;
+                int64_t normal_index = 0;
+
+                if (!ParseInt(p, end, position_index))
+                {
+                    throw std::runtime_error("Malformed OBJ face");
+                }
+                if (p < end && *p == '/')
+                {
+                    ++p;
+                    if (p < end && *p != '/')
+                    {
+                        ParseInt(p, end, uv_index);
+                    }
+                    if (p < end && *p == '/')
+                    {
+                        ++p;
+                        ParseInt(p, end, normal_index);
+                    }
+                }
+
+                ObjCorner corner{};
+
+                int64_t position = ResolveIndex(position_index, position_count);
+                if (position < 0)
+                {
+                    throw std::runtime_error("OBJ face references a missing vertex");
+                }
+                corner.position_ = static_cast<uint32_t>(position);
+
+                if (uv_index != 0)
+                {
+                    int64_t uv = ResolveIndex(uv_index, uv_count);
+                    if (uv < 0)
+                    {
+                        throw std::runtime_error("OBJ face references a missing texture coordinate");
+                    }
+                    corner.uv_ = static_cast<uint32_t>(uv + 1);
+                }
+
+                if (normal_index != 0)
+                {
+                    int64_t normal = ResolveIndex(normal_index, normal_count);
+                    if (normal < 0)
+                    {
+                        throw std::runtime_error("OBJ face references a missing normal");
+                    }
+                    corner.normal_ = static_cast<uint32_t>(normal + 1);
+                }
+
+                polygon.push_back(corner);
+            }
+
+            // fan triangulation
+            for (size_t i = 2; i < polygon.size(); ++i)
+            {
+                chunk.corners_.push_back(polygon[0]);
+                chunk.corners_.push_back(polygon[i - 1]);
+                chunk.corners_.push_back(polygon[i]);
+            }
+        }
+
+        line = next_line;
+    }
+}
+
+} // namespace
+
+ImportedMesh ImportObj(const std::string& path, const ImportOptions& options)
+{
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    MappedFile file(path);
+    const char* data = reinterpret_cast<const char*>(file.GetData());
+    const char* data_end = data + file.GetSize();
+
+    uint32_t worker_count = GetWorkerCount(options.thread_count_);
+
+    // split on line boundaries
+    size_t chunk_count = std::clamp<size_t>(file.GetSize() / s_min_chunk_size, 1, worker_count * s_chunks_per_worker);
+    size_t chunk_size = file.GetSize() / chunk_count + 1;
+
+    std::vector<ObjChunk> chunks;
+    for (const char* begin = data; begin < data_end; )
+    {
+        const char* end = begin + std::min(chunk_size, static_cast<size_t>(data_end - begin));
+        if (end < data_end)
+        {
+            end = NextLine(end, data_end);
+        }
+
+        ObjChunk chunk{};
+        chunk.begin_ = begin;
+        chunk.end_ = end;
+        chunks.push_back(std::move(chunk));
+
+        begin = end;
+    }
+
+    // pass 1: attributes
+    ParallelFor(chunks.size(), worker_count, [&](size_t i) { ParseAttributes(chunks[i]); });
+
+    ObjAttributes attributes;
+    size_t position_total = 0;
+    size_t uv_total = 0;
+    size_t normal_total = 0;
+    for (ObjChunk& chunk : chunks)
+    {
+        chunk.position_base_ = position_total;
+        chunk.uv_base_ = uv_total;
+        chunk.normal_base_ = normal_total;
+
+        position_total += chunk.positions_.size();
+        uv_total += chunk.uvs_.size();
+        normal_total += chunk.normals_.size();
+        attributes.has_colors_ |= !chunk.colors_.empty();
+    }
+
+    attributes.positions_.resize(position_total);
+    attributes.uvs_.resize(uv_total);
+    attributes.normals_.resize(normal_total);
+    if (attributes.has_colors_)
+    {
+        attributes.colors_.resize(position_total, glm::vec3(1.0f));
+    }
+
+    ParallelFor(chunks.size(), worker_count, [&](size_t i)
+    {
+        ObjChunk& chunk = chunks[i];
+        std::copy(chunk.positions_.begin(), chunk.positions_.end(), attributes.positions_.begin() + chunk.position_base_);
+        std::copy(chunk.colors_.begin(), chunk.colors_.end(), attributes.colors_.begin() + chunk.position_base_);
+        std::copy(chunk.uvs_.begin(), chunk.uvs_.end(), attributes.uvs_.begin() + chunk.uv_base_);
+        std::copy(chunk.normals_.begin(), chunk.normals_.end(), attributes.normals_.begin() + chunk.normal_base_);
+
+        chunk.positions_ = {};
+        chunk.colors_ = {};
+        chunk.uvs_ = {};
+        chunk.normals_ = {};
+    });
+
+    // pass 2: faces
+    ParallelFor(chunks.size(), worker_count, [&](size_t i) { ParseFaces(chunks[i]); });
+
+    std::vector<size_t> corner_offsets(chunks.size() + 1, 0);
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        corner_offsets[i + 1] = corner_offsets[i] + chunks[i].corners_.size();
+    }
+
+    std::vector<ObjCorner> corners(corner_offsets.back());
+    ParallelFor(chunks.size(), worker_count, [&](size_t i)
+    {
+        std::copy(chunks[i].corners_.begin(), chunks[i].corners_.end(), corners.begin() + corner_offsets[i]);
+        chunks[i].corners_ = {};
+    });
+
+    ImportedMesh mesh{};
+
+    // material groups in file order, materials numbered by first use
+    std::unordered_map<std::string, uint32_t> material_indices;
+    uint32_t current_material = 0;
+    size_t group_start = 0;
+    auto close_group = [&](size_t group_end)
+    {
+        if (group_end > group_start)
+        {
+            mesh.submeshes_.push_back(MeshFileSubmesh{
+                static_cast<uint32_t>(group_start), static_cast<uint32_t>(group_end - group_start), current_material, 0, {}, {}});
+        }
+        group_start = group_end;
+    };
+
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        for (const auto& [name, corner] : chunks[i].material_starts_)
+        {
+            close_group(corner_offsets[i] + corner);
+            auto [it, inserted] = material_indices.emplace(name, static_cast<uint32_t>(material_indices.size()));
+            current_material = it->second;
+        }
+    }
+    close_group(corners.size());
+
+    // dedup on the 12 byte index triples, then expand the unique ones to vertices
+    std::vector<uint32_t> remap;
+    size_t unique_count = GenerateVertexRemap(remap, {}, corners.data(), corners.size(), sizeof(ObjCorner));
+
+    std::vector<ObjCorner> unique_corners(unique_count);
+    RemapVertexBuffer(unique_corners.data(), corners.data(), corners.size(), sizeof(ObjCorner), remap);
+    corners = {};
+    mesh.indices_ = std::move(remap);
+
+    mesh.vertices_.resize(unique_count);
+    ParallelFor((unique_count + s_vertex_batch - 1) / s_vertex_batch, worker_count, [&](size_t batch)
+    {
+        size_t first = batch * s_vertex_batch;
+        size_t last = std::min(first + s_vertex_batch, unique_count);
+        for (size_t i = first; i < last; ++i)
+        {
+            const ObjCorner& corner = unique_corners[i];
+            MeshVertex& vertex = mesh.vertices_[i];
+
+            vertex.pos_ = attributes.positions_[corner.position_];
+            if (attributes.has_colors_)
+            {
+                vertex.col_ = glm::vec4(attributes.colors_[corner.position_], 1.0f);
+            }
+            if (corner.uv_ != 0)
+            {
+                // OBJ has the texture origin at the bottom left
+                const glm::vec2& uv = attributes.uvs_[corner.uv_ - 1];
+                vertex.uv_ = glm::vec2(uv.x, 1.0f - uv.y);
+            }
+            if (corner.normal_ != 0)
+            {
+                vertex.normal_ = attributes.normals_[corner.normal_ - 1];
+            }
+        }
+    });
+
+    if (normal_total == 0 && options.generate_normals_)
+    {
+        GenerateNormals(mesh.vertices_, mesh.indices_);
+    }
+
+    mesh.stats_.source_bytes_ = file.GetSize();
+    mesh.stats_.triangle_count_ = mesh.indices_.size() / 3;
+    mesh.stats_.thread_count_ = std::min<uint32_t>(worker_count, static_cast<uint32_t>(chunks.size()));
+    mesh.stats_.seconds_ = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+
+    return mesh;
+}
+
+} // namespace renderer::mesh
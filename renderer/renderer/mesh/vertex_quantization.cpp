@@ -0,0 +1,220 @@
+#include <renderer/renderer/mesh/vertex_quantization.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+// renderer includes
+#include <renderer/renderer/mesh/mesh_optimizer.hpp>
+
+namespace renderer::mesh {
+
+namespace {
+
+uint16_t QuantizeUnorm16(float value)
+{
+    return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+int16_t QuantizeSnorm16(float value)
+{
+    return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+uint8_t QuantizeUnorm8(float value)
+{
+    return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+float SignNotZero(float value)
+{
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+} // namespace
+
+uint16_t FloatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    // infinity and NaN
+    if ((bits & 0x7fffffff) >= 0x7f800000)
+    {
+        return static_cast<uint16_t>(sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0));
+    }
+
+    // overflow to infinity
+    if (exponent >= 31)
+    {
+        return static_cast<uint16_t>(sign | 0x7c00);
+    }
+
+    // subnormal half or zero
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+        {
+            return static_cast<uint16_t>(sign);
+        }
+
+        mantissa |= 0x800000;
+        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+
+        if (remainder > halfway || (remainder == halfway && (half & 1)))
+        {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    // round to nearest even, a carry correctly bumps the exponent
+    uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1fff;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+    {
+        ++half;
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+Snorm16x2 EncodeOctahedral(glm::vec3 direction)
+{
+    // project onto the octahedron, then fold the lower hemisphere over the diagonals
+    float l1 = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+    if (l1 == 0.0f)
+    {
+        return Snorm16x2{0, 32767};
+    }
+
+    float x = direction.x / l1;
+    float y = direction.y / l1;
+    if (direction.z < 0.0f)
+    {
+        float folded_x = (1.0f - std::abs(y)) * SignNotZero(x);
+        float folded_y = (1.0f - std::abs(x)) * SignNotZero(y);
+        x = folded_x;
+        y = folded_y;
+    }
+
+    return Snorm16x2{QuantizeSnorm16(x), QuantizeSnorm16(y)};
+}
+
+glm::vec3 DecodeOctahedral(Snorm16x2 encoded)
+{
+    float x = std::max(encoded.x_ / 32767.0f, -1.0f);
+    float y = std::max(encoded.y_ / 32767.0f, -1.0f);
+
+    glm::vec3 direction(x, y, 1.0f - std::abs(x) - std::abs(y));
+    float t = std::max(-direction.z, 0.0f);
+    direction.x += direction.x >= 0.0f ? -t : t;
+    direction.y += direction.y >= 0.0f ? -t : t;
+
+    return glm::normalize(direction);
+}
+
+QuantizedMesh QuantizeMesh(const std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    QuantizedMesh mesh{};
+    if (vertices.empty())
+    {
+        return mesh;
+    }
+
+    glm::vec3 bounds_min = vertices[0].pos_;
+    glm::vec3 bounds_max = vertices[0].pos_;
+    for (const MeshVertex& vertex : vertices)
+    {
+        bounds_min = glm::min(bounds_min, vertex.pos_);
+        bounds_max = glm::max(bounds_max, vertex.pos_);
+    }
+
+    // flat axes keep a unit scale, every position on them quantizes to 0
+    glm::vec3 extent = bounds_max - bounds_min;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        extent[axis] = extent[axis] > 0.0f ? extent[axis] : 1.0f;
+    }
+
+    mesh.dequantization_.position_offset_ = glm::vec4(bounds_min, 0.0f);
+    mesh.dequantization_.position_scale_ = glm::vec4(extent, 1.0f);
+
+    QuantizationReport& report = mesh.report_;
+    mesh.vertices_.resize(vertices.size());
+
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const MeshVertex& source = vertices[i];
+        QuantizedVertex& target = mesh.vertices_[i];
+
+        glm::vec3 normalized = (source.pos_ - bounds_min) / extent;
+        target.pos_ = Unorm16x4{
+            QuantizeUnorm16(normalized.x),
+            QuantizeUnorm16(normalized.y),
+            QuantizeUnorm16(normalized.z),
+            static_cast<uint16_t>(source.tangent_.w < 0.0f ? 0 : 65535)};
+
+        target.normal_ = EncodeOctahedral(source.normal_);
+        target.tangent_ = EncodeOctahedral(glm::vec3(source.tangent_));
+        target.uv_ = Half2{FloatToHalf(source.uv_.x), FloatToHalf(source.uv_.y)};
+        target.col_ = Unorm8x4{
+            QuantizeUnorm8(source.col_.x),
+            QuantizeUnorm8(source.col_.y),
+            QuantizeUnorm8(source.col_.z),
+            QuantizeUnorm8(source.col_.w)};
+
+        // error of the round trip the shader performs
+        glm::vec3 decoded = bounds_min + glm::vec3(target.pos_.x_, target.pos_.y_, target.pos_.z_) / 65535.0f * extent;
+        glm::vec3 position_error = glm::abs(decoded - source.pos_);
+        report.max_position_error_ = std::max({report.max_position_error_, position_error.x, position_error.y, position_error.z});
+
+        if (glm::length(source.normal_) > 0.0f)
+        {
+            float cosine = glm::dot(DecodeOctahedral(target.normal_), glm::normalize(source.normal_));
+            float degrees = glm::degrees(std::acos(std::clamp(cosine, -1.0f, 1.0f)));
+            report.max_normal_error_degrees_ = std::max(report.max_normal_error_degrees_, degrees);
+        }
+    }
+
+    size_t fetched_vertices = vertices.size();
+    if (!indices.empty())
+    {
+        fetched_vertices = AnalyzeVertexCache(indices, vertices.size()).vertices_transformed_;
+    }
+
+    report.vertex_count_ = vertices.size();
+    report.source_stride_ = sizeof(MeshVertex);
+    report.quantized_stride_ = sizeof(QuantizedVertex);
+    report.source_bytes_ = report.source_stride_ * vertices.size();
+    report.quantized_bytes_ = report.quantized_stride_ * vertices.size();
+    report.source_fetch_bytes_ = report.source_stride_ * fetched_vertices;
+    report.quantized_fetch_bytes_ = report.quantized_stride_ * fetched_vertices;
+
+    return mesh;
+}
+
+void PrintReport(const char* name, const QuantizationReport& report)
+{
+    float saved = report.source_bytes_ > 0 ? 100.0f * (1.0f - static_cast<float>(report.quantized_bytes_) / report.source_bytes_) : 0.0f;
+
+    std::cout << "Mesh " << name << " quantized: " << report.vertex_count_ << " vertices, "
+              << report.source_stride_ << " -> " << report.quantized_stride_ << " bytes per vertex, "
+              << report.source_bytes_ << " -> " << report.quantized_bytes_ << " bytes ("
+              << std::fixed << std::setprecision(1) << saved << "% saved), "
+              << "vertex fetch per draw " << report.source_fetch_bytes_ << " -> " << report.quantized_fetch_bytes_ << " bytes, "
+              << std::setprecision(6) << "max position error " << report.max_position_error_ << ", "
+              << std::setprecision(3) << "max normal error " << report.max_normal_error_degrees_ << " deg"
+              << std::defaultfloat << std::endl;
+}
+
+} // namespace renderer::mesh
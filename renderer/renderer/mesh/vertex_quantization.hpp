@@ -0,0 +1,92 @@
+#pragma once
+
+// std
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// glm
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// renderer includes
+#include <renderer/renderer/vertex_layout.hpp>
+#include <renderer/renderer/mesh/mesh_vertex.hpp>
+
+namespace renderer::mesh {
+
+// 24 bytes instead of the 64 of MeshVertex, dequantized by shaders/quantized.vert.
+struct QuantizedVertex
+{
+    // xyz: 16-bit normalized inside the mesh bounds, w: bitangent sign (0 negative, 65535 positive)
+    Unorm16x4 pos_;
+    // octahedral encoded unit vectors
+    Snorm16x2 normal_;
+    Snorm16x2 tangent_;
+    Half2 uv_;
+    Unorm8x4 col_;
+};
+
+// Vertex shader push constants turning normalized positions back into object space:
+// position = position_offset_ + pos_ * position_scale_
+struct DequantizationConstants
+{
+    glm::vec4 position_offset_{0.0f};
+    glm::vec4 position_scale_{1.0f};
+};
+
+struct QuantizationReport
+{
+    size_t vertex_count_ = 0;
+    size_t source_stride_ = 0;
+    size_t quantized_stride_ = 0;
+
+    // vertex buffer sizes
+    size_t source_bytes_ = 0;
+    size_t quantized_bytes_ = 0;
+
+    // bytes pulled by the vertex fetch per draw, after the post-transform cache
+    size_t source_fetch_bytes_ = 0;
+    size_t quantized_fetch_bytes_ = 0;
+
+    float max_position_error_ = 0.0f;
+    float max_normal_error_degrees_ = 0.0f;
+};
+
+struct QuantizedMesh
+{
+    std::vector<QuantizedVertex> vertices_;
+    DequantizationConstants dequantization_;
+    QuantizationReport report_;
+};
+
+uint16_t FloatToHalf(float value);
+
+Snorm16x2 EncodeOctahedral(glm::vec3 direction);
+// mirrors the shader side decode
+glm::vec3 DecodeOctahedral(Snorm16x2 encoded);
+
+// indices are only used to estimate the vertex fetch, they are not modified
+QuantizedMesh QuantizeMesh(const std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices = {});
+
+void PrintReport(const char* name, const QuantizationReport& report);
+
+} // namespace renderer::mesh
+
+namespace renderer {
+
+template<>
+struct VertexAttributes<mesh::QuantizedVertex>
+{
+    static constexpr std::array s_attributes_ = {
+        RENDERER_VERTEX_ATTRIBUTE(mesh::QuantizedVertex, pos_),
+        RENDERER_VERTEX_ATTRIBUTE(mesh::QuantizedVertex, normal_),
+        RENDERER_VERTEX_ATTRIBUTE(mesh::QuantizedVertex, tangent_),
+        RENDERER_VERTEX_ATTRIBUTE(mesh::QuantizedVertex, uv_),
+        RENDERER_VERTEX_ATTRIBUTE(mesh::QuantizedVertex, col_),
+    };
+};
+
+using QuantizedVertexLayout = VertexInputLayout<VertexBinding<mesh::QuantizedVertex>>;
+
+} // namespace renderer
@@ -0,0 +1,120 @@
+#include <renderer/renderer/meshlet_culler.hpp>
+
+// std
+#include <cmath>
+
+namespace renderer {
+
+MeshletCuller::MeshletCuller(std::span<const mesh::Meshlet> meshlets, uint32_t first_index)
+{
+    size_t count = meshlets.size();
+    center_x_.resize(count);
+    center_y_.resize(count);
+    center_z_.resize(count);
+    radius_.resize(count);
+    axis_x_.resize(count);
+    axis_y_.resize(count);
+    axis_z_.resize(count);
+    cutoff_.resize(count);
+    first_index_.resize(count);
+    index_count_.resize(count);
+    result_.resize(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const mesh::Meshlet& meshlet = meshlets[i];
+        center_x_[i] = meshlet.center_[0];
+        center_y_[i] = meshlet.center_[1];
+        center_z_[i] = meshlet.center_[2];
+        radius_[i] = meshlet.radius_;
+        axis_x_[i] = meshlet.cone_axis_[0];
+        axis_y_[i] = meshlet.cone_axis_[1];
+        axis_z_[i] = meshlet.cone_axis_[2];
+        cutoff_[i] = meshlet.cone_cutoff_;
+        first_index_[i] = first_index + meshlet.first_index_;
+        index_count_[i] = meshlet.index_count_;
+    }
+}
+
+MeshletCullStats MeshletCuller::Cull(const glm::mat4& model_view_projection, const glm::vec3& camera_position, std::vector<IndexRange>& ranges)
+{
+    // object space planes, the bounds are not transformed
+    FrustumPlanes planes = ExtractFrustumPlanes(model_view_projection);
+    float plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+    for (int p = 0; p < 6; ++p)
+    {
+        plane_x[p] = planes[p].x;
+        plane_y[p] = planes[p].y;
+        plane_z[p] = planes[p].z;
+        plane_w[p] = planes[p].w;
+    }
+
+    const size_t count = first_index_.size();
+    const float* center_x = center_x_.data();
+    const float* center_y = center_y_.data();
+    const float* center_z = center_z_.data();
+    const float* radius = radius_.data();
+    const float* axis_x = axis_x_.data();
+    const float* axis_y = axis_y_.data();
+    const float* axis_z = axis_z_.data();
+    const float* cutoff = cutoff_.data();
+    uint8_t* result = result_.data();
+
+    // branch free over independent streams, so the loop vectorizes
+    for (size_t i = 0; i < count; ++i)
+    {
+        float x = center_x[i];
+        float y = center_y[i];
+        float z = center_z[i];
+        float r = radius[i];
+
+        bool outside = false;
+        for (int p = 0; p < 6; ++p)
+        {
+            outside |= plane_x[p] * x + plane_y[p] * y + plane_z[p] * z + plane_w[p] < -r;
+        }
+
+        float view_x = x - camera_position.x;
+        float view_y = y - camera_position.y;
+        float view_z = z - camera_position.z;
+        float distance = std::sqrt(view_x * view_x + view_y * view_y + view_z * view_z);
+        bool back_facing = view_x * axis_x[i] + view_y * axis_y[i] + view_z * axis_z[i] >= cutoff[i] * distance + r;
+
+        result[i] = static_cast<uint8_t>((outside ? s_outside_frustum_ : 0) | (back_facing ? s_back_facing_ : 0));
+    }
+
+    MeshletCullStats stats{};
+    stats.meshlet_count_ = static_cast<uint32_t>(count);
+
+    ranges.clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (result[i] & s_outside_frustum_)
+        {
+            ++stats.frustum_culled_;
+            continue;
+        }
+        if (result[i] & s_back_facing_)
+        {
+            ++stats.backface_culled_;
+            continue;
+        }
+
+        stats.triangles_drawn_ += index_count_[i] / 3;
+
+        // neighbouring meshlets are adjacent in the index buffer, merge them into one draw
+        if (!ranges.empty() && ranges.back().first_index_ + ranges.back().index_count_ == first_index_[i])
+        {
+            ranges.back().index_count_ += index_count_[i];
+        }
+        else
+        {
+            ranges.push_back(IndexRange{first_index_[i], index_count_[i]});
+        }
+    }
+    stats.range_count_ = static_cast<uint32_t>(ranges.size());
+
+    return stats;
+}
+
+} // namespace renderer
@@ -0,0 +1,68 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// glm
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// renderer includes
+#include <renderer/renderer/mesh/meshlet.hpp>
+#include <renderer/renderer/frustum.hpp>
+
+namespace renderer {
+
+struct IndexRange
+{
+    uint32_t first_index_;
+    uint32_t index_count_;
+};
+
+struct MeshletCullStats
+{
+    uint32_t meshlet_count_ = 0;
+    uint32_t frustum_culled_ = 0;
+    uint32_t backface_culled_ = 0;
+    uint32_t triangles_drawn_ = 0;
+    uint32_t range_count_ = 0;
+};
+
+// Per mesh CPU cluster culling. The bounds are kept as a structure of arrays, so the test loop
+// reads every field as a contiguous float stream and compiles to SIMD code without intrinsics.
+// Surviving meshlets are merged into as few index ranges as possible.
+class MeshletCuller
+{
+public:
+    // first_index is added to every meshlet's range, the mesh's offset in a shared index buffer
+    MeshletCuller(std::span<const mesh::Meshlet> meshlets, uint32_t first_index = 0);
+
+    // model_view_projection maps object space to clip space, camera_position is in object space.
+    // The cone test assumes the model matrix scales uniformly.
+    MeshletCullStats Cull(const glm::mat4& model_view_projection, const glm::vec3& camera_position, std::vector<IndexRange>& ranges);
+
+    size_t GetMeshletCount() const { return first_index_.size(); }
+
+private:
+    std::vector<float> center_x_;
+    std::vector<float> center_y_;
+    std::vector<float> center_z_;
+    std::vector<float> radius_;
+    std::vector<float> axis_x_;
+    std::vector<float> axis_y_;
+    std::vector<float> axis_z_;
+    std::vector<float> cutoff_;
+
+    std::vector<uint32_t> first_index_;
+    std::vector<uint32_t> index_count_;
+
+    // per meshlet result of the last Cull: s_outside_frustum_ | s_back_facing_
+    std::vector<uint8_t> result_;
+
+    static constexpr uint8_t s_outside_frustum_ = 1;
+    static constexpr uint8_t s_back_facing_ = 2;
+};
+
+} // namespace renderer
@@ -0,0 +1,238 @@
+#include <renderer/renderer/occlusion_culler.hpp>
+
+// std
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace renderer {
+
+OcclusionCuller::OcclusionCuller(Device& device, IndirectDrawList& draws, DepthPyramid& pyramid, uint32_t frame_count)
+    : device_{device}
+    , draws_{draws}
+    , pyramid_{pyramid}
+    , frame_count_{frame_count}
+    , compact_{draws.GetMode() == IndirectDrawMode::IndirectCount}
+    , command_capacity_{std::max<uint32_t>(draws.GetMaxDraws(), 1)}
+    , readback_written_(frame_count, false)
+    , descriptor_sets_(frame_count, VK_NULL_HANDLE)
+    , pyramid_versions_(frame_count, 0)
+{
+    if (!GpuDrawCuller::IsSupported(draws_))
+    {
+        throw std::runtime_error("GPU occlusion culling needs drawIndirectFirstInstance!");
+    }
+
+    VkDeviceSize alignment = device_.GetProperties().limits.minStorageBufferOffsetAlignment;
+    TypedBufferLayout layout;
+    counts_region_ = layout.Add<uint32_t>(2);
+    views_region_ = layout.Add<OcclusionView>(2, s_views_alignment_);
+    commands_region_ = layout.Add<VkDrawIndexedIndirectCommand>(2 * command_capacity_);
+    drawn_region_ = layout.Add<uint32_t>(command_capacity_, alignment);
+    region_size_ = layout.GetSize(alignment);
+
+    visible_buffer_ = std::make_unique<Buffer>(device_,
+                                               region_size_,
+                                               frame_count_,
+                                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+                                                   | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    readback_buffer_ = std::make_unique<TypedBuffer<uint32_t>>(device_,
+                                                               2 * frame_count_,
+                                                               VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (readback_buffer_->Map() != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to map occlusion culling readback buffer!");
+    }
+
+    // draw data, input commands and bounds at the draw list's dynamic offsets, then this
+    // frame's output, drawn flags and the pyramid
+    descriptor_set_layout_ = DescriptorSetLayout::Builder(device_)
+                                 .AddBindings(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, VK_SHADER_STAGE_COMPUTE_BIT)
+                                 .AddBindings(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, VK_SHADER_STAGE_COMPUTE_BIT)
+                                 .AddBindings(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, VK_SHADER_STAGE_COMPUTE_BIT)
+                                 .AddBindings(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                                 .AddBindings(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                                 .AddBindings(5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+                                 .Build();
+
+    descriptor_pool_ = DescriptorPool::Builder(device_)
+                           .SetMaxSets(frame_count_)
+                           .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 3 * frame_count_)
+                           .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * frame_count_)
+                           .AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, frame_count_)
+                           .Build();
+
+    ComputePipelineConfig pipeline_config{};
+    pipeline_config.compute_shader_ = "shaders/occlusion_cull_comp.spv";
+    pipeline_config.push_constant_size_ = sizeof(OcclusionCullConstants);
+    pipeline_ = std::make_unique<ComputePipeline>(device_, descriptor_set_layout_->GetDescriptorSetLayout(), pipeline_config);
+}
+
+void OcclusionCuller::CullEarly(VkCommandBuffer command_buffer, uint32_t frame_index, const glm::mat4& view_projection)
+{
+    frame_index_ = frame_index;
+
+    // the slot's fence was waited for, its last copy has landed and its set is no longer in use
+    if (readback_written_[frame_index_])
+    {
+        const uint32_t* counts = readback_buffer_->GetMappedData() + 2 * frame_index_;
+        std::copy(counts, counts + 2, visible_counts_);
+    }
+
+    if (descriptor_sets_[frame_index_] == VK_NULL_HANDLE || pyramid_versions_[frame_index_] != pyramid_.GetVersion())
+    {
+        VkDeviceSize region_offset = frame_index_ * region_size_;
+        VkDescriptorBufferInfo draw_data_info = draws_.DrawDataDescriptorInfo();
+        VkDescriptorBufferInfo commands_info = draws_.CommandsDescriptorInfo();
+        VkDescriptorBufferInfo bounds_info = draws_.BoundsDescriptorInfo();
+        // counts, views and commands, up to the end of the commands
+        VkDescriptorBufferInfo visible_info = visible_buffer_->DescriptorInfo(commands_region_.GetOffset(commands_region_.count_), region_offset);
+        VkDescriptorBufferInfo drawn_info = drawn_region_.InRegion(visible_buffer_->GetBuffer(), region_offset).DescriptorInfo();
+        VkDescriptorImageInfo pyramid_info = pyramid_.DescriptorInfo();
+
+        DescriptorWriter writer(*descriptor_set_layout_, *descriptor_pool_);
+        writer.WriteBuffer(0, &draw_data_info)
+              .WriteBuffer(1, &commands_info)
+              .WriteBuffer(2, &bounds_info)
+              .WriteBuffer(3, &visible_info)
+              .WriteBuffer(4, &drawn_info)
+              .WriteImage(5, &pyramid_info);
+        if (descriptor_sets_[frame_index_] == VK_NULL_HANDLE)
+        {
+            if (!writer.Build(descriptor_sets_[frame_index_]))
+            {
+                throw std::runtime_error("Failed to allocate an occlusion culling descriptor set!");
+            }
+        }
+        else
+        {
+            writer.Overwrite(descriptor_sets_[frame_index_]);
+        }
+        pyramid_versions_[frame_index_] = pyramid_.GetVersion();
+    }
+
+    VkBuffer visible_buffer = visible_buffer_->GetBuffer();
+    VkDeviceSize region_offset = frame_index_ * region_size_;
+
+    // the early phase reprojects with the camera the pyramid was built with
+    glm::vec2 pyramid_size(static_cast<float>(pyramid_.GetExtent().width), static_cast<float>(pyramid_.GetExtent().height));
+    std::array<OcclusionView, 2> views{};
+    views[0] = OcclusionView{previous_view_projection_, pyramid_size, pyramid_.GetLevelCount(), 0};
+    views[1] = OcclusionView{view_projection, pyramid_size, pyramid_.GetLevelCount(), 0};
+
+    TypedBufferView<uint32_t> counts = counts_region_.InRegion(visible_buffer, region_offset);
+    TypedBufferView<OcclusionView> views_range = views_region_.InRegion(visible_buffer, region_offset);
+    vkCmdFillBuffer(command_buffer, visible_buffer, counts.offset_, counts.GetSize(), 0);
+    vkCmdUpdateBuffer(command_buffer, visible_buffer, views_range.offset_, views_range.GetSize(), views.data());
+
+    VkMemoryBarrier clear_barrier{};
+    clear_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clear_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clear_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         1, &clear_barrier,
+                         0, nullptr,
+                         0, nullptr);
+
+    constants_ = OcclusionCullConstants{};
+    constants_.planes_ = ExtractFrustumPlanes(view_projection);
+    constants_.draw_count_ = draws_.GetDrawCount();
+    constants_.compact_ = compact_ ? 1 : 0;
+    constants_.occlusion_ = pyramid_.HasDepth() ? 1 : 0;
+    constants_.command_capacity_ = command_capacity_;
+    Dispatch(command_buffer, CullPhase::Early);
+
+    previous_view_projection_ = view_projection;
+
+    // the early commands feed the first render pass, the drawn flags the late phase
+    VkMemoryBarrier cull_barrier{};
+    cull_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    cull_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    cull_barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         1, &cull_barrier,
+                         0, nullptr,
+                         0, nullptr);
+}
+
+void OcclusionCuller::CullLate(VkCommandBuffer command_buffer)
+{
+    // DepthPyramid::Build made the new pyramid visible to compute shaders
+    constants_.occlusion_ = 1;
+    Dispatch(command_buffer, CullPhase::Late);
+
+    // the late commands and both counts feed the second render pass and the statistics copy
+    VkMemoryBarrier cull_barrier{};
+    cull_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    cull_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    cull_barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         1, &cull_barrier,
+                         0, nullptr,
+                         0, nullptr);
+
+    TypedBufferView<uint32_t> counts = counts_region_.InRegion(visible_buffer_->GetBuffer(), frame_index_ * region_size_);
+
+    VkBufferCopy copy{};
+    copy.srcOffset = counts.offset_;
+    copy.dstOffset = readback_buffer_->View(2 * frame_index_, 2).offset_;
+    copy.size = counts.GetSize();
+    vkCmdCopyBuffer(command_buffer, visible_buffer_->GetBuffer(), readback_buffer_->GetBuffer(), 1, &copy);
+
+    VkMemoryBarrier readback_barrier{};
+    readback_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    readback_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    readback_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_HOST_BIT,
+                         0,
+                         1, &readback_barrier,
+                         0, nullptr,
+                         0, nullptr);
+
+    readback_written_[frame_index_] = true;
+}
+
+void OcclusionCuller::Dispatch(VkCommandBuffer command_buffer, CullPhase phase)
+{
+    constants_.phase_ = static_cast<uint32_t>(phase);
+
+    uint32_t input_offset = draws_.GetRegionOffset();
+    uint32_t dynamic_offsets[] = {input_offset, input_offset, input_offset};
+
+    pipeline_->Bind(command_buffer);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_->GetLayout(), 0, 1, &descriptor_sets_[frame_index_], 3, dynamic_offsets);
+    vkCmdPushConstants(command_buffer, pipeline_->GetLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants_), &constants_);
+    ComputePipeline::Dispatch(command_buffer, constants_.draw_count_, s_group_size_);
+}
+
+void OcclusionCuller::Record(VkCommandBuffer command_buffer, CullPhase phase)
+{
+    uint32_t phase_index = static_cast<uint32_t>(phase);
+    VkBuffer visible_buffer = visible_buffer_->GetBuffer();
+    VkDeviceSize region_offset = frame_index_ * region_size_;
+    RecordCulledDraws(command_buffer,
+                      draws_.GetMode(),
+                      commands_region_.InRegion(visible_buffer, region_offset).Subview(phase_index * command_capacity_, command_capacity_),
+                      counts_region_.InRegion(visible_buffer, region_offset).Subview(phase_index, 1),
+                      draws_.GetDrawCount());
+}
+
+} // namespace renderer
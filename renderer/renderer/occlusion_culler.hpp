@@ -0,0 +1,143 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// vulkan
+#include <vulkan/vulkan.h>
+
+// glm
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// renderer includes
+#include <renderer/renderer/device.hpp>
+#include <renderer/renderer/buffer.hpp>
+#include <renderer/renderer/typed_buffer.hpp>
+#include <renderer/renderer/descriptors.hpp>
+#include <renderer/renderer/pipeline.hpp>
+#include <renderer/renderer/frustum.hpp>
+#include <renderer/renderer/indirect_draw_list.hpp>
+#include <renderer/renderer/gpu_draw_culler.hpp>
+#include <renderer/renderer/depth_pyramid.hpp>
+
+namespace renderer {
+
+enum class CullPhase : uint32_t
+{
+    Early = 0,  // against the previous frame's depth pyramid
+    Late = 1,   // the early rejects, against the pyramid of the early draws
+};
+
+// camera and pyramid of one phase, std430 layout of shaders/occlusion_cull.comp
+struct OcclusionView
+{
+    glm::mat4 view_projection_;
+    // level 0 size in texels
+    glm::vec2 pyramid_size_;
+    uint32_t pyramid_levels_;
+    uint32_t pad_;
+};
+static_assert(sizeof(OcclusionView) == 80, "OcclusionView must match shaders/occlusion_cull.comp");
+
+// push constants of shaders/occlusion_cull.comp
+struct OcclusionCullConstants
+{
+    FrustumPlanes planes_;
+    uint32_t draw_count_;
+    uint32_t compact_;
+    uint32_t phase_;
+    // 0 while the pyramid holds no depth, only the frustum is tested
+    uint32_t occlusion_;
+    // the late commands start this many commands after the early ones
+    uint32_t command_capacity_;
+};
+static_assert(sizeof(OcclusionCullConstants) == 116, "OcclusionCullConstants must match the push constant block of shaders/occlusion_cull.comp");
+
+// Two phase occlusion culling of an IndirectDrawList on the GPU (shaders/occlusion_cull.comp).
+// The early phase frustum culls every draw and tests the survivors against the depth pyramid of
+// the previous frame, reprojected with the previous frame's camera, and the survivors are drawn.
+// The pyramid is then rebuilt from that depth and the late phase retests the draws the early
+// phase rejected against it, so draws that came into view are drawn in the same frame, in a
+// second render pass. Draws hidden behind what the early pass drew are never drawn. A frame:
+//
+//     draws.Prepare, pyramid.Prepare, CullEarly      outside the render pass
+//     Record(Early)                                  Renderer::BeginRenderPass
+//     pyramid.Build, CullLate                        outside the render pass
+//     Record(Late)                                   Renderer::ResumeRenderPass
+//
+// Every frame in flight owns a region of the output, like GpuDrawCuller:
+//     count[2] | pad | OcclusionView[2] | commands[2 * max_draws] | drawn[max_draws]
+class OcclusionCuller
+{
+public:
+    static constexpr uint32_t s_group_size_ = 64;
+    // the views start 16 bytes in, after the padded counts of shaders/occlusion_cull.comp
+    static constexpr VkDeviceSize s_views_alignment_ = 16;
+
+public:
+    OcclusionCuller(Device& device, IndirectDrawList& draws, DepthPyramid& pyramid, uint32_t frame_count);
+    ~OcclusionCuller() = default;
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    static bool IsSupported(const IndirectDrawList& draws, const DepthAttachment& depth)
+    {
+        return GpuDrawCuller::IsSupported(draws) && DepthPyramid::IsSupported(depth);
+    }
+
+    // outside a render pass, after draws.Prepare(frame_index) and pyramid.Prepare
+    void CullEarly(VkCommandBuffer command_buffer, uint32_t frame_index, const glm::mat4& view_projection);
+    // outside a render pass, after the early draws' render pass and pyramid.Build
+    void CullLate(VkCommandBuffer command_buffer);
+    // the culled replacement of IndirectDrawList::Record for one phase, with the same bindings
+    void Record(VkCommandBuffer command_buffer, CullPhase phase);
+
+    // visible draws of the last completed frame in this slot, copied back with frames in
+    // flight latency like GpuDrawCuller::GetVisibleCount
+    uint32_t GetVisibleCount() const { return visible_counts_[0] + visible_counts_[1]; }
+    // of those, the draws only the late phase found
+    uint32_t GetLateVisibleCount() const { return visible_counts_[1]; }
+    bool IsCompacting() const { return compact_; }
+
+private:
+    void Dispatch(VkCommandBuffer command_buffer, CullPhase phase);
+
+private:
+    Device& device_;
+    IndirectDrawList& draws_;
+    DepthPyramid& pyramid_;
+    uint32_t frame_count_;
+    bool compact_;
+    uint32_t command_capacity_;
+
+    // layout of one region, the commands of both phases back to back
+    TypedBufferView<uint32_t> counts_region_;
+    TypedBufferView<OcclusionView> views_region_;
+    TypedBufferView<VkDrawIndexedIndirectCommand> commands_region_;
+    TypedBufferView<uint32_t> drawn_region_;
+    VkDeviceSize region_size_;
+    uint32_t frame_index_ = 0;
+    OcclusionCullConstants constants_{};
+    // camera of the frame the pyramid was built in
+    glm::mat4 previous_view_projection_{1.0f};
+    uint32_t visible_counts_[2] = {};
+
+    // device local counts, views, commands and drawn flags
+    std::unique_ptr<Buffer> visible_buffer_;
+    // per frame copies of the counts, host visible
+    std::unique_ptr<TypedBuffer<uint32_t>> readback_buffer_;
+    std::vector<bool> readback_written_;
+
+    std::unique_ptr<DescriptorSetLayout> descriptor_set_layout_;
+    std::unique_ptr<DescriptorPool> descriptor_pool_;
+    // per frame: the output region and the pyramid, rewritten when the pyramid was recreated
+    std::vector<VkDescriptorSet> descriptor_sets_;
+    std::vector<uint64_t> pyramid_versions_;
+    std::unique_ptr<ComputePipeline> pipeline_;
+};
+
+} // namespace renderer
@@ -0,0 +1,82 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace renderer {
+
+inline uint32_t GetWorkerCount(uint32_t requested = 0)
+{
+    if (requested != 0)
+    {
+        return requested;
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Calls function(task_index) for every task in [0, task_count) on up to worker_count threads
+// (the calling thread is one of them). The first exception thrown by a task is rethrown here.
+template<typename Function>
+void ParallelFor(size_t task_count, uint32_t worker_count, Function&& function)
+{
+    worker_count = static_cast<uint32_t>(std::min<size_t>(GetWorkerCount(worker_count), task_count));
+    if (worker_count <= 1)
+    {
+        for (size_t task = 0; task < task_count; ++task)
+        {
+            function(task);
+        }
+        return;
+    }
+
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    // tasks are handed out one at a time, so uneven tasks (whole assets) still balance
+    std::atomic<size_t> next_task{0};
+    auto worker = [&]()
+    {
+        try
+        {
+            for (size_t task = next_task++; task < task_count; task = next_task++)
+            {
+                function(task);
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(worker_count - 1);
+    for (uint32_t i = 1; i < worker_count; ++i)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace renderer
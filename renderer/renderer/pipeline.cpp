@@ -1,30 +1,78 @@
 #include <renderer/renderer/pipeline.hpp>
 
 // std
+#include <chrono>
 #include <fstream>
 #include <iostream>
 
 namespace renderer {
 
-Pipeline::Pipeline(Device& device, VkRenderPass render_pass, VkDescriptorSetLayout descriptor_set_layout)
+namespace {
+
+std::vector<char> ReadShaderFile(const std::string& filename)
+{
+    std::ifstream file(filename);
+
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open shader file: " + filename);
+    }
+
+    file.seekg(0, std::ios::end);
+    size_t file_size = file.tellg();
+    std::vector<char> code(file_size);
+
+    file.seekg(0);
+    file.read(code.data(), file_size);
+    std::cout << filename << ".size()=" << code.size() << std::endl;
+
+    return code;
+}
+
+VkShaderModule CreateShaderModule(VkDevice device, std::vector<char>& code)
+{
+    VkShaderModuleCreateInfo create_info{};
+    create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    create_info.codeSize = code.size();
+    create_info.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+    VkShaderModule shader_module;
+
+    if (vkCreateShaderModule(device, &create_info, nullptr, &shader_module) != VK_SUCCESS) 
+    {
+        throw std::runtime_error("Failed to create shader module");
+    }
+
+    return shader_module;
+}
+
+} // namespace
+
+Pipeline::Pipeline(Device& device,
+                   VkRenderPass render_pass,
+                   VkDescriptorSetLayout descriptor_set_layout,
+                   const PipelineConfig& config)
     : device_{device}
 {
-    CreatePipeline(render_pass, descriptor_set_layout);
+    CreatePipeline(render_pass, descriptor_set_layout, config);
 }
 
 Pipeline::~Pipeline()
 {
-    vkDestroyPipeline(device_.GetDevice(), graphics_pipeline_, nullptr);
-    vkDestroyPipelineLayout(device_.GetDevice(), pipeline_layout_, nullptr);
+    device_.Retire([device = device_.GetDevice(), pipeline = graphics_pipeline_, layout = pipeline_layout_]()
+    {
+        vkDestroyPipeline(device, pipeline, nullptr);
+        vkDestroyPipelineLayout(device, layout, nullptr);
+    });
 }
 
-void Pipeline::CreatePipeline(VkRenderPass render_pass, VkDescriptorSetLayout descriptor_set_layout)
+void Pipeline::CreatePipeline(VkRenderPass render_pass, VkDescriptorSetLayout descriptor_set_layout, const PipelineConfig& config)
 {
-    auto vert_shader_code = ReadFile("shaders/vert.spv");
-    auto frag_shader_code = ReadFile("shaders/frag.spv");
+    auto vert_shader_code = ReadShaderFile(config.vertex_shader_);
+    auto frag_shader_code = ReadShaderFile(config.fragment_shader_);
 
-    VkShaderModule vert_shader_module = CreateShaderModule(vert_shader_code);
-    VkShaderModule frag_shader_module = CreateShaderModule(frag_shader_code);
+    VkShaderModule vert_shader_module = CreateShaderModule(device_.GetDevice(), vert_shader_code);
+    VkShaderModule frag_shader_module = CreateShaderModule(device_.GetDevice(), frag_shader_code);
 
     VkPipelineShaderStageCreateInfo vert_shader_stage_info{};
     vert_shader_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -44,14 +92,11 @@ void Pipeline::CreatePipeline(VkRenderPass render_pass, VkDescriptorSetLayout de
     VkPipelineVertexInputStateCreateInfo vertex_input_info{};
     vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
     
-    auto binding_description = Vertex::GetBindingDescription();
-    auto attribute_description = Vertex::GetAttributeDescriptions();
-
     // bindings and descriptions
-    vertex_input_info.vertexBindingDescriptionCount = 1;
-    vertex_input_info.pVertexBindingDescriptions = &binding_description;
-    vertex_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(attribute_description.size());
-    vertex_input_info.pVertexAttributeDescriptions = attribute_description.data();
+    vertex_input_info.vertexBindingDescriptionCount = static_cast<uint32_t>(config.vertex_input_.bindings_.size());
+    vertex_input_info.pVertexBindingDescriptions = config.vertex_input_.bindings_.data();
+    vertex_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(config.vertex_input_.attributes_.size());
+    vertex_input_info.pVertexAttributeDescriptions = config.vertex_input_.attributes_.data();
 
     
 
@@ -82,6 +127,14 @@ void Pipeline::CreatePipeline(VkRenderPass render_pass, VkDescriptorSetLayout de
     multisampling.sampleShadingEnable = VK_FALSE;
     multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
 
+    VkPipelineDepthStencilStateCreateInfo depth_stencil{};
+    depth_stencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depth_stencil.depthTestEnable = config.depth_test_ ? VK_TRUE : VK_FALSE;
+    depth_stencil.depthWriteEnable = config.depth_write_ ? VK_TRUE : VK_FALSE;
+    depth_stencil.depthCompareOp = config.depth_compare_op_;
+    depth_stencil.depthBoundsTestEnable = VK_FALSE;
+    depth_stencil.stencilTestEnable = VK_FALSE;
+
     VkPipelineColorBlendAttachmentState color_blend_attachment{};
     color_blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
     color_blend_attachment.blendEnable = VK_FALSE;
@@ -110,7 +163,14 @@ void Pipeline::CreatePipeline(VkRenderPass render_pass, VkDescriptorSetLayout de
     pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipeline_layout_info.setLayoutCount = 1;
     pipeline_layout_info.pSetLayouts = &descriptor_set_layout;
-    pipeline_layout_info.pushConstantRangeCount = 0;
+
+    VkPushConstantRange push_constant_range{};
+    push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = config.push_constant_size_;
+
+    pipeline_layout_info.pushConstantRangeCount = config.push_constant_size_ > 0 ? 1 : 0;
+    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
 
     if (vkCreatePipelineLayout(device_.GetDevice(), &pipeline_layout_info, nullptr, &pipeline_layout_) != VK_SUCCESS) {
         throw std::runtime_error("failed to create pipeline layout!");
@@ -125,6 +185,7 @@ void Pipeline::CreatePipeline(VkRenderPass render_pass, VkDescriptorSetLayout de
     pipeline_info.pViewportState = &viewport_state;
     pipeline_info.pRasterizationState = &rasterizer;
     pipeline_info.pMultisampleState = &multisampling;
+    pipeline_info.pDepthStencilState = &depth_stencil;
     pipeline_info.pColorBlendState = &color_blending;
     pipeline_info.pDynamicState = &dynamic_state;
     pipeline_info.layout = pipeline_layout_;
@@ -132,49 +193,94 @@ void Pipeline::CreatePipeline(VkRenderPass render_pass, VkDescriptorSetLayout de
     pipeline_info.subpass = 0;
     pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(device_.GetDevice(), VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &graphics_pipeline_) != VK_SUCCESS) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    if (vkCreateGraphicsPipelines(device_.GetDevice(), device_.GetPipelineCache(), 1, &pipeline_info, nullptr, &graphics_pipeline_) != VK_SUCCESS) {
         throw std::runtime_error("failed to create graphics pipeline!");
     }
 
+    // cold vs. warm comparison of the on-disk pipeline cache
+    float creation_ms = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - start_time).count();
+    std::cout << "Graphics pipeline created in " << creation_ms << " ms ("
+              << (device_.IsPipelineCacheWarm() ? "warm" : "cold") << " pipeline cache)" << std::endl;
+
     vkDestroyShaderModule(device_.GetDevice(), frag_shader_module, nullptr);
     vkDestroyShaderModule(device_.GetDevice(), vert_shader_module, nullptr);
 }
 
-std::vector<char> Pipeline::ReadFile(std::string filename)
+// =================== ComputePipeline =================== //
+ComputePipeline::ComputePipeline(Device& device,
+                                 VkDescriptorSetLayout descriptor_set_layout,
+                                 const ComputePipelineConfig& config)
+    : device_{device}
 {
-    std::ifstream file(filename);
+    auto shader_code = ReadShaderFile(config.compute_shader_);
+    VkShaderModule shader_module = CreateShaderModule(device_.GetDevice(), shader_code);
 
-    if (!file.is_open())
+    VkPipelineLayoutCreateInfo pipeline_layout_info{};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &descriptor_set_layout;
+
+    VkPushConstantRange push_constant_range{};
+    push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = config.push_constant_size_;
+
+    pipeline_layout_info.pushConstantRangeCount = config.push_constant_size_ > 0 ? 1 : 0;
+    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+
+    if (vkCreatePipelineLayout(device_.GetDevice(), &pipeline_layout_info, nullptr, &pipeline_layout_) != VK_SUCCESS)
     {
-        throw std::runtime_error("Failed to open shader file: " + filename);
+        vkDestroyShaderModule(device_.GetDevice(), shader_module, nullptr);
+        throw std::runtime_error("failed to create compute pipeline layout!");
     }
 
-    file.seekg(0, std::ios::end);
-    size_t file_size = file.tellg();
-    std::vector<char> code(file_size);
+    VkComputePipelineCreateInfo pipeline_info{};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeline_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipeline_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipeline_info.stage.module = shader_module;
+    pipeline_info.stage.pName = "main";
+    pipeline_info.layout = pipeline_layout_;
+    pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
 
-    file.seekg(0);
-    file.read(code.data(), file_size);
-    std::cout << filename << ".size()=" << code.size() << std::endl;
+    auto start_time = std::chrono::high_resolution_clock::now();
 
-    return code;
+    VkResult result = vkCreateComputePipelines(device_.GetDevice(), device_.GetPipelineCache(), 1, &pipeline_info, nullptr, &pipeline_);
+    vkDestroyShaderModule(device_.GetDevice(), shader_module, nullptr);
+    if (result != VK_SUCCESS)
+    {
+        vkDestroyPipelineLayout(device_.GetDevice(), pipeline_layout_, nullptr);
+        throw std::runtime_error("failed to create compute pipeline!");
+    }
+
+    float creation_ms = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - start_time).count();
+    std::cout << "Compute pipeline created in " << creation_ms << " ms ("
+              << (device_.IsPipelineCacheWarm() ? "warm" : "cold") << " pipeline cache)" << std::endl;
 }
 
-VkShaderModule Pipeline::CreateShaderModule(std::vector<char>& code)
+ComputePipeline::~ComputePipeline()
 {
-    VkShaderModuleCreateInfo create_info{};
-    create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    create_info.codeSize = code.size();
-    create_info.pCode = reinterpret_cast<const uint32_t*>(code.data());
+    device_.Retire([device = device_.GetDevice(), pipeline = pipeline_, layout = pipeline_layout_]()
+    {
+        vkDestroyPipeline(device, pipeline, nullptr);
+        vkDestroyPipelineLayout(device, layout, nullptr);
+    });
+}
 
-    VkShaderModule shader_module;
+void ComputePipeline::Bind(VkCommandBuffer command_buffer)
+{
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_);
+}
 
-    if (vkCreateShaderModule(device_.GetDevice(), &create_info, nullptr, &shader_module) != VK_SUCCESS) 
+void ComputePipeline::Dispatch(VkCommandBuffer command_buffer, uint32_t invocation_count, uint32_t group_size)
+{
+    uint32_t group_count = (invocation_count + group_size - 1) / group_size;
+    if (group_count > 0)
     {
-        throw std::runtime_error("Failed to create shader module");
+        vkCmdDispatch(command_buffer, group_count, 1, 1);
     }
-
-    return shader_module;
 }
 
 } // namespace renderer
\ No newline at end of file
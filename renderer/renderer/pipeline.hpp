@@ -1,6 +1,7 @@
 #pragma once 
 
 // std
+#include <string>
 #include <vector>
 
 // vulkan
@@ -10,26 +11,43 @@
 #include <renderer/renderer/device.hpp>
 #include <renderer/renderer/swap_chain.hpp>
 #include <renderer/renderer/vertex_buffer.hpp>
+#include <renderer/renderer/vertex_layout.hpp>
 
 
 namespace renderer {
 
+struct PipelineConfig
+{
+    std::string vertex_shader_ = "shaders/vert.spv";
+    std::string fragment_shader_ = "shaders/frag.spv";
+
+    // may have no bindings for pipelines generating their vertices in the shader
+    VertexInputDescription vertex_input_ = DefaultVertexLayout::GetDescription();
+
+    // vertex stage push constants, 0 for none
+    uint32_t push_constant_size_ = 0;
+
+    // against the render pass depth attachment, cleared to 1.0 (Renderer::BeginRenderPass)
+    bool depth_test_ = true;
+    bool depth_write_ = true;
+    VkCompareOp depth_compare_op_ = VK_COMPARE_OP_LESS_OR_EQUAL;
+};
+
 class Pipeline
 {
 public:
-    Pipeline(Device& device, VkRenderPass render_pass, VkDescriptorSetLayout descriptor_set_layout);
+    Pipeline(Device& device,
+             VkRenderPass render_pass,
+             VkDescriptorSetLayout descriptor_set_layout,
+             const PipelineConfig& config = PipelineConfig{});
     ~Pipeline();
 
     VkPipeline GetGraphicsPipeline() { return graphics_pipeline_;}
     VkPipelineLayout GetLayout() { return pipeline_layout_; }
 
 private:
-    void CreatePipeline(VkRenderPass render_pass, VkDescriptorSetLayout descriptor_set_layout);
-
+    void CreatePipeline(VkRenderPass render_pass, VkDescriptorSetLayout descriptor_set_layout, const PipelineConfig& config);
 
-
-    std::vector<char> ReadFile(std::string filename);
-    VkShaderModule CreateShaderModule(std::vector<char>& code);
 private:
     Device& device_;
 
@@ -38,4 +56,39 @@ private:
 
 };
 
+struct ComputePipelineConfig
+{
+    std::string compute_shader_;
+
+    // compute stage push constants, 0 for none
+    uint32_t push_constant_size_ = 0;
+};
+
+// Single compute stage pipeline, bound at VK_PIPELINE_BIND_POINT_COMPUTE. Shares the shader
+// loading and the pipeline cache with Pipeline
+class ComputePipeline
+{
+public:
+    ComputePipeline(Device& device,
+                    VkDescriptorSetLayout descriptor_set_layout,
+                    const ComputePipelineConfig& config);
+    ~ComputePipeline();
+
+    ComputePipeline(const ComputePipeline&) = delete;
+    ComputePipeline& operator=(const ComputePipeline&) = delete;
+
+    VkPipeline GetPipeline() { return pipeline_; }
+    VkPipelineLayout GetLayout() { return pipeline_layout_; }
+
+    void Bind(VkCommandBuffer command_buffer);
+    // enough workgroups of group_size invocations to cover invocation_count
+    static void Dispatch(VkCommandBuffer command_buffer, uint32_t invocation_count, uint32_t group_size);
+
+private:
+    Device& device_;
+
+    VkPipelineLayout pipeline_layout_;
+    VkPipeline pipeline_;
+};
+
 } // namespace renderer
\ No newline at end of file
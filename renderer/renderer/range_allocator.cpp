@@ -0,0 +1,105 @@
+#include <renderer/renderer/range_allocator.hpp>
+
+// std
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace renderer {
+
+RangeAllocator::RangeAllocator(uint64_t capacity)
+    : capacity_{capacity}
+{
+    if (capacity_ > 0)
+    {
+        free_ranges_.emplace(0, capacity_);
+    }
+}
+
+uint64_t RangeAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+    if (size == 0 || alignment == 0)
+    {
+        return s_invalid_offset_;
+    }
+
+    for (auto it = free_ranges_.begin(); it != free_ranges_.end(); ++it)
+    {
+        uint64_t range_offset = it->first;
+        uint64_t range_size = it->second;
+
+        uint64_t offset = (range_offset + alignment - 1) / alignment * alignment;
+        uint64_t padding = offset - range_offset;
+        if (padding >= range_size || range_size - padding < size)
+        {
+            continue;
+        }
+
+        free_ranges_.erase(it);
+        // the alignment padding and the tail stay free
+        if (padding > 0)
+        {
+            free_ranges_.emplace(range_offset, padding);
+        }
+        if (range_size - padding > size)
+        {
+            free_ranges_.emplace(offset + size, range_size - padding - size);
+        }
+
+        used_ += size;
+        return offset;
+    }
+
+    return s_invalid_offset_;
+}
+
+void RangeAllocator::Free(uint64_t offset, uint64_t size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+    if (offset > capacity_ || size > capacity_ - offset || size > used_)
+    {
+        throw std::runtime_error("Freed range was not allocated");
+    }
+
+    auto next = free_ranges_.lower_bound(offset);
+    if ((next != free_ranges_.end() && next->first < offset + size)
+        || (next != free_ranges_.begin() && std::prev(next)->first + std::prev(next)->second > offset))
+    {
+        throw std::runtime_error("Freed range overlaps a free range");
+    }
+
+    used_ -= size;
+
+    // merge with the following and the preceding free range
+    if (next != free_ranges_.end() && next->first == offset + size)
+    {
+        size += next->second;
+        next = free_ranges_.erase(next);
+    }
+    if (next != free_ranges_.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset)
+        {
+            previous->second += size;
+            return;
+        }
+    }
+
+    free_ranges_.emplace_hint(next, offset, size);
+}
+
+uint64_t RangeAllocator::GetLargestFreeRange() const
+{
+    uint64_t largest = 0;
+    for (const auto& [offset, size] : free_ranges_)
+    {
+        largest = std::max(largest, size);
+    }
+    return largest;
+}
+
+} // namespace renderer
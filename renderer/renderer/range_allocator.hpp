@@ -0,0 +1,39 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+namespace renderer {
+
+// First fit free list over [0, capacity). Free ranges are kept sorted by offset, so a freed range
+// merges with its neighbours right away and the list stays as short as the fragmentation allows.
+// Not thread safe, owners serialize access.
+class RangeAllocator
+{
+public:
+    static constexpr uint64_t s_invalid_offset_ = UINT64_MAX;
+
+public:
+    RangeAllocator(uint64_t capacity);
+
+    // alignment does not have to be a power of two (e.g. a vertex stride)
+    // returns s_invalid_offset_ when no free range fits
+    uint64_t Allocate(uint64_t size, uint64_t alignment = 1);
+    void Free(uint64_t offset, uint64_t size);
+
+    uint64_t GetCapacity() const { return capacity_; }
+    uint64_t GetUsed() const { return used_; }
+    uint64_t GetLargestFreeRange() const;
+    size_t GetFreeRangeCount() const { return free_ranges_.size(); }
+
+private:
+    uint64_t capacity_;
+    uint64_t used_ = 0;
+
+    // offset -> size
+    std::map<uint64_t, uint64_t> free_ranges_;
+};
+
+} // namespace renderer
@@ -8,10 +8,19 @@
 namespace renderer
 {
 
-Renderer::Renderer(Device& device, engine::Window& window)
-    : window_{window}
+Renderer::Renderer(Device& device, engine::Window& window, uint32_t frames_in_flight)
+    : window_{&window}
     , device_{device}
-    , swap_chain_{device_, window_.GetExtent()}
+    , swap_chain_{device_, window.GetExtent(), frames_in_flight}
+    , current_image_index_{0}
+    , current_frame_index_{0}
+{
+    CreateCommandBuffers();
+}
+
+Renderer::Renderer(Device& device, VkExtent2D extent, uint32_t frames_in_flight)
+    : device_{device}
+    , swap_chain_{device_, extent, frames_in_flight}
     , current_image_index_{0}
     , current_frame_index_{0}
 {
@@ -36,6 +45,9 @@ VkCommandBuffer Renderer::BeginFrame()
     {
         throw std::runtime_error("Failed to acquire swap chain image");
     }
+
+    // AcquireImage waited for the oldest frame in flight, release what it was still using
+    device_.CollectGarbage();
     VkCommandBuffer current_command_buffer = command_buffers_[current_frame_index_];
 
     // vkResetCommandBuffer(current_command_buffer, 0);
@@ -53,15 +65,26 @@ VkCommandBuffer Renderer::BeginFrame()
 }
 
 void Renderer::BeginRenderPass(VkCommandBuffer command_buffer)
+{
+    StartRenderPass(command_buffer, swap_chain_.GetRenderPass());
+}
+
+void Renderer::ResumeRenderPass(VkCommandBuffer command_buffer)
+{
+    StartRenderPass(command_buffer, swap_chain_.GetResumeRenderPass());
+}
+
+void Renderer::StartRenderPass(VkCommandBuffer command_buffer, VkRenderPass render_pass)
 {
     VkRenderPassBeginInfo render_pass_info{};
     render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    render_pass_info.renderPass = swap_chain_.GetRenderPass();
+    render_pass_info.renderPass = render_pass;
     render_pass_info.framebuffer = swap_chain_.GetFrameBuffer(current_image_index_);
     render_pass_info.renderArea.offset = {0, 0};
     render_pass_info.renderArea.extent = swap_chain_.GetExtent();
 
 
+    // ignored by the resume render pass, which loads both attachments
     std::array<VkClearValue, 2> clear_values{};
     
     clear_values[0].color = {0.0f, 0.0f, 0.0f, 1.0f};
@@ -98,22 +121,25 @@ if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
         throw std::runtime_error("failed to record command buffer!");
     }    
 
+    // one upload submission per frame, queued ahead of the frame that may read the uploaded data
+    device_.GetUploadEngine().Flush();
+
     VkResult result = swap_chain_.SubmitCommandBuffer(command_buffer, &current_image_index_);
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || window_.WasResized()) {
-        window_.ResetResizedFlag();
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || (window_ && window_->WasResized())) {
+        window_->ResetResizedFlag();
         RecreateSwapChain();
     } else if (result != VK_SUCCESS) {
         throw std::runtime_error("failed to present swap chain image!");
     }
 
-    current_frame_index_ = (current_frame_index_ + 1) % SwapChain::MAX_FRAMES_IN_FLIGHT;
+    current_frame_index_ = (current_frame_index_ + 1) % swap_chain_.GetFramesInFlight();
 }
 
 
 void Renderer::CreateCommandBuffers()
 {
-    command_buffers_.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+    command_buffers_.resize(swap_chain_.GetFramesInFlight());
 
     VkCommandBufferAllocateInfo alloc_info{};
     alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -134,7 +160,7 @@ void Renderer::RecreateSwapChain()
     VkExtent2D extent;
     while (extent.width == 0 || extent.height == 0)
     {
-        extent = window_.GetExtent();
+        extent = window_->GetExtent();
         glfwWaitEvents();
     }
 
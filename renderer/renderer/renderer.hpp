@@ -22,25 +22,34 @@ namespace renderer
 class Renderer
 {
 public:
-    Renderer(Device& device, engine::Window& window);
+    Renderer(Device& device, engine::Window& window, uint32_t frames_in_flight = SwapChain::DEFAULT_FRAMES_IN_FLIGHT);
+    // headless renderer, draws into offscreen images of the given extent
+    Renderer(Device& device, VkExtent2D extent, uint32_t frames_in_flight = SwapChain::DEFAULT_FRAMES_IN_FLIGHT);
     ~Renderer();
 
 
     VkCommandBuffer BeginFrame();
     void BeginRenderPass(VkCommandBuffer command_buffer);
+    // a second render pass of the frame, drawing over what the previous one left
+    void ResumeRenderPass(VkCommandBuffer command_buffer);
     void EndRenderPass(VkCommandBuffer command_buffer);
     void EndFrame(VkCommandBuffer command_buffer);
 
     VkRenderPass GetSwapchainRenderPass() { return swap_chain_.GetRenderPass(); }
     VkExtent2D GetSwapChainExtent() { return swap_chain_.GetExtent(); }
     int GetFrameIndex() { return current_frame_index_; }
+    uint32_t GetFramesInFlight() { return swap_chain_.GetFramesInFlight(); }
+    // depth attachment of the frame being recorded
+    DepthAttachment GetDepthAttachment() { return swap_chain_.GetDepthAttachment(current_image_index_); }
 
 private:
     void CreateCommandBuffers();
     void RecreateSwapChain();
+    void StartRenderPass(VkCommandBuffer command_buffer, VkRenderPass render_pass);
 
 private:
-    engine::Window& window_;
+    // nullptr in headless mode
+    engine::Window* window_ = nullptr;
     Device& device_;
     SwapChain swap_chain_;   
 
@@ -0,0 +1,292 @@
+#include <renderer/renderer/resource_registry.hpp>
+
+// std
+#include <algorithm>
+#include <stdexcept>
+
+namespace renderer {
+
+ResourceRegistry::ResourceRegistry(Device& device, VkDeviceSize geometry_vertex_capacity, uint32_t geometry_index_capacity)
+    : device_{device}
+    , geometry_arena_{std::make_unique<GeometryArena>(device, geometry_vertex_capacity, geometry_index_capacity)}
+{
+}
+
+ResourceRegistry::~ResourceRegistry()
+{
+    while (!images_.Empty())
+    {
+        DestroyImage(images_.GetHandle(images_.Size() - 1));
+    }
+
+    // owners retire their Vulkan objects on destruction
+    meshes_.Clear();
+    pipelines_.Clear();
+    buffers_.Clear();
+}
+
+BufferHandle ResourceRegistry::CreateBuffer(VkDeviceSize instance_size,
+                                            uint32_t instance_count,
+                                            VkBufferUsageFlags usage,
+                                            VkMemoryPropertyFlags properties)
+{
+    BufferRecord record{};
+    record.owner_ = std::make_unique<Buffer>(device_, instance_size, instance_count, usage, properties);
+    record.buffer_ = record.owner_->GetBuffer();
+    record.size_ = instance_size * instance_count;
+
+    if (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        record.owner_->Map();
+        record.mapped_ = record.owner_->GetMappedMemory();
+    }
+
+    return buffers_.Insert(std::move(record));
+}
+
+ImageHandle ResourceRegistry::CreateImage(const VkImageCreateInfo& image_info,
+                                          VkImageAspectFlags aspect,
+                                          VkMemoryPropertyFlags properties)
+{
+    ImageRecord record{};
+    record.format_ = image_info.format;
+    record.extent_ = image_info.extent;
+
+    device_.CreateImageWithInfo(image_info, properties, record.image_, record.allocation_);
+
+    VkImageViewCreateInfo view_info{};
+    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view_info.image = record.image_;
+    view_info.viewType = image_info.imageType == VK_IMAGE_TYPE_3D ? VK_IMAGE_VIEW_TYPE_3D : VK_IMAGE_VIEW_TYPE_2D;
+    view_info.format = image_info.format;
+    view_info.subresourceRange.aspectMask = aspect;
+    view_info.subresourceRange.baseMipLevel = 0;
+    view_info.subresourceRange.levelCount = image_info.mipLevels;
+    view_info.subresourceRange.baseArrayLayer = 0;
+    view_info.subresourceRange.layerCount = image_info.arrayLayers;
+
+    if (vkCreateImageView(device_.GetDevice(), &view_info, nullptr, &record.view_) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create image view!");
+    }
+
+    return images_.Insert(std::move(record));
+}
+
+void ResourceRegistry::DestroyImage(ImageHandle handle)
+{
+    ImageRecord* record = images_.Get(handle);
+    if (!record)
+    {
+        return;
+    }
+
+    device_.Retire([&device = device_, image = record->image_, view = record->view_, allocation = record->allocation_]() mutable
+    {
+        vkDestroyImageView(device.GetDevice(), view, nullptr);
+        device.DestroyImage(image, allocation);
+    });
+
+    images_.Remove(handle);
+}
+
+PipelineHandle ResourceRegistry::AddPipeline(std::unique_ptr<Pipeline> pipeline)
+{
+    PipelineRecord record{};
+    record.pipeline_ = pipeline->GetGraphicsPipeline();
+    record.layout_ = pipeline->GetLayout();
+    record.owner_ = std::move(pipeline);
+
+    return pipelines_.Insert(std::move(record));
+}
+
+MeshHandle ResourceRegistry::AddStaticMesh(std::span<const std::byte> vertices,
+                                           uint32_t vertex_stride,
+                                           std::span<const uint32_t> indices,
+                                           std::span<const mesh::MeshFileLod> lods,
+                                           const glm::vec4& bounding_sphere,
+                                           std::span<const mesh::Meshlet> meshlets)
+{
+    return InsertArenaMesh(geometry_arena_->Allocate(vertices, vertex_stride, indices), lods, bounding_sphere, meshlets);
+}
+
+MeshHandle ResourceRegistry::InsertArenaMesh(const GeometryRange& geometry,
+                                             std::span<const mesh::MeshFileLod> lods,
+                                             const glm::vec4& bounding_sphere,
+                                             std::span<const mesh::Meshlet> meshlets)
+{
+    bool indexed = geometry.index_count_ > 0;
+
+    MeshRecord record{};
+    record.geometry_ = geometry;
+    record.vertex_buffer_ = geometry_arena_->GetVertexBuffer();
+    record.index_buffer_ = indexed ? geometry_arena_->GetIndexBuffer() : VK_NULL_HANDLE;
+    record.index_type_ = GeometryArena::s_index_type_;
+    record.vertex_count_ = record.geometry_.vertex_count_;
+    record.index_count_ = record.geometry_.index_count_;
+
+    uint32_t first_element = static_cast<uint32_t>(record.geometry_.vertex_offset_);
+    if (indexed)
+    {
+        record.vertex_offset_ = record.geometry_.vertex_offset_;
+        first_element = record.geometry_.first_index_;
+    }
+
+    try
+    {
+        return InsertMesh(std::move(record), first_element, lods, bounding_sphere, meshlets);
+    }
+    catch (...)
+    {
+        geometry_arena_->Free(geometry);
+        throw;
+    }
+}
+
+MeshHandle ResourceRegistry::AddMesh(std::unique_ptr<VertexBuffer> mesh,
+                                     std::span<const mesh::MeshFileLod> lods,
+                                     const glm::vec4& bounding_sphere,
+                                     std::span<const mesh::Meshlet> meshlets)
+{
+    MeshRecord record{};
+    record.owner_ = std::move(mesh);
+    record.vertex_buffer_ = record.owner_->GetVertexBuffer();
+    record.index_buffer_ = record.owner_->GetIndexBuffer();
+    record.index_type_ = record.owner_->GetIndexType();
+    record.vertex_count_ = record.owner_->GetVertexCount();
+    record.index_count_ = record.owner_->GetIndexCount();
+
+    return InsertMesh(std::move(record), 0, lods, bounding_sphere, meshlets);
+}
+
+MeshHandle ResourceRegistry::InsertMesh(MeshRecord record,
+                                        uint32_t first_element,
+                                        std::span<const mesh::MeshFileLod> lods,
+                                        const glm::vec4& bounding_sphere,
+                                        std::span<const mesh::Meshlet> meshlets)
+{
+    record.bounding_sphere_ = bounding_sphere;
+
+    uint32_t element_count = record.index_buffer_ != VK_NULL_HANDLE ? record.index_count_ : record.vertex_count_;
+    if (lods.empty())
+    {
+        record.lods_[0] = MeshLod{first_element, element_count, 0.0f};
+        record.lod_count_ = 1;
+    }
+    else
+    {
+        record.lod_count_ = static_cast<uint32_t>(std::min<size_t>(lods.size(), mesh::s_max_mesh_lods_));
+        for (uint32_t i = 0; i < record.lod_count_; ++i)
+        {
+            const mesh::MeshFileLod& lod = lods[i];
+            if (lod.first_index_ > element_count || lod.index_count_ > element_count - lod.first_index_)
+            {
+                throw std::runtime_error("Mesh LOD range exceeds the mesh");
+            }
+            record.lods_[i] = MeshLod{first_element + lod.first_index_, lod.index_count_, lod.error_};
+        }
+    }
+
+    if (!meshlets.empty() && record.index_buffer_ != VK_NULL_HANDLE)
+    {
+        for (const mesh::Meshlet& meshlet : meshlets)
+        {
+            if (meshlet.first_index_ > record.index_count_ || meshlet.index_count_ > record.index_count_ - meshlet.first_index_)
+            {
+                throw std::runtime_error("Meshlet range exceeds the mesh");
+            }
+        }
+        record.meshlets_ = std::make_unique<MeshletCuller>(meshlets, first_element);
+    }
+
+    return meshes_.Insert(std::move(record));
+}
+
+MeshHandle ResourceRegistry::LoadMesh(const mesh::MeshFile& file)
+{
+    const mesh::MeshFileHeader& header = file.GetHeader();
+
+    glm::vec3 bounds_min(header.bounds_min_[0], header.bounds_min_[1], header.bounds_min_[2]);
+    glm::vec3 bounds_max(header.bounds_max_[0], header.bounds_max_[1], header.bounds_max_[2]);
+    glm::vec4 bounding_sphere((bounds_min + bounds_max) * 0.5f, glm::length(bounds_max - bounds_min) * 0.5f);
+
+    // the arena only holds 32-bit indices, 16-bit files are widened straight into staging memory
+    std::span<const std::byte> index_data = file.GetIndexData();
+    GeometryRange geometry{};
+    if (header.index_size_ == sizeof(uint16_t))
+    {
+        std::span<const uint16_t> indices(reinterpret_cast<const uint16_t*>(index_data.data()), header.index_count_);
+        geometry = geometry_arena_->Allocate(file.GetVertexData(), header.vertex_stride_, indices);
+    }
+    else
+    {
+        std::span<const uint32_t> indices(reinterpret_cast<const uint32_t*>(index_data.data()), header.index_count_);
+        geometry = geometry_arena_->Allocate(file.GetVertexData(), header.vertex_stride_, indices);
+    }
+
+    return InsertArenaMesh(geometry, file.GetLods(), bounding_sphere, file.GetMeshlets());
+}
+
+void ResourceRegistry::DestroyMesh(MeshHandle handle)
+{
+    MeshRecord* record = meshes_.Get(handle);
+    if (!record)
+    {
+        return;
+    }
+
+    geometry_arena_->Free(record->geometry_);
+    meshes_.Remove(handle);
+}
+
+void ResourceRegistry::BindMesh(VkCommandBuffer command_buffer, const MeshRecord& mesh)
+{
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(command_buffer, 0, 1, &mesh.vertex_buffer_, &offset);
+
+    if (mesh.index_buffer_ != VK_NULL_HANDLE)
+    {
+        vkCmdBindIndexBuffer(command_buffer, mesh.index_buffer_, 0, mesh.index_type_);
+    }
+}
+
+void ResourceRegistry::DrawMesh(VkCommandBuffer command_buffer, const MeshRecord& mesh, uint32_t instance_count, uint32_t lod)
+{
+    BindMesh(command_buffer, mesh);
+    DrawBoundMesh(command_buffer, mesh, instance_count, lod);
+}
+
+void ResourceRegistry::DrawBoundMesh(VkCommandBuffer command_buffer, const MeshRecord& mesh, uint32_t instance_count, uint32_t lod)
+{
+    const MeshLod& range = mesh.lods_[std::min(lod, mesh.lod_count_ - 1)];
+
+    if (mesh.index_buffer_ != VK_NULL_HANDLE)
+    {
+        vkCmdDrawIndexed(command_buffer, range.index_count_, instance_count, range.first_index_, mesh.vertex_offset_, 0);
+    }
+    else
+    {
+        vkCmdDraw(command_buffer, range.index_count_, instance_count, range.first_index_, 0);
+    }
+}
+
+void ResourceRegistry::DrawInstanced(VkCommandBuffer command_buffer,
+                                     const MeshRecord& mesh,
+                                     VkBuffer instance_buffer,
+                                     VkDeviceSize instance_offset,
+                                     uint32_t instance_count,
+                                     uint32_t lod)
+{
+    vkCmdBindVertexBuffers(command_buffer, s_instance_binding_, 1, &instance_buffer, &instance_offset);
+    DrawBoundMesh(command_buffer, mesh, instance_count, lod);
+}
+
+void ResourceRegistry::DrawMeshRanges(VkCommandBuffer command_buffer, const MeshRecord& mesh, std::span<const IndexRange> ranges, uint32_t instance_count)
+{
+    for (const IndexRange& range : ranges)
+    {
+        vkCmdDrawIndexed(command_buffer, range.index_count_, instance_count, range.first_index_, mesh.vertex_offset_, 0);
+    }
+}
+
+} // namespace renderer
@@ -0,0 +1,212 @@
+#pragma once
+
+// std
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+// vulkan
+#include <vulkan/vulkan.h>
+
+// glm
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// renderer includes
+#include <renderer/renderer/device.hpp>
+#include <renderer/renderer/buffer.hpp>
+#include <renderer/renderer/pipeline.hpp>
+#include <renderer/renderer/vertex_buffer.hpp>
+#include <renderer/renderer/geometry_arena.hpp>
+#include <renderer/renderer/meshlet_culler.hpp>
+#include <renderer/renderer/slot_map.hpp>
+#include <renderer/renderer/mesh/mesh_file.hpp>
+
+namespace renderer {
+
+struct BufferTag;
+struct ImageTag;
+struct PipelineTag;
+struct MeshTag;
+
+using BufferHandle = Handle<BufferTag>;
+using ImageHandle = Handle<ImageTag>;
+using PipelineHandle = Handle<PipelineTag>;
+using MeshHandle = Handle<MeshTag>;
+
+// Records keep the data render loops read (hot) inline, so scanning a table touches one
+// contiguous array. The owning objects (cold) are only dereferenced on destruction.
+struct BufferRecord
+{
+    VkBuffer buffer_ = VK_NULL_HANDLE;
+    VkDeviceSize size_ = 0;
+    // persistently mapped pointer for host visible buffers
+    void* mapped_ = nullptr;
+
+    std::unique_ptr<Buffer> owner_;
+};
+
+struct ImageRecord
+{
+    VkImage image_ = VK_NULL_HANDLE;
+    VkImageView view_ = VK_NULL_HANDLE;
+    VkFormat format_ = VK_FORMAT_UNDEFINED;
+    VkExtent3D extent_{};
+
+    Allocation allocation_;
+};
+
+struct PipelineRecord
+{
+    VkPipeline pipeline_ = VK_NULL_HANDLE;
+    VkPipelineLayout layout_ = VK_NULL_HANDLE;
+
+    std::unique_ptr<Pipeline> owner_;
+};
+
+// Index range of one detail level (vertex range for non indexed meshes). error_ is the object
+// space simplification error, 0 for the full mesh.
+struct MeshLod
+{
+    uint32_t first_index_ = 0;
+    uint32_t index_count_ = 0;
+    float error_ = 0.0f;
+};
+
+struct MeshRecord
+{
+    VkBuffer vertex_buffer_ = VK_NULL_HANDLE;
+    VkBuffer index_buffer_ = VK_NULL_HANDLE;
+    VkIndexType index_type_ = VK_INDEX_TYPE_UINT16;
+    uint32_t vertex_count_ = 0;
+    uint32_t index_count_ = 0;
+    // vertexOffset of indexed draws, LOD and meshlet ranges already include the first index
+    int32_t vertex_offset_ = 0;
+
+    // LOD 0 is the full mesh, coarser levels share the vertex and index buffers
+    std::array<MeshLod, mesh::s_max_mesh_lods_> lods_{};
+    uint32_t lod_count_ = 1;
+    // object space (center, radius), for LOD selection
+    glm::vec4 bounding_sphere_{0.0f};
+
+    // clusters of LOD 0, nullptr for meshes without meshlets
+    std::unique_ptr<MeshletCuller> meshlets_;
+
+    // range in the registry's geometry arena, empty for meshes owning their buffers
+    GeometryRange geometry_{};
+    std::unique_ptr<VertexBuffer> owner_;
+};
+
+// Renderer resources addressed by 32-bit generational handles. Stale handles are detected in O(1)
+// and resolve to nullptr; destruction goes through the device deletion queue, so handles can be
+// destroyed while frames using them are still in flight.
+class ResourceRegistry
+{
+public:
+    ResourceRegistry(Device& device,
+                     VkDeviceSize geometry_vertex_capacity = GeometryArena::s_default_vertex_capacity_,
+                     uint32_t geometry_index_capacity = GeometryArena::s_default_index_capacity_);
+    ~ResourceRegistry();
+
+    ResourceRegistry(const ResourceRegistry&) = delete;
+    ResourceRegistry& operator=(const ResourceRegistry&) = delete;
+
+    // buffers
+    BufferHandle CreateBuffer(VkDeviceSize instance_size,
+                              uint32_t instance_count,
+                              VkBufferUsageFlags usage,
+                              VkMemoryPropertyFlags properties);
+    BufferRecord* GetBuffer(BufferHandle handle) { return buffers_.Get(handle); }
+    void DestroyBuffer(BufferHandle handle) { buffers_.Remove(handle); }
+
+    // images, with a view covering the whole image
+    ImageHandle CreateImage(const VkImageCreateInfo& image_info,
+                            VkImageAspectFlags aspect,
+                            VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    ImageRecord* GetImage(ImageHandle handle) { return images_.Get(handle); }
+    void DestroyImage(ImageHandle handle);
+
+    // pipelines
+    PipelineHandle AddPipeline(std::unique_ptr<Pipeline> pipeline);
+    PipelineRecord* GetPipeline(PipelineHandle handle) { return pipelines_.Get(handle); }
+    void DestroyPipeline(PipelineHandle handle) { pipelines_.Remove(handle); }
+
+    // meshes, static ones live in the shared geometry arena
+    template<typename V>
+    MeshHandle CreateMesh(const std::vector<V>& vertices,
+                          const std::vector<uint32_t>& indices = {},
+                          const glm::vec4& bounding_sphere = glm::vec4(0.0f))
+    {
+        return AddStaticMesh(std::as_bytes(std::span<const V>(vertices)), sizeof(V), indices, {}, bounding_sphere);
+    }
+    // LOD and meshlet ranges are relative to the mesh. lods empty: a single level covering the
+    // whole mesh. meshlets are ignored for non indexed meshes
+    MeshHandle AddStaticMesh(std::span<const std::byte> vertices,
+                             uint32_t vertex_stride,
+                             std::span<const uint32_t> indices,
+                             std::span<const mesh::MeshFileLod> lods = {},
+                             const glm::vec4& bounding_sphere = glm::vec4(0.0f),
+                             std::span<const mesh::Meshlet> meshlets = {});
+    // a mesh with buffers of its own, drawn with DrawMesh
+    MeshHandle AddMesh(std::unique_ptr<VertexBuffer> mesh,
+                       std::span<const mesh::MeshFileLod> lods = {},
+                       const glm::vec4& bounding_sphere = glm::vec4(0.0f),
+                       std::span<const mesh::Meshlet> meshlets = {});
+    // copies the mapped streams into the geometry arena, the file can be closed once this returns
+    MeshHandle LoadMesh(const mesh::MeshFile& file);
+    MeshRecord* GetMesh(MeshHandle handle) { return meshes_.Get(handle); }
+    void DestroyMesh(MeshHandle handle);
+
+    GeometryArena& GetGeometryArena() { return *geometry_arena_; }
+    // binds the arena buffers, after which every static mesh is drawn with DrawBoundMesh
+    void BindGeometry(VkCommandBuffer command_buffer) { geometry_arena_->Bind(command_buffer); }
+
+    // dense tables for render loops
+    SlotMap<MeshRecord, MeshTag>& GetMeshes() { return meshes_; }
+    SlotMap<PipelineRecord, PipelineTag>& GetPipelines() { return pipelines_; }
+
+    static void BindMesh(VkCommandBuffer command_buffer, const MeshRecord& mesh);
+    // BindMesh followed by DrawBoundMesh
+    static void DrawMesh(VkCommandBuffer command_buffer, const MeshRecord& mesh, uint32_t instance_count = 1, uint32_t lod = 0);
+    // draw only, the mesh's buffers (BindMesh or BindGeometry) must be bound
+    static void DrawBoundMesh(VkCommandBuffer command_buffer, const MeshRecord& mesh, uint32_t instance_count = 1, uint32_t lod = 0);
+    // instance_count copies of the mesh in one draw, the per instance stream (e.g. InstanceData)
+    // is read from instance_buffer at instance_offset through s_instance_binding_. Draw only,
+    // like DrawBoundMesh
+    static void DrawInstanced(VkCommandBuffer command_buffer,
+                              const MeshRecord& mesh,
+                              VkBuffer instance_buffer,
+                              VkDeviceSize instance_offset,
+                              uint32_t instance_count,
+                              uint32_t lod = 0);
+    // index sub-ranges of an indexed mesh, usually the meshlets surviving MeshletCuller::Cull.
+    // Draw only, like DrawBoundMesh
+    static void DrawMeshRanges(VkCommandBuffer command_buffer, const MeshRecord& mesh, std::span<const IndexRange> ranges, uint32_t instance_count = 1);
+
+private:
+    // a mesh whose geometry was just allocated in the arena, freed again if inserting throws
+    MeshHandle InsertArenaMesh(const GeometryRange& geometry,
+                               std::span<const mesh::MeshFileLod> lods,
+                               const glm::vec4& bounding_sphere,
+                               std::span<const mesh::Meshlet> meshlets);
+    // fills the LOD table and the meshlet culler, offsetting their ranges by the mesh's first element
+    MeshHandle InsertMesh(MeshRecord record,
+                          uint32_t first_element,
+                          std::span<const mesh::MeshFileLod> lods,
+                          const glm::vec4& bounding_sphere,
+                          std::span<const mesh::Meshlet> meshlets);
+
+private:
+    Device& device_;
+
+    std::unique_ptr<GeometryArena> geometry_arena_;
+
+    SlotMap<BufferRecord, BufferTag> buffers_;
+    SlotMap<ImageRecord, ImageTag> images_;
+    SlotMap<PipelineRecord, PipelineTag> pipelines_;
+    SlotMap<MeshRecord, MeshTag> meshes_;
+};
+
+} // namespace renderer
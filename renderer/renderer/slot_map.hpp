@@ -0,0 +1,170 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace renderer {
+
+// 32-bit generational handle: 20 bits of slot index, 12 bits of generation.
+// Generation 0 is never issued, so a default constructed handle is always invalid.
+template<typename Tag>
+class Handle
+{
+public:
+    static constexpr uint32_t s_index_bits_ = 20;
+    static constexpr uint32_t s_generation_bits_ = 12;
+    static constexpr uint32_t s_index_mask_ = (1u << s_index_bits_) - 1;
+    static constexpr uint32_t s_max_generation_ = (1u << s_generation_bits_) - 1;
+    static constexpr uint32_t s_max_slots_ = 1u << s_index_bits_;
+
+public:
+    Handle() = default;
+    Handle(uint32_t index, uint32_t generation)
+        : value_{(generation << s_index_bits_) | (index & s_index_mask_)}
+    {}
+
+    uint32_t GetIndex() const { return value_ & s_index_mask_; }
+    uint32_t GetGeneration() const { return value_ >> s_index_bits_; }
+    uint32_t GetValue() const { return value_; }
+
+    bool IsValid() const { return value_ != 0; }
+
+    bool operator==(const Handle& other) const { return value_ == other.value_; }
+    bool operator!=(const Handle& other) const { return value_ != other.value_; }
+
+private:
+    uint32_t value_ = 0;
+};
+
+// Slot map: values live densely packed in one contiguous array (iteration never chases pointers),
+// handles go through a sparse slot table that stores the dense index and the current generation.
+// Lookup, insertion and removal are O(1); removal swaps the last value into the hole.
+template<typename T, typename Tag = T>
+class SlotMap
+{
+public:
+    using HandleType = Handle<Tag>;
+
+public:
+    template<typename... Args>
+    HandleType Emplace(Args&&... args)
+    {
+        uint32_t slot_index;
+        if (free_head_ != s_end_of_list_)
+        {
+            slot_index = free_head_;
+            free_head_ = slots_[slot_index].dense_index_;
+        }
+        else
+        {
+            if (slots_.size() >= HandleType::s_max_slots_)
+            {
+                throw std::runtime_error("SlotMap is full!");
+            }
+
+            slot_index = static_cast<uint32_t>(slots_.size());
+            slots_.push_back(Slot{0, 1});
+        }
+
+        Slot& slot = slots_[slot_index];
+        slot.dense_index_ = static_cast<uint32_t>(values_.size());
+
+        values_.emplace_back(std::forward<Args>(args)...);
+        dense_to_slot_.push_back(slot_index);
+
+        return HandleType{slot_index, slot.generation_};
+    }
+
+    HandleType Insert(T value) { return Emplace(std::move(value)); }
+
+    bool Contains(HandleType handle) const
+    {
+        uint32_t index = handle.GetIndex();
+        return handle.IsValid() && index < slots_.size() && slots_[index].generation_ == handle.GetGeneration();
+    }
+
+    // nullptr for stale or invalid handles
+    T* Get(HandleType handle)
+    {
+        return Contains(handle) ? &values_[slots_[handle.GetIndex()].dense_index_] : nullptr;
+    }
+
+    const T* Get(HandleType handle) const
+    {
+        return Contains(handle) ? &values_[slots_[handle.GetIndex()].dense_index_] : nullptr;
+    }
+
+    bool Remove(HandleType handle)
+    {
+        if (!Contains(handle))
+        {
+            return false;
+        }
+
+        uint32_t slot_index = handle.GetIndex();
+        Slot& slot = slots_[slot_index];
+        uint32_t dense_index = slot.dense_index_;
+        uint32_t last_index = static_cast<uint32_t>(values_.size() - 1);
+
+        if (dense_index != last_index)
+        {
+            values_[dense_index] = std::move(values_[last_index]);
+            dense_to_slot_[dense_index] = dense_to_slot_[last_index];
+            slots_[dense_to_slot_[dense_index]].dense_index_ = dense_index;
+        }
+        values_.pop_back();
+        dense_to_slot_.pop_back();
+
+        // bumping the generation invalidates every outstanding handle to this slot
+        slot.generation_ = slot.generation_ == HandleType::s_max_generation_ ? 1 : slot.generation_ + 1;
+        slot.dense_index_ = free_head_;
+        free_head_ = slot_index;
+
+        return true;
+    }
+
+    void Clear()
+    {
+        while (!values_.empty())
+        {
+            uint32_t slot_index = dense_to_slot_.back();
+            Remove(HandleType{slot_index, slots_[slot_index].generation_});
+        }
+    }
+
+    // handle of the value at a dense position, for loops over the dense array
+    HandleType GetHandle(size_t dense_index) const
+    {
+        uint32_t slot_index = dense_to_slot_[dense_index];
+        return HandleType{slot_index, slots_[slot_index].generation_};
+    }
+
+    size_t Size() const { return values_.size(); }
+    bool Empty() const { return values_.empty(); }
+
+    T* Data() { return values_.data(); }
+    auto begin() { return values_.begin(); }
+    auto end() { return values_.end(); }
+    auto begin() const { return values_.begin(); }
+    auto end() const { return values_.end(); }
+
+private:
+    struct Slot
+    {
+        // dense index while occupied, next free slot while free
+        uint32_t dense_index_;
+        uint32_t generation_;
+    };
+
+    static constexpr uint32_t s_end_of_list_ = UINT32_MAX;
+
+    std::vector<T> values_;
+    std::vector<uint32_t> dense_to_slot_;
+    std::vector<Slot> slots_;
+    uint32_t free_head_ = s_end_of_list_;
+};
+
+} // namespace renderer
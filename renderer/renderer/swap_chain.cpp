@@ -21,11 +21,19 @@
 
 namespace renderer {
 
-SwapChain::SwapChain(Device& device, VkExtent2D window_extent)
+SwapChain::SwapChain(Device& device, VkExtent2D window_extent, uint32_t frames_in_flight)
     : device_{device}
     , window_extent_{window_extent}
+    , frames_in_flight_{std::clamp(frames_in_flight, MIN_FRAMES_IN_FLIGHT, MAX_FRAMES_IN_FLIGHT)}
 {
-    CreateSwapChain();
+    if (device_.IsHeadless())
+    {
+        CreateOffscreenImages();
+    }
+    else
+    {
+        CreateSwapChain();
+    }
     CreateImageViews();
     CreateRenderPass();
     CreateDepthResources();
@@ -47,11 +55,15 @@ SwapChain::~SwapChain()
         swap_chain_ = nullptr;
     }    
 
+    for (size_t i = 0; i < offscreen_image_allocations_.size(); ++i)
+    {
+        device_.DestroyImage(swap_chain_images_[i], offscreen_image_allocations_[i]);
+    }
+
     for (int i = 0; i < depth_images_.size(); ++i)
     {
         vkDestroyImageView(device_.GetDevice(), depth_image_views_[i], nullptr);
-        vkDestroyImage(device_.GetDevice(), depth_images_[i], nullptr);
-        vkFreeMemory(device_.GetDevice(), depth_image_memorys_[i], nullptr);
+        device_.DestroyImage(depth_images_[i], depth_image_allocations_[i]);
     }
 
     for (auto framebuffer : swap_chain_framebuffers_)
@@ -60,53 +72,99 @@ SwapChain::~SwapChain()
     }
 
     vkDestroyRenderPass(device_.GetDevice(), render_pass_, nullptr);
+    vkDestroyRenderPass(device_.GetDevice(), resume_render_pass_, nullptr);
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) 
+    for (size_t i = 0; i < frames_in_flight_; i++) 
     {
         vkDestroySemaphore(device_.GetDevice(), render_finished_semaphores_[i], nullptr);
         vkDestroySemaphore(device_.GetDevice(), image_available_semaphores_[i], nullptr);
-        vkDestroyFence(device_.GetDevice(), in_flight_fences_[i], nullptr);
     }
 }
 
 VkResult SwapChain::AcquireImage(uint32_t* image_index)
 {
-    // begin frame
-    vkWaitForFences(device_.GetDevice(), 1, &in_flight_fences_[current_frame_], VK_TRUE, UINT64_MAX);
+    // begin frame: wait until the GPU finished the frame that last used this slot
+    device_.GetFrameTimeline().Wait(frame_values_[current_frame_]);
+
+    if (device_.IsHeadless())
+    {
+        // one offscreen image per frame in flight, already released by the wait above
+        *image_index = current_frame_;
+        return VK_SUCCESS;
+    }
 
     VkResult result = vkAcquireNextImageKHR(device_.GetDevice(), swap_chain_, UINT64_MAX, image_available_semaphores_[current_frame_], VK_NULL_HANDLE, image_index);
+    if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+    {
+        return result;
+    }
+
+    // the image may come back while an older frame still renders into it
+    // (frames in flight and swap chain image counts are independent)
+    device_.GetFrameTimeline().Wait(images_in_flight_[*image_index]);
 
     return result;
 }
 
 VkResult SwapChain::SubmitCommandBuffer(VkCommandBuffer command_buffer, uint32_t* image_index)
 {
-    VkSubmitInfo submit_info{};
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    TimelineSemaphore& frame_timeline = device_.GetFrameTimeline();
+    uint64_t frame_value = frame_timeline.AdvancePending();
 
+    frame_values_[current_frame_] = frame_value;
+    if (!device_.IsHeadless())
+    {
+        images_in_flight_[*image_index] = frame_value;
+    }
+
+    // the timeline value tracks frame completion, the binary semaphores only exist for presentation
     VkSemaphore wait_semaphores[] = {image_available_semaphores_[current_frame_]};
     VkPipelineStageFlags wait_stages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submit_info.waitSemaphoreCount = 1;
+    uint64_t wait_values[] = {0};
+
+    VkSemaphore signal_semaphores[] = {frame_timeline.GetSemaphore(), render_finished_semaphores_[current_frame_]};
+    uint64_t signal_values[] = {frame_value, 0};
+
+    // headless: nothing to acquire or present
+    uint32_t binary_count = device_.IsHeadless() ? 0 : 1;
+
+    VkTimelineSemaphoreSubmitInfo timeline_info{};
+    timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timeline_info.waitSemaphoreValueCount = binary_count;
+    timeline_info.pWaitSemaphoreValues = wait_values;
+    timeline_info.signalSemaphoreValueCount = 1 + binary_count;
+    timeline_info.pSignalSemaphoreValues = signal_values;
+
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.pNext = &timeline_info;
+
+    submit_info.waitSemaphoreCount = binary_count;
     submit_info.pWaitSemaphores = wait_semaphores;
     submit_info.pWaitDstStageMask = wait_stages;
 
     submit_info.commandBufferCount = 1;
     submit_info.pCommandBuffers = &command_buffer;
 
-    VkSemaphore signal_semaphores[] = {render_finished_semaphores_[current_frame_]};
-    submit_info.signalSemaphoreCount = 1;
+    submit_info.signalSemaphoreCount = 1 + binary_count;
     submit_info.pSignalSemaphores = signal_semaphores;
 
-    vkResetFences(device_.GetDevice(), 1, &in_flight_fences_[current_frame_]);
-    if (vkQueueSubmit(device_.GetGraphicsQueue(), 1, &submit_info, in_flight_fences_[current_frame_]) != VK_SUCCESS) {        
+    if (vkQueueSubmit(device_.GetGraphicsQueue(), 1, &submit_info, VK_NULL_HANDLE) != VK_SUCCESS) {        
         throw std::runtime_error("failed to submit draw command buffer!");
     }
 
+    current_frame_ = (current_frame_ + 1) % frames_in_flight_;
+
+    if (device_.IsHeadless())
+    {
+        return VK_SUCCESS;
+    }
+
     VkPresentInfoKHR present_info{};
     present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
     present_info.waitSemaphoreCount = 1;
-    present_info.pWaitSemaphores = signal_semaphores;
+    present_info.pWaitSemaphores = &signal_semaphores[1];
 
     VkSwapchainKHR swap_chains[] = {swap_chain_};
     present_info.swapchainCount = 1;
@@ -114,11 +172,7 @@ VkResult SwapChain::SubmitCommandBuffer(VkCommandBuffer command_buffer, uint32_t
 
     present_info.pImageIndices = image_index;
 
-    VkResult result = vkQueuePresentKHR(device_.GetPresentQueue(), &present_info);
-
-    current_frame_ = (current_frame_ + 1) % MAX_FRAMES_IN_FLIGHT;
-
-    return result;
+    return vkQueuePresentKHR(device_.GetPresentQueue(), &present_info);
 }
 
 
@@ -182,6 +236,43 @@ void SwapChain::CreateSwapChain()
     swap_chain_extent_ = extent;
 }   
 
+void SwapChain::CreateOffscreenImages()
+{
+    // Headless mode: plain device local images stand in for the swap chain images.
+    // One image per frame in flight, so the frame timeline values also guard image reuse.
+    swap_chain_image_format_ = VK_FORMAT_R8G8B8A8_UNORM;
+    swap_chain_extent_ = window_extent_;
+
+    swap_chain_images_.resize(frames_in_flight_);
+    offscreen_image_allocations_.resize(frames_in_flight_);
+
+    for (size_t i = 0; i < swap_chain_images_.size(); ++i)
+    {
+        VkImageCreateInfo image_info{};
+        image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        image_info.imageType = VK_IMAGE_TYPE_2D;
+        image_info.extent.width = swap_chain_extent_.width;
+        image_info.extent.height = swap_chain_extent_.height;
+        image_info.extent.depth = 1;
+        image_info.mipLevels = 1;
+        image_info.arrayLayers = 1;
+        image_info.format = swap_chain_image_format_;
+        image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        // transfer src so frames can be read back
+        image_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+        image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        image_info.flags = 0;
+
+        device_.CreateImageWithInfo(
+            image_info,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            swap_chain_images_[i],
+            offscreen_image_allocations_[i]);
+    }
+}
+
 void SwapChain::CreateImageViews()
 {
     swap_chain_image_views_.resize(swap_chain_images_.size());
@@ -266,33 +357,50 @@ void SwapChain::CreateFramebuffers()
 
 void SwapChain::CreateSyncObjects()
 {
-    image_available_semaphores_.resize(MAX_FRAMES_IN_FLIGHT);
-    render_finished_semaphores_.resize(MAX_FRAMES_IN_FLIGHT);
-    in_flight_fences_.resize(MAX_FRAMES_IN_FLIGHT);
+    image_available_semaphores_.resize(frames_in_flight_);
+    render_finished_semaphores_.resize(frames_in_flight_);
+    frame_values_.assign(frames_in_flight_, device_.GetFrameTimeline().GetPendingValue());
+    images_in_flight_.assign(swap_chain_images_.size(), device_.GetFrameTimeline().GetPendingValue());
 
     VkSemaphoreCreateInfo semaphore_info{};
     semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-    VkFenceCreateInfo fence_info{};
-    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-    
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    for (size_t i = 0; i < frames_in_flight_; ++i)
     {
         if (vkCreateSemaphore(device_.GetDevice(), &semaphore_info, nullptr, &image_available_semaphores_[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(device_.GetDevice(), &semaphore_info, nullptr, &render_finished_semaphores_[i]) != VK_SUCCESS ||
-            vkCreateFence(device_.GetDevice(), &fence_info, nullptr, &in_flight_fences_[i]) != VK_SUCCESS) {
+            vkCreateSemaphore(device_.GetDevice(), &semaphore_info, nullptr, &render_finished_semaphores_[i]) != VK_SUCCESS) {
             throw std::runtime_error("failed to create synchronization objects for a frame!");
         }
     }
 }
 
 
+DepthAttachment SwapChain::GetDepthAttachment(uint32_t image_index)
+{
+    DepthAttachment attachment{};
+    attachment.image_ = depth_images_[image_index];
+    attachment.view_ = depth_image_views_[image_index];
+    attachment.format_ = swap_chain_depth_format_;
+    attachment.extent_ = swap_chain_extent_;
+    attachment.sampled_ = depth_sampled_;
+    attachment.image_count_ = static_cast<uint32_t>(depth_images_.size());
+    attachment.version_ = version_;
+    return attachment;
+}
+
 void SwapChain::RecreateSwapChain(VkExtent2D new_window_extent)
 {
     window_extent_ = new_window_extent;
+    ++version_;
 
-    CreateSwapChain();
+    if (device_.IsHeadless())
+    {
+        CreateOffscreenImages();
+    }
+    else
+    {
+        CreateSwapChain();
+    }
     CreateImageViews();
     CreateRenderPass();
     CreateDepthResources();
@@ -306,7 +414,8 @@ void SwapChain::CreateRenderPass()
     depth_attachment.format = FindDepthFormat();
     depth_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
     depth_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depth_attachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    // kept for the depth pyramid and for passes resumed with resume_render_pass_
+    depth_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     depth_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     depth_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     depth_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -324,7 +433,7 @@ void SwapChain::CreateRenderPass()
     color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    color_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    color_attachment.finalLayout = device_.IsHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkAttachmentReference color_attachment_ref{};
     color_attachment_ref.attachment = 0;
@@ -339,10 +448,10 @@ void SwapChain::CreateRenderPass()
     VkSubpassDependency dependency{};
     dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
     dependency.dstSubpass = 0;
-    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.srcAccessMask = 0;
-    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
 
     std::array<VkAttachmentDescription, 2> attachments = {color_attachment, depth_attachment};
@@ -358,6 +467,29 @@ void SwapChain::CreateRenderPass()
     if (vkCreateRenderPass(device_.GetDevice(), &render_pass_info, nullptr, &render_pass_) != VK_SUCCESS) {
         throw std::runtime_error("failed to create render pass!");
     }    
+
+    // same attachments, continuing from where a render_pass_ instance left them
+    color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    color_attachment.initialLayout = color_attachment.finalLayout;
+    depth_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    depth_attachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    attachments = {color_attachment, depth_attachment};
+
+    // the previous pass's attachment writes come before this one's loads
+    VkSubpassDependency resume_dependency{};
+    resume_dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+    resume_dependency.dstSubpass = 0;
+    resume_dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    resume_dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    resume_dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    resume_dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+                                    | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    render_pass_info.pDependencies = &resume_dependency;
+
+    if (vkCreateRenderPass(device_.GetDevice(), &render_pass_info, nullptr, &resume_render_pass_) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create resume render pass!");
+    }
 }
 
 void SwapChain::CreateDepthResources()
@@ -366,8 +498,13 @@ void SwapChain::CreateDepthResources()
     swap_chain_depth_format_ = depth_format;
     VkExtent2D swap_chain_extent = swap_chain_extent_;
 
+    // sampled depth feeds the depth pyramid of occlusion culling, optional for depth formats
+    VkFormatProperties format_properties;
+    vkGetPhysicalDeviceFormatProperties(device_.GetPhysicalDevice(), depth_format, &format_properties);
+    depth_sampled_ = (format_properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+
     depth_images_.resize(swap_chain_images_.size());
-    depth_image_memorys_.resize(swap_chain_images_.size());
+    depth_image_allocations_.resize(swap_chain_images_.size());
     depth_image_views_.resize(swap_chain_images_.size());
 
     for (int i = 0; i < depth_images_.size(); ++i)
@@ -383,7 +520,7 @@ void SwapChain::CreateDepthResources()
         image_info.format = swap_chain_depth_format_;
         image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
         image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        image_info.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        image_info.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | (depth_sampled_ ? VK_IMAGE_USAGE_SAMPLED_BIT : 0);
         image_info.samples = VK_SAMPLE_COUNT_1_BIT;
         image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
         image_info.flags = 0;
@@ -392,7 +529,7 @@ void SwapChain::CreateDepthResources()
             image_info,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             depth_images_[i],
-            depth_image_memorys_[i]);
+            depth_image_allocations_[i]);
 
         VkImageViewCreateInfo view_info{};
         view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
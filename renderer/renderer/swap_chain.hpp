@@ -21,13 +21,33 @@ struct SwapChainInfo
     VkRenderPass render_pass_;
 };
 
+// Depth attachment of one swap chain image. Between render passes it is in
+// VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, sampled_ when it can be read by shaders
+struct DepthAttachment
+{
+    VkImage image_ = VK_NULL_HANDLE;
+    // depth aspect only
+    VkImageView view_ = VK_NULL_HANDLE;
+    VkFormat format_ = VK_FORMAT_UNDEFINED;
+    VkExtent2D extent_{};
+    bool sampled_ = false;
+    // depth attachments of the swap chain, one per image
+    uint32_t image_count_ = 0;
+    // bumped whenever the swap chain is recreated, handles of older versions are stale
+    uint64_t version_ = 0;
+};
+
 class SwapChain
 {
 public:
-    static constexpr size_t MAX_FRAMES_IN_FLIGHT = 2;
+    // frames the CPU may record ahead of the GPU, chosen at runtime within these bounds.
+    // More frames trade input latency for throughput
+    static constexpr uint32_t MIN_FRAMES_IN_FLIGHT = 1;
+    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+    static constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
 
 public:
-    SwapChain(Device& device, VkExtent2D window_extent);
+    SwapChain(Device& device, VkExtent2D window_extent, uint32_t frames_in_flight = DEFAULT_FRAMES_IN_FLIGHT);
     ~SwapChain();
 
     VkResult AcquireImage(uint32_t* image_index);
@@ -35,13 +55,18 @@ public:
 
     // Getters
     VkRenderPass GetRenderPass() { return render_pass_; }
+    // compatible with GetRenderPass, loads the attachments instead of clearing them
+    VkRenderPass GetResumeRenderPass() { return resume_render_pass_; }
     VkFramebuffer GetFrameBuffer(uint32_t image_index) { return swap_chain_framebuffers_[image_index]; }
     VkExtent2D GetExtent() { return swap_chain_extent_; }
+    uint32_t GetFramesInFlight() { return frames_in_flight_; }
+    DepthAttachment GetDepthAttachment(uint32_t image_index);
 
     void RecreateSwapChain(VkExtent2D new_window_extent);
 
 private:
     void CreateSwapChain();
+    void CreateOffscreenImages();
     void CreateRenderPass();
     void CreateDepthResources();
     void CreateImageViews(); 
@@ -58,32 +83,44 @@ private:
     Device& device_;
     VkExtent2D window_extent_;
 
-    VkSwapchainKHR swap_chain_;
+    VkSwapchainKHR swap_chain_ = VK_NULL_HANDLE;
 
     // images
     std::vector<VkImage> depth_images_;
-    std::vector<VkDeviceMemory> depth_image_memorys_;
+    std::vector<Allocation> depth_image_allocations_;
     std::vector<VkImageView> depth_image_views_;
 
     std::vector<VkImage> swap_chain_images_;
     std::vector<VkImageView> swap_chain_image_views_;
 
+    // headless mode: memory backing the offscreen images that stand in for swap chain images
+    std::vector<Allocation> offscreen_image_allocations_;
+
     // SwapChain format end extent
     VkFormat swap_chain_image_format_;
     VkFormat swap_chain_depth_format_;
+    // the depth images are also created with VK_IMAGE_USAGE_SAMPLED_BIT
+    bool depth_sampled_ = false;
+    uint64_t version_ = 0;
     VkExtent2D swap_chain_extent_;
 
     // Framebuffers
     std::vector<VkFramebuffer> swap_chain_framebuffers_;
 
-    // Sync objects
+    // Sync objects. Binary semaphores are only needed by acquire and present, frame completion
+    // is tracked with values on the device frame timeline
     std::vector<VkSemaphore> image_available_semaphores_;
     std::vector<VkSemaphore> render_finished_semaphores_;
-    std::vector<VkFence> in_flight_fences_;
+    // frame timeline value signaled by the last submission of each frame slot
+    std::vector<uint64_t> frame_values_;
+    // frame timeline value of the last frame rendering into each swap chain image
+    std::vector<uint64_t> images_in_flight_;
+    uint32_t frames_in_flight_;
     uint32_t current_frame_ = 0;
 
     // render pass
     VkRenderPass render_pass_;
+    VkRenderPass resume_render_pass_;
 };
 
 
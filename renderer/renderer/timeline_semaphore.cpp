@@ -0,0 +1,69 @@
+#include <renderer/renderer/timeline_semaphore.hpp>
+
+// std
+#include <stdexcept>
+
+namespace renderer {
+
+TimelineSemaphore::TimelineSemaphore(VkDevice device, uint64_t initial_value)
+    : device_{device}
+    , pending_value_{initial_value}
+    , completed_value_{initial_value}
+{
+    VkSemaphoreTypeCreateInfo type_info{};
+    type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    type_info.initialValue = initial_value;
+
+    VkSemaphoreCreateInfo semaphore_info{};
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphore_info.pNext = &type_info;
+
+    if (vkCreateSemaphore(device_, &semaphore_info, nullptr, &semaphore_) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create timeline semaphore!");
+    }
+}
+
+TimelineSemaphore::~TimelineSemaphore()
+{
+    vkDestroySemaphore(device_, semaphore_, nullptr);
+}
+
+uint64_t TimelineSemaphore::GetCompletedValue()
+{
+    uint64_t value = 0;
+    if (vkGetSemaphoreCounterValue(device_, semaphore_, &value) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to read timeline semaphore value!");
+    }
+
+    completed_value_ = value;
+    return value;
+}
+
+void TimelineSemaphore::Wait(uint64_t value, uint64_t timeout)
+{
+    if (value <= completed_value_)
+    {
+        return;
+    }
+
+    VkSemaphoreWaitInfo wait_info{};
+    wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores = &semaphore_;
+    wait_info.pValues = &value;
+
+    VkResult result = vkWaitSemaphores(device_, &wait_info, timeout);
+    if (result == VK_SUCCESS)
+    {
+        completed_value_ = value > completed_value_ ? value : completed_value_;
+    }
+    else if (result != VK_TIMEOUT)
+    {
+        throw std::runtime_error("Failed to wait for timeline semaphore!");
+    }
+}
+
+} // namespace renderer
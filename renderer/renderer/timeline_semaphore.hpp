@@ -0,0 +1,45 @@
+#pragma once
+
+// std
+#include <cstdint>
+
+// vulkan
+#include <vulkan/vulkan.h>
+
+namespace renderer {
+
+// Vulkan 1.2 timeline semaphore: a monotonically increasing 64-bit counter the GPU signals
+// and the CPU can poll or wait on for any past value.
+class TimelineSemaphore
+{
+public:
+    TimelineSemaphore(VkDevice device, uint64_t initial_value = 0);
+    ~TimelineSemaphore();
+
+    TimelineSemaphore(const TimelineSemaphore&) = delete;
+    TimelineSemaphore& operator=(const TimelineSemaphore&) = delete;
+
+    VkSemaphore GetSemaphore() { return semaphore_; }
+
+    // reserves the next value for a submission to signal
+    uint64_t AdvancePending() { return ++pending_value_; }
+    // last value handed out by AdvancePending, reached once all submitted work finished
+    uint64_t GetPendingValue() { return pending_value_; }
+
+    // value the GPU signaled so far (vkGetSemaphoreCounterValue)
+    uint64_t GetCompletedValue();
+    bool IsReached(uint64_t value) { return value <= completed_value_ || value <= GetCompletedValue(); }
+
+    void Wait(uint64_t value, uint64_t timeout = UINT64_MAX);
+    void WaitIdle() { Wait(pending_value_); }
+
+private:
+    VkDevice device_;
+    VkSemaphore semaphore_ = VK_NULL_HANDLE;
+
+    uint64_t pending_value_;
+    // cached, so checks against old values skip the driver call
+    uint64_t completed_value_;
+};
+
+} // namespace renderer
@@ -0,0 +1,155 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+// vulkan
+#include <vulkan/vulkan.h>
+
+// renderer includes
+#include <renderer/renderer/device.hpp>
+#include <renderer/renderer/buffer.hpp>
+#include <renderer/renderer/upload_engine.hpp>
+
+namespace renderer {
+
+template<typename T>
+struct IndexTraits;
+
+template<>
+struct IndexTraits<uint16_t>
+{
+    static constexpr VkIndexType s_index_type_ = VK_INDEX_TYPE_UINT16;
+};
+
+template<>
+struct IndexTraits<uint32_t>
+{
+    static constexpr VkIndexType s_index_type_ = VK_INDEX_TYPE_UINT32;
+};
+
+// Non owning typed range of a buffer, element offsets are converted to bytes here only.
+template<typename T>
+struct TypedBufferView
+{
+    static constexpr VkDeviceSize s_stride_ = sizeof(T);
+
+    VkBuffer buffer_ = VK_NULL_HANDLE;
+    VkDeviceSize offset_ = 0;
+    uint32_t count_ = 0;
+
+    VkDeviceSize GetSize() const { return count_ * s_stride_; }
+    // byte offset of element in the buffer
+    VkDeviceSize GetOffset(uint32_t element = 0) const { return offset_ + element * s_stride_; }
+    VkDescriptorBufferInfo DescriptorInfo() const { return VkDescriptorBufferInfo{buffer_, offset_, GetSize()}; }
+
+    // count elements starting at first, within this view
+    TypedBufferView Subview(uint32_t first, uint32_t count) const
+    {
+        if (first > count_ || count > count_ - first)
+        {
+            throw std::out_of_range("Typed buffer view access out of range!");
+        }
+        return TypedBufferView{buffer_, GetOffset(first), count};
+    }
+    // the same range inside the region of buffer starting at region_offset
+    TypedBufferView InRegion(VkBuffer buffer, VkDeviceSize region_offset) const { return TypedBufferView{buffer, region_offset + offset_, count_}; }
+    // the range in a mapped buffer
+    T* GetMappedData(Buffer& buffer) const { return static_cast<T*>(buffer.GetMappedMemory(offset_)); }
+};
+
+// Packs arrays of different element types into one region of a buffer, for buffers holding one
+// region per frame in flight behind a single dynamic offset. Views are relative to the region,
+// TypedBufferView::InRegion places them in a frame's region.
+class TypedBufferLayout
+{
+public:
+    // alignment of the next array: the element's own, or minStorageBufferOffsetAlignment for
+    // arrays bound as descriptors of their own
+    template<typename T>
+    TypedBufferView<T> Add(uint32_t count, VkDeviceSize alignment = alignof(T))
+    {
+        TypedBufferView<T> view{VK_NULL_HANDLE, AlignUp(size_, alignment), count};
+        size_ = view.offset_ + view.GetSize();
+        return view;
+    }
+
+    // region size rounded up to alignment, so consecutive regions keep their arrays aligned
+    VkDeviceSize GetSize(VkDeviceSize alignment = 1) const { return AlignUp(size_, alignment); }
+
+private:
+    static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+private:
+    VkDeviceSize size_ = 0;
+};
+
+// Buffer of count elements of T: the allocation is exactly count * sizeof(T) bytes and every
+// write is a span of T, so element type or size mismatches do not compile or are range checked.
+template<typename T>
+class TypedBuffer : public Buffer
+{
+    static_assert(std::is_trivially_copyable_v<T>, "GPU buffers hold trivially copyable elements");
+
+public:
+    static constexpr VkDeviceSize s_stride_ = sizeof(T);
+
+public:
+    TypedBuffer(Device& device, uint32_t count, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkSharingMode sharing_mode = VK_SHARING_MODE_EXCLUSIVE)
+        : Buffer(device, s_stride_, count, usage, properties, sharing_mode)
+    {}
+
+    // device local buffer holding data, uploaded with the next upload batch
+    TypedBuffer(Device& device, std::span<const T> data, VkBufferUsageFlags usage)
+        : Buffer(device, s_stride_, static_cast<uint32_t>(data.size()), usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+    {
+        Upload(data);
+    }
+
+    uint32_t GetCount() { return GetInstanceCount(); }
+
+    // device local buffers, staged through the upload engine
+    UploadTicket Upload(std::span<const T> data, uint32_t first = 0)
+    {
+        CheckRange(data.size(), first);
+        return GetDevice().GetUploadEngine().UploadBuffer(*this, data.data(), data.size_bytes(), first * s_stride_);
+    }
+
+    // queues the upload of count elements and returns their staging memory, for data converted
+    // while staging. Fill it before the next upload, see UploadEngine::StageUpload
+    T* StageUpload(uint32_t count, uint32_t first = 0)
+    {
+        CheckRange(count, first);
+        return static_cast<T*>(GetDevice().GetUploadEngine().StageUpload(*this, count * s_stride_, first * s_stride_));
+    }
+
+    // host visible buffers, must be mapped
+    void Write(std::span<const T> data, uint32_t first = 0)
+    {
+        CheckRange(data.size(), first);
+        WriteToBuffer(data.data(), data.size_bytes(), first * s_stride_);
+    }
+
+    T* GetMappedData() { return static_cast<T*>(GetMappedMemory()); }
+
+    TypedBufferView<T> View(uint32_t first = 0) { return View(first, GetCount() - first); }
+    TypedBufferView<T> View(uint32_t first, uint32_t count)
+    {
+        CheckRange(count, first);
+        return TypedBufferView<T>{GetBuffer(), first * s_stride_, count};
+    }
+
+private:
+    void CheckRange(size_t count, uint32_t first)
+    {
+        if (first > GetCount() || count > GetCount() - first)
+        {
+            throw std::out_of_range("Typed buffer access out of range!");
+        }
+    }
+};
+
+} // namespace renderer
@@ -0,0 +1,421 @@
+#include <renderer/renderer/upload_engine.hpp>
+
+// std
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+// renderer includes
+#include <renderer/renderer/device.hpp>
+#include <renderer/renderer/buffer.hpp>
+
+namespace renderer {
+
+namespace {
+
+// everything uploaded buffers are read as after the copy
+constexpr VkAccessFlags s_upload_consumer_access = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT
+                                                 | VK_ACCESS_INDEX_READ_BIT
+                                                 | VK_ACCESS_UNIFORM_READ_BIT
+                                                 | VK_ACCESS_SHADER_READ_BIT
+                                                 | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+} // namespace
+
+UploadEngine::UploadEngine(Device& device, VkDeviceSize staging_size)
+    : device_{device}
+    , graphics_family_{device.GetGraphicsFamily()}
+    , transfer_family_{device.GetTransferFamily()}
+    , graphics_queue_{device.GetGraphicsQueue()}
+    , transfer_queue_{device.GetTransferQueue()}
+    , staging_size_{staging_size}
+    , timeline_{device.GetDevice()}
+{
+    CreateCommandPools();
+
+    staging_buffer_ = std::make_unique<Buffer>(device_,
+                                               staging_size_,
+                                               1,
+                                               VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    staging_buffer_->Map();
+
+    std::cout << "Upload engine: " << (HasDedicatedTransferQueue() ? "dedicated transfer queue" : "graphics queue") << std::endl;
+}
+
+UploadEngine::~UploadEngine()
+{
+    Flush();
+    while (!in_flight_.empty())
+    {
+        Retire(true);
+    }
+
+    for (auto& batch : free_batches_)
+    {
+        vkDestroySemaphore(device_.GetDevice(), batch->transfer_done_, nullptr);
+    }
+
+    vkDestroyCommandPool(device_.GetDevice(), transfer_command_pool_, nullptr);
+    if (graphics_command_pool_ != VK_NULL_HANDLE)
+    {
+        vkDestroyCommandPool(device_.GetDevice(), graphics_command_pool_, nullptr);
+    }
+}
+
+UploadTicket UploadEngine::UploadBuffer(Buffer& dst_buffer, const void* data, VkDeviceSize size, VkDeviceSize dst_offset)
+{
+    std::memcpy(StageUpload(dst_buffer, size, dst_offset), data, size);
+    return timeline_.GetPendingValue() + 1;
+}
+
+void* UploadEngine::StageUpload(Buffer& dst_buffer, VkDeviceSize size, VkDeviceSize dst_offset)
+{
+    PendingCopy copy{};
+    copy.dst_buffer_ = dst_buffer.GetBuffer();
+    copy.ownership_transfer_ = !dst_buffer.IsConcurrent();
+    copy.region_.dstOffset = dst_offset;
+    copy.region_.size = size;
+
+    void* staging_memory = nullptr;
+    VkDeviceSize offset = 0;
+    if (size > staging_size_)
+    {
+        // larger than the whole ring, give it its own staging buffer for the lifetime of the batch
+        auto staging = std::make_unique<Buffer>(device_,
+                                                size,
+                                                1,
+                                                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        staging->Map();
+        staging_memory = staging->GetMappedMemory();
+
+        copy.src_buffer_ = staging->GetBuffer();
+        pending_oversized_staging_.push_back(std::move(staging));
+    }
+    else
+    {
+        while (!TryAllocateStaging(size, offset))
+        {
+            // ring is full: submit what is pending and wait for the oldest batch to free its range
+            Flush();
+            Retire(true);
+        }
+
+        staging_memory = staging_buffer_->GetMappedMemory(offset);
+        copy.src_buffer_ = staging_buffer_->GetBuffer();
+        copy.region_.srcOffset = offset;
+    }
+
+    pending_copies_.push_back(copy);
+    return staging_memory;
+}
+
+UploadTicket UploadEngine::Flush()
+{
+    Retire(false);
+
+    if (pending_copies_.empty())
+    {
+        return timeline_.GetPendingValue();
+    }
+
+    Batch& batch = AcquireBatch();
+    batch.ticket_ = timeline_.AdvancePending();
+
+    VkSemaphore timeline_semaphore = timeline_.GetSemaphore();
+
+    VkTimelineSemaphoreSubmitInfo timeline_info{};
+    timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timeline_info.signalSemaphoreValueCount = 1;
+    timeline_info.pSignalSemaphoreValues = &batch.ticket_;
+
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(batch.transfer_command_buffer_, &begin_info);
+    {
+        for (auto& copy : pending_copies_)
+        {
+            vkCmdCopyBuffer(batch.transfer_command_buffer_, copy.src_buffer_, copy.dst_buffer_, 1, &copy.region_);
+        }
+        RecordBarriers(batch.transfer_command_buffer_, true);
+    }
+    vkEndCommandBuffer(batch.transfer_command_buffer_);
+
+    VkSubmitInfo transfer_submit{};
+    transfer_submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    transfer_submit.commandBufferCount = 1;
+    transfer_submit.pCommandBuffers = &batch.transfer_command_buffer_;
+
+    if (HasDedicatedTransferQueue())
+    {
+        // graphics side acquire waits for the copies and signals the ticket for both submissions
+        vkBeginCommandBuffer(batch.graphics_command_buffer_, &begin_info);
+        RecordBarriers(batch.graphics_command_buffer_, false);
+        vkEndCommandBuffer(batch.graphics_command_buffer_);
+
+        transfer_submit.signalSemaphoreCount = 1;
+        transfer_submit.pSignalSemaphores = &batch.transfer_done_;
+
+        if (vkQueueSubmit(transfer_queue_, 1, &transfer_submit, VK_NULL_HANDLE) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to submit upload batch!");
+        }
+
+        VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+        VkSubmitInfo acquire_submit{};
+        acquire_submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        acquire_submit.pNext = &timeline_info;
+        acquire_submit.waitSemaphoreCount = 1;
+        acquire_submit.pWaitSemaphores = &batch.transfer_done_;
+        acquire_submit.pWaitDstStageMask = &wait_stage;
+        acquire_submit.commandBufferCount = 1;
+        acquire_submit.pCommandBuffers = &batch.graphics_command_buffer_;
+        acquire_submit.signalSemaphoreCount = 1;
+        acquire_submit.pSignalSemaphores = &timeline_semaphore;
+
+        if (vkQueueSubmit(graphics_queue_, 1, &acquire_submit, VK_NULL_HANDLE) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to submit upload ownership acquire!");
+        }
+    }
+    else
+    {
+        transfer_submit.pNext = &timeline_info;
+        transfer_submit.signalSemaphoreCount = 1;
+        transfer_submit.pSignalSemaphores = &timeline_semaphore;
+
+        if (vkQueueSubmit(transfer_queue_, 1, &transfer_submit, VK_NULL_HANDLE) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to submit upload batch!");
+        }
+    }
+
+    batch.staging_end_ = head_;
+    batch.oversized_staging_ = std::move(pending_oversized_staging_);
+    pending_oversized_staging_.clear();
+    pending_copies_.clear();
+
+    UploadTicket batch_ticket = batch.ticket_;
+    in_flight_.push_back(std::move(free_batches_.back()));
+    free_batches_.pop_back();
+
+    return batch_ticket;
+}
+
+bool UploadEngine::IsComplete(UploadTicket ticket)
+{
+    return timeline_.IsReached(ticket);
+}
+
+void UploadEngine::Wait(UploadTicket ticket)
+{
+    if (ticket > timeline_.GetPendingValue())
+    {
+        Flush();
+    }
+
+    timeline_.Wait(ticket);
+    Retire(false);
+}
+
+void UploadEngine::CreateCommandPools()
+{
+    VkCommandPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = transfer_family_;
+
+    if (vkCreateCommandPool(device_.GetDevice(), &pool_info, nullptr, &transfer_command_pool_) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create upload command pool!");
+    }
+
+    if (HasDedicatedTransferQueue())
+    {
+        pool_info.queueFamilyIndex = graphics_family_;
+        if (vkCreateCommandPool(device_.GetDevice(), &pool_info, nullptr, &graphics_command_pool_) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create upload command pool!");
+        }
+    }
+}
+
+UploadEngine::Batch& UploadEngine::AcquireBatch()
+{
+    // the acquired batch stays at the back of free_batches_ until Flush moves it in flight
+    if (!free_batches_.empty())
+    {
+        Batch& batch = *free_batches_.back();
+        vkResetCommandBuffer(batch.transfer_command_buffer_, 0);
+        if (batch.graphics_command_buffer_ != VK_NULL_HANDLE)
+        {
+            vkResetCommandBuffer(batch.graphics_command_buffer_, 0);
+        }
+        return batch;
+    }
+
+    auto batch = std::make_unique<Batch>();
+
+    VkCommandBufferAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = 1;
+    alloc_info.commandPool = transfer_command_pool_;
+
+    if (vkAllocateCommandBuffers(device_.GetDevice(), &alloc_info, &batch->transfer_command_buffer_) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate upload command buffer!");
+    }
+
+    if (HasDedicatedTransferQueue())
+    {
+        alloc_info.commandPool = graphics_command_pool_;
+        if (vkAllocateCommandBuffers(device_.GetDevice(), &alloc_info, &batch->graphics_command_buffer_) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to allocate upload command buffer!");
+        }
+
+        VkSemaphoreCreateInfo semaphore_info{};
+        semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        if (vkCreateSemaphore(device_.GetDevice(), &semaphore_info, nullptr, &batch->transfer_done_) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create upload semaphore!");
+        }
+    }
+
+    free_batches_.push_back(std::move(batch));
+    return *free_batches_.back();
+}
+
+void UploadEngine::RecordBarriers(VkCommandBuffer command_buffer, bool release)
+{
+    // Same queue: the copies precede every later read in submission order. Dedicated transfer
+    // queue: the acquire batch waits for the copies with a semaphore, which only orders the
+    // batch's own commands, so the barrier extends that to every later graphics submission.
+    // Concurrent buffers rely on it alone
+    VkMemoryBarrier memory_barrier{};
+    memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    memory_barrier.dstAccessMask = s_upload_consumer_access;
+    uint32_t memory_barrier_count = release ? 0 : 1;
+
+    if (!HasDedicatedTransferQueue())
+    {
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0,
+                             1, &memory_barrier,
+                             0, nullptr,
+                             0, nullptr);
+        return;
+    }
+
+    // queue family ownership transfer of the copied ranges of exclusive buffers: the release on
+    // the transfer queue and the acquire on the graphics queue use identical barriers
+    std::vector<VkBufferMemoryBarrier> barriers;
+    barriers.reserve(pending_copies_.size());
+    for (auto& copy : pending_copies_)
+    {
+        if (!copy.ownership_transfer_)
+        {
+            continue;
+        }
+
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = release ? VK_ACCESS_TRANSFER_WRITE_BIT : 0;
+        barrier.dstAccessMask = release ? 0 : s_upload_consumer_access;
+        barrier.srcQueueFamilyIndex = transfer_family_;
+        barrier.dstQueueFamilyIndex = graphics_family_;
+        barrier.buffer = copy.dst_buffer_;
+        barrier.offset = copy.region_.dstOffset;
+        barrier.size = copy.region_.size;
+        barriers.push_back(barrier);
+    }
+    if (barriers.empty() && memory_barrier_count == 0)
+    {
+        return;
+    }
+
+    // the acquire's source stage chains with the semaphore wait (VK_PIPELINE_STAGE_ALL_COMMANDS_BIT)
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         release ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         0,
+                         memory_barrier_count, &memory_barrier,
+                         static_cast<uint32_t>(barriers.size()), barriers.data(),
+                         0, nullptr);
+}
+
+bool UploadEngine::TryAllocateStaging(VkDeviceSize size, VkDeviceSize& offset)
+{
+    size = (size + s_staging_alignment_ - 1) / s_staging_alignment_ * s_staging_alignment_;
+
+    bool empty = pending_copies_.empty() && in_flight_.empty();
+    if (empty)
+    {
+        head_ = 0;
+        tail_ = 0;
+    }
+
+    if (empty || head_ > tail_)
+    {
+        // free space is [head_, end) and [0, tail_)
+        if (head_ + size <= staging_size_)
+        {
+            offset = head_;
+            head_ += size;
+            return true;
+        }
+
+        if (size <= tail_)
+        {
+            offset = 0;
+            head_ = size;
+            return true;
+        }
+
+        return false;
+    }
+
+    // wrapped around (or full when head_ == tail_): free space is [head_, tail_)
+    if (head_ + size <= tail_)
+    {
+        offset = head_;
+        head_ += size;
+        return true;
+    }
+
+    return false;
+}
+
+void UploadEngine::Retire(bool wait)
+{
+    while (!in_flight_.empty())
+    {
+        Batch& batch = *in_flight_.front();
+
+        if (wait)
+        {
+            timeline_.Wait(batch.ticket_);
+            wait = false;
+        }
+        else if (!timeline_.IsReached(batch.ticket_))
+        {
+            break;
+        }
+
+        tail_ = batch.staging_end_;
+        batch.oversized_staging_.clear();
+
+        free_batches_.push_back(std::move(in_flight_.front()));
+        in_flight_.pop_front();
+    }
+}
+
+} // namespace renderer
@@ -0,0 +1,123 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+// vulkan
+#include <vulkan/vulkan.h>
+
+// renderer includes
+#include <renderer/renderer/timeline_semaphore.hpp>
+
+namespace renderer {
+
+class Device;
+class Buffer;
+
+// upload timeline value signaled once a flushed batch completed
+using UploadTicket = uint64_t;
+
+// Batches buffer uploads through a reusable staging ring. Uploads are copied into staging memory
+// right away and recorded as pending copy regions; Flush submits every pending copy at once
+// (the renderer flushes once per frame, ahead of the frame's own submit). On devices with a
+// dedicated transfer family the copies run there and the copied ranges of exclusive buffers are
+// released to the graphics family. Ownership never goes back, so an exclusive buffer takes one
+// upload per range; buffers uploaded into over and over (GeometryArena) are created with
+// VK_SHARING_MODE_CONCURRENT and need no transfer, only the acquire batch's memory barrier.
+// Tickets are values of the engine's own timeline semaphore, so completion is a counter check or
+// a vkWaitSemaphores, never an idle wait.
+class UploadEngine
+{
+public:
+    static constexpr VkDeviceSize s_default_staging_size_ = 32 * 1024 * 1024;
+
+public:
+    UploadEngine(Device& device, VkDeviceSize staging_size = s_default_staging_size_);
+    ~UploadEngine();
+
+    UploadEngine(const UploadEngine&) = delete;
+    UploadEngine& operator=(const UploadEngine&) = delete;
+
+    // Copies data to staging memory and queues a copy into dst_buffer.
+    // Returns the ticket of the batch the copy will be submitted with.
+    UploadTicket UploadBuffer(Buffer& dst_buffer, const void* data, VkDeviceSize size, VkDeviceSize dst_offset = 0);
+    // Queues a copy of size bytes into dst_buffer and returns the staging memory to fill, for
+    // data converted on the way. Write it before the next call into the engine, which may flush
+    void* StageUpload(Buffer& dst_buffer, VkDeviceSize size, VkDeviceSize dst_offset = 0);
+
+    // submits all pending copies in one batch and returns its ticket
+    UploadTicket Flush();
+
+    bool IsComplete(UploadTicket ticket);
+    // flushes if needed and blocks until the batch of ticket finished on the GPU
+    void Wait(UploadTicket ticket);
+
+    bool HasDedicatedTransferQueue() { return transfer_family_ != graphics_family_; }
+
+private:
+    struct PendingCopy
+    {
+        VkBuffer src_buffer_;
+        VkBuffer dst_buffer_;
+        VkBufferCopy region_;
+        // exclusive destinations change queue family ownership
+        bool ownership_transfer_;
+    };
+
+    struct Batch
+    {
+        VkCommandBuffer transfer_command_buffer_ = VK_NULL_HANDLE;
+        // acquires ownership on the graphics family, only used with a dedicated transfer queue
+        VkCommandBuffer graphics_command_buffer_ = VK_NULL_HANDLE;
+        VkSemaphore transfer_done_ = VK_NULL_HANDLE;
+
+        UploadTicket ticket_ = 0;
+        // staging ring head at submission, the ring tail moves here once the batch retires
+        VkDeviceSize staging_end_ = 0;
+        // staging buffers for uploads larger than the ring
+        std::vector<std::unique_ptr<Buffer>> oversized_staging_;
+    };
+
+private:
+    void CreateCommandPools();
+    Batch& AcquireBatch();
+    void RecordBarriers(VkCommandBuffer command_buffer, bool release);
+
+    bool TryAllocateStaging(VkDeviceSize size, VkDeviceSize& offset);
+    // retires finished batches in submission order, wait forces the oldest one to finish
+    void Retire(bool wait);
+
+private:
+    static constexpr VkDeviceSize s_staging_alignment_ = 16;
+
+    Device& device_;
+
+    uint32_t graphics_family_;
+    uint32_t transfer_family_;
+    VkQueue graphics_queue_;
+    VkQueue transfer_queue_;
+
+    VkCommandPool transfer_command_pool_ = VK_NULL_HANDLE;
+    VkCommandPool graphics_command_pool_ = VK_NULL_HANDLE;
+
+    // staging ring, [tail_, head_) holds data of pending and in flight copies
+    std::unique_ptr<Buffer> staging_buffer_;
+    VkDeviceSize staging_size_;
+    VkDeviceSize head_ = 0;
+    VkDeviceSize tail_ = 0;
+
+    std::vector<PendingCopy> pending_copies_;
+    std::vector<std::unique_ptr<Buffer>> pending_oversized_staging_;
+
+    // batches in submission order, and retired ones kept for reuse
+    std::deque<std::unique_ptr<Batch>> in_flight_;
+    std::vector<std::unique_ptr<Batch>> free_batches_;
+
+    // signaled with the batch ticket by the last submission of each batch
+    TimelineSemaphore timeline_;
+};
+
+} // namespace renderer
@@ -7,17 +7,44 @@
 
 namespace renderer {
 
-VertexBuffer::VertexBuffer(Device& device, std::vector<Vertex> vertices, std::vector<uint16_t> indices)
+VertexBuffer::VertexBuffer(Device& device, const void* vertices, size_t vertex_size, size_t vertex_count, const std::vector<uint32_t>& indices)
     : device_{device}
 {
-    CreateVertexBuffer(std::move(vertices));
+    CreateVertexBuffer(vertices, vertex_size, vertex_count);
+    InitIndices(vertex_count, indices);
+}
+
+VertexBuffer::VertexBuffer(Device& device,
+                           std::span<const std::byte> vertices,
+                           size_t vertex_size,
+                           std::span<const std::byte> indices,
+                           VkIndexType index_type)
+    : device_{device}
+{
+    CreateVertexBuffer(vertices.data(), vertex_size, vertices.size() / vertex_size);
+    vertex_buffer_size_ = vertex_buffer_->GetInstanceCount();
+
+    if (!indices.empty())
+    {
+        size_t index_size = index_type == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+        has_indices_ = true;
+        index_type_ = index_type;
+        index_buffer_ = std::make_unique<Buffer>(device_, index_size, indices.size() / index_size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        device_.GetUploadEngine().UploadBuffer(*index_buffer_, indices.data(), indices.size());
+        index_buffer_size_ = index_buffer_->GetInstanceCount();
+    }
+}
+
+void VertexBuffer::InitIndices(size_t vertex_count, const std::vector<uint32_t>& indices)
+{
     vertex_buffer_size_ = vertex_buffer_->GetInstanceCount();
 
     if (!indices.empty())
     {
         has_indices_ = true;
-        index_buffer_size_ = indices.size();
-        CreateIndexBuffer(std::move(indices));
+        index_type_ = SelectIndexType(vertex_count);
+        CreateIndexBuffer(indices);
         index_buffer_size_ = index_buffer_->GetInstanceCount();
     }
 }
@@ -26,7 +53,7 @@ VertexBuffer::~VertexBuffer()
 {
 }
 
-void VertexBuffer::DrawBuffer(VkCommandBuffer command_buffer)
+void VertexBuffer::DrawBuffer(VkCommandBuffer command_buffer, uint32_t instance_count)
 {
     VkBuffer vertex_buffers[] = {vertex_buffer_->GetBuffer()};
     VkDeviceSize offsets[] = {0};
@@ -35,52 +62,38 @@ void VertexBuffer::DrawBuffer(VkCommandBuffer command_buffer)
 
     if (has_indices_)
     {
-        vkCmdBindIndexBuffer(command_buffer, index_buffer_->GetBuffer(), 0, VK_INDEX_TYPE_UINT16);
-        vkCmdDrawIndexed(command_buffer, static_cast<uint32_t>(index_buffer_size_), 1, 0, 0, 0);
+        vkCmdBindIndexBuffer(command_buffer, index_buffer_->GetBuffer(), 0, index_type_);
+        vkCmdDrawIndexed(command_buffer, static_cast<uint32_t>(index_buffer_size_), instance_count, 0, 0, 0);
     }
     else
     {
-        vkCmdDraw(command_buffer, static_cast<uint32_t>(vertex_buffer_size_), 1, 0, 0);
+        vkCmdDraw(command_buffer, static_cast<uint32_t>(vertex_buffer_size_), instance_count, 0, 0);
     }
 }
 
 
-void VertexBuffer::CreateVertexBuffer(std::vector<Vertex> vertices)
+void VertexBuffer::CreateVertexBuffer(const void* vertices, size_t vertex_size, size_t vertex_count)
 {
-    VkDeviceSize buffer_size = sizeof(std::vector<Vertex>::value_type) * vertices.size();   
-    
-    // Staging buffer setup
-    auto staging_buffer = std::make_unique<Buffer>(device_, sizeof(Vertex), vertices.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    
-    // copying vertices data into stagin data buffer
-    staging_buffer->Map();
-    staging_buffer->WriteToBuffer(vertices.data());
-    staging_buffer->Unmap();
+    VkDeviceSize buffer_size = vertex_size * vertex_count;
 
     // creating device local vertex buffer
-    vertex_buffer_ = std::make_unique<Buffer>(device_, sizeof(Vertex), vertices.size(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    vertex_buffer_ = std::make_unique<Buffer>(device_, vertex_size, vertex_count, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-// copying from host visible to visible only for device memory
-    device_.CopyBuffer(staging_buffer->GetBuffer(), vertex_buffer_->GetBuffer(), buffer_size);
+    // staged now, copied with the next upload batch before the frame using it is submitted
+    device_.GetUploadEngine().UploadBuffer(*vertex_buffer_, vertices, buffer_size);
 }
 
-void VertexBuffer::CreateIndexBuffer(std::vector<uint16_t> indices)
+void VertexBuffer::CreateIndexBuffer(const std::vector<uint32_t>& indices)
 {
-    VkDeviceSize buffer_size = sizeof(std::vector<uint16_t>::value_type) * indices.size();
-
-    // Staging buffer step
-    auto staging_buffer = std::make_unique<Buffer>(device_, sizeof(Vertex), indices.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    // copying vertices data into stagin data buffer
-    staging_buffer->Map();
-    staging_buffer->WriteToBuffer(indices.data());
-    staging_buffer->Unmap();
-
-    // createing device local index buffer
-    index_buffer_ = std::make_unique<Buffer>(device_, sizeof(Vertex), indices.size(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (index_type_ == IndexTraits<uint32_t>::s_index_type_)
+    {
+        index_buffer_ = std::make_unique<TypedBuffer<uint32_t>>(device_, std::span<const uint32_t>(indices), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+        return;
+    }
 
-    // copying from host visible to visible only for device memory
-    device_.CopyBuffer(staging_buffer->GetBuffer(), index_buffer_->GetBuffer(), buffer_size);
+    // halves index bandwidth and memory, every index fits since the vertex count does
+    std::vector<uint16_t> narrow_indices(indices.begin(), indices.end());
+    index_buffer_ = std::make_unique<TypedBuffer<uint16_t>>(device_, std::span<const uint16_t>(narrow_indices), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
 }
 
 } // namespace renderer
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 // std
 #include <array>
+#include <cstddef>
+#include <span>
 #include <memory>
 #include <vector>
 
@@ -15,6 +17,8 @@
 // renderer includes
 #include <renderer/renderer/device.hpp>
 #include <renderer/renderer/buffer.hpp>
+#include <renderer/renderer/typed_buffer.hpp>
+#include <renderer/renderer/vertex_layout.hpp>
 
 
 namespace renderer {
@@ -23,46 +27,98 @@ struct Vertex
 {
     glm::vec3 pos_;
     glm::vec3 col_;
+};
 
-    static VkVertexInputBindingDescription GetBindingDescription()
-    {
-        VkVertexInputBindingDescription binding_description{};
-        binding_description.binding = 0;
-        binding_description.stride = sizeof(Vertex);
-        binding_description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+template<>
+struct VertexAttributes<Vertex>
+{
+    static constexpr std::array s_attributes_ = {
+        RENDERER_VERTEX_ATTRIBUTE(Vertex, pos_),
+        RENDERER_VERTEX_ATTRIBUTE(Vertex, col_),
+    };
+};
 
-        return binding_description;
-    }
+// position only, for depth and shadow passes
+struct PositionVertex
+{
+    glm::vec3 pos_;
+};
 
-    static std::array<VkVertexInputAttributeDescription, 2> GetAttributeDescriptions()
-    {
-        std::array<VkVertexInputAttributeDescription, 2> attribute_descriptions{};
-        attribute_descriptions[0].binding = 0;
-        attribute_descriptions[0].location = 0;
-        attribute_descriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-        attribute_descriptions[0].offset = offsetof(Vertex, pos_);
-
-        attribute_descriptions[1].binding = 0;
-        attribute_descriptions[1].location = 1;
-        attribute_descriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-        attribute_descriptions[1].offset = offsetof(Vertex, col_);
-
-        return attribute_descriptions;
-    }
+template<>
+struct VertexAttributes<PositionVertex>
+{
+    static constexpr std::array s_attributes_ = {
+        RENDERER_VERTEX_ATTRIBUTE(PositionVertex, pos_),
+    };
 };
 
+// per instance stream of instanced draws, see InstancedVertexLayout
+struct InstanceData
+{
+    glm::mat4 model_;
+    glm::vec4 color_;
+    // not read by the built-in shaders yet, reserved for material tables
+    uint32_t material_index_;
+};
 
+template<>
+struct VertexAttributes<InstanceData>
+{
+    static constexpr std::array s_attributes_ = {
+        RENDERER_VERTEX_ATTRIBUTE(InstanceData, model_),
+        RENDERER_VERTEX_ATTRIBUTE(InstanceData, color_),
+        RENDERER_VERTEX_ATTRIBUTE(InstanceData, material_index_),
+    };
+};
+
+using DefaultVertexLayout = VertexInputLayout<VertexBinding<Vertex>>;
+// Vertex at binding 0 (locations 0-1), InstanceData at binding 1 (locations 2-7, shaders/instanced.vert)
+using InstancedVertexLayout = VertexInputLayout<VertexBinding<Vertex>, InstanceBinding<InstanceData>>;
+static constexpr uint32_t s_instance_binding_ = 1;
+
+
+// Device local vertex buffer plus optional index buffer for any vertex type. Indices are passed
+// as 32-bit and stored as 16-bit whenever every vertex is addressable with them.
 class VertexBuffer
 {
 public:
-    VertexBuffer(Device& device, std::vector<Vertex> vertices, std::vector<uint16_t> indices = {});
+    template<typename V>
+    VertexBuffer(Device& device, const std::vector<V>& vertices, const std::vector<uint32_t>& indices = {})
+        : device_{device}
+    {
+        vertex_buffer_ = std::make_unique<TypedBuffer<V>>(device_, std::span<const V>(vertices), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        InitIndices(vertices.size(), indices);
+    }
+    // vertex_size bytes per vertex, of any layout
+    VertexBuffer(Device& device, const void* vertices, size_t vertex_size, size_t vertex_count, const std::vector<uint32_t>& indices = {});
+    // GPU ready streams, e.g. mapped from a mesh file: both are copied straight into staging memory
+    VertexBuffer(Device& device,
+                 std::span<const std::byte> vertices,
+                 size_t vertex_size,
+                 std::span<const std::byte> indices,
+                 VkIndexType index_type);
     ~VertexBuffer();
 
-    void DrawBuffer(VkCommandBuffer command_buffer);
+    static VkIndexType SelectIndexType(size_t vertex_count)
+    {
+        return vertex_count <= s_max_uint16_vertices_ ? IndexTraits<uint16_t>::s_index_type_ : IndexTraits<uint32_t>::s_index_type_;
+    }
+
+    void DrawBuffer(VkCommandBuffer command_buffer, uint32_t instance_count = 1);
+
+    VkBuffer GetVertexBuffer() { return vertex_buffer_->GetBuffer(); }
+    // VK_NULL_HANDLE for non indexed meshes
+    VkBuffer GetIndexBuffer() { return has_indices_ ? index_buffer_->GetBuffer() : VK_NULL_HANDLE; }
+    VkIndexType GetIndexType() { return index_type_; }
+    uint32_t GetVertexCount() { return static_cast<uint32_t>(vertex_buffer_size_); }
+    uint32_t GetIndexCount() { return static_cast<uint32_t>(index_buffer_size_); }
 
 private:
-    void CreateVertexBuffer(std::vector<Vertex> vertices);
-    void CreateIndexBuffer(std::vector<uint16_t> indices);
+    void CreateVertexBuffer(const void* vertices, size_t vertex_size, size_t vertex_count);
+    void InitIndices(size_t vertex_count, const std::vector<uint32_t>& indices);
+    void CreateIndexBuffer(const std::vector<uint32_t>& indices);
+
+    static constexpr size_t s_max_uint16_vertices_ = 1u << 16;
 
 private:
     Device& device_;
@@ -71,6 +127,7 @@ private:
     size_t vertex_buffer_size_{0};
 
     bool has_indices_ = false;
+    VkIndexType index_type_ = VK_INDEX_TYPE_UINT16;
     std::unique_ptr<Buffer> index_buffer_ = nullptr;
     size_t index_buffer_size_{0};
 };
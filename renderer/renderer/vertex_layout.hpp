@@ -0,0 +1,205 @@
+#pragma once
+
+// std
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// vulkan
+#include <vulkan/vulkan.h>
+
+// glm
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+namespace renderer {
+
+// Packed attribute storage. Distinct types, so the same bits can map to normalized or float formats.
+struct Unorm8x4
+{
+    uint8_t x_, y_, z_, w_;
+};
+
+struct Unorm16x4
+{
+    uint16_t x_, y_, z_, w_;
+};
+
+struct Snorm16x2
+{
+    int16_t x_, y_;
+};
+
+struct Half2
+{
+    uint16_t x_, y_;
+};
+
+struct Half4
+{
+    uint16_t x_, y_, z_, w_;
+};
+
+// Maps a C++ attribute type to its vertex input format. Types wider than one location
+// (matrices) occupy location_count_ consecutive locations, location_stride_ bytes apart.
+template<typename T>
+struct VertexFormat;
+
+#define RENDERER_VERTEX_FORMAT(type, format)                            \
+    template<>                                                          \
+    struct VertexFormat<type>                                           \
+    {                                                                   \
+        static constexpr VkFormat s_format_ = format;                   \
+        static constexpr uint32_t s_location_count_ = 1;                \
+        static constexpr uint32_t s_location_stride_ = 0;               \
+    };
+
+RENDERER_VERTEX_FORMAT(float, VK_FORMAT_R32_SFLOAT)
+RENDERER_VERTEX_FORMAT(glm::vec2, VK_FORMAT_R32G32_SFLOAT)
+RENDERER_VERTEX_FORMAT(glm::vec3, VK_FORMAT_R32G32B32_SFLOAT)
+RENDERER_VERTEX_FORMAT(glm::vec4, VK_FORMAT_R32G32B32A32_SFLOAT)
+RENDERER_VERTEX_FORMAT(uint32_t, VK_FORMAT_R32_UINT)
+RENDERER_VERTEX_FORMAT(glm::uvec2, VK_FORMAT_R32G32_UINT)
+RENDERER_VERTEX_FORMAT(glm::uvec3, VK_FORMAT_R32G32B32_UINT)
+RENDERER_VERTEX_FORMAT(glm::uvec4, VK_FORMAT_R32G32B32A32_UINT)
+RENDERER_VERTEX_FORMAT(int32_t, VK_FORMAT_R32_SINT)
+RENDERER_VERTEX_FORMAT(glm::ivec2, VK_FORMAT_R32G32_SINT)
+RENDERER_VERTEX_FORMAT(glm::ivec3, VK_FORMAT_R32G32B32_SINT)
+RENDERER_VERTEX_FORMAT(glm::ivec4, VK_FORMAT_R32G32B32A32_SINT)
+RENDERER_VERTEX_FORMAT(Unorm8x4, VK_FORMAT_R8G8B8A8_UNORM)
+RENDERER_VERTEX_FORMAT(Unorm16x4, VK_FORMAT_R16G16B16A16_UNORM)
+RENDERER_VERTEX_FORMAT(Snorm16x2, VK_FORMAT_R16G16_SNORM)
+RENDERER_VERTEX_FORMAT(Half2, VK_FORMAT_R16G16_SFLOAT)
+RENDERER_VERTEX_FORMAT(Half4, VK_FORMAT_R16G16B16A16_SFLOAT)
+
+#undef RENDERER_VERTEX_FORMAT
+
+template<>
+struct VertexFormat<glm::mat4>
+{
+    static constexpr VkFormat s_format_ = VK_FORMAT_R32G32B32A32_SFLOAT;
+    static constexpr uint32_t s_location_count_ = 4;
+    static constexpr uint32_t s_location_stride_ = sizeof(glm::vec4);
+};
+
+struct VertexAttribute
+{
+    VkFormat format_;
+    uint32_t offset_;
+    uint32_t location_count_;
+    uint32_t location_stride_;
+};
+
+// Describes one member of a vertex type, format and offset are deduced from the declaration:
+//     template<> struct VertexAttributes<MyVertex>
+//     {
+//         static constexpr std::array s_attributes_ = {
+//             RENDERER_VERTEX_ATTRIBUTE(MyVertex, pos_),
+//             RENDERER_VERTEX_ATTRIBUTE(MyVertex, uv_),
+//         };
+//     };
+#define RENDERER_VERTEX_ATTRIBUTE(vertex, member)                                              \
+    ::renderer::VertexAttribute{                                                               \
+        ::renderer::VertexFormat<decltype(vertex::member)>::s_format_,                         \
+        static_cast<uint32_t>(offsetof(vertex, member)),                                       \
+        ::renderer::VertexFormat<decltype(vertex::member)>::s_location_count_,                 \
+        ::renderer::VertexFormat<decltype(vertex::member)>::s_location_stride_}
+
+// Specialized next to every vertex type with the attributes it feeds to shaders, in location order.
+template<typename Vertex>
+struct VertexAttributes;
+
+// One vertex buffer binding: a vertex type stepped per vertex or per instance.
+template<typename Vertex, VkVertexInputRate InputRate = VK_VERTEX_INPUT_RATE_VERTEX>
+struct VertexBinding
+{
+    using VertexType = Vertex;
+
+    static constexpr VkVertexInputRate s_input_rate_ = InputRate;
+    static constexpr uint32_t s_stride_ = sizeof(Vertex);
+
+    static constexpr uint32_t GetLocationCount()
+    {
+        uint32_t count = 0;
+        for (const VertexAttribute& attribute : VertexAttributes<Vertex>::s_attributes_)
+        {
+            count += attribute.location_count_;
+        }
+        return count;
+    }
+};
+
+template<typename Vertex>
+using InstanceBinding = VertexBinding<Vertex, VK_VERTEX_INPUT_RATE_INSTANCE>;
+
+// Runtime form of a vertex input layout, what Pipeline consumes.
+struct VertexInputDescription
+{
+    std::vector<VkVertexInputBindingDescription> bindings_;
+    std::vector<VkVertexInputAttributeDescription> attributes_;
+};
+
+// Vertex input layout over one or more bindings. Binding numbers follow the order of the
+// bindings, shader locations are assigned consecutively across all of them.
+// The description arrays are built at compile time.
+template<typename... Bindings>
+class VertexInputLayout
+{
+public:
+    static constexpr uint32_t s_binding_count_ = sizeof...(Bindings);
+    static constexpr uint32_t s_location_count_ = (0 + ... + Bindings::GetLocationCount());
+
+    static constexpr std::array<VkVertexInputBindingDescription, s_binding_count_> GetBindingDescriptions()
+    {
+        std::array<VkVertexInputBindingDescription, s_binding_count_> descriptions{};
+
+        uint32_t binding = 0;
+        ((descriptions[binding] = VkVertexInputBindingDescription{binding, Bindings::s_stride_, Bindings::s_input_rate_}, ++binding), ...);
+
+        return descriptions;
+    }
+
+    static constexpr std::array<VkVertexInputAttributeDescription, s_location_count_> GetAttributeDescriptions()
+    {
+        std::array<VkVertexInputAttributeDescription, s_location_count_> descriptions{};
+
+        uint32_t binding = 0;
+        uint32_t location = 0;
+        (AppendAttributes<typename Bindings::VertexType>(descriptions, binding++, location), ...);
+
+        return descriptions;
+    }
+
+    static VertexInputDescription GetDescription()
+    {
+        constexpr auto bindings = GetBindingDescriptions();
+        constexpr auto attributes = GetAttributeDescriptions();
+
+        return VertexInputDescription{
+            std::vector<VkVertexInputBindingDescription>(bindings.begin(), bindings.end()),
+            std::vector<VkVertexInputAttributeDescription>(attributes.begin(), attributes.end())};
+    }
+
+private:
+    template<typename Vertex>
+    static constexpr void AppendAttributes(std::array<VkVertexInputAttributeDescription, s_location_count_>& descriptions,
+                                           uint32_t binding,
+                                           uint32_t& location)
+    {
+        for (const VertexAttribute& attribute : VertexAttributes<Vertex>::s_attributes_)
+        {
+            for (uint32_t i = 0; i < attribute.location_count_; ++i)
+            {
+                descriptions[location] = VkVertexInputAttributeDescription{
+                    location,
+                    binding,
+                    attribute.format_,
+                    attribute.offset_ + i * attribute.location_stride_};
+                ++location;
+            }
+        }
+    }
+};
+
+} // namespace renderer
@@ -0,0 +1,33 @@
+#version 450
+
+layout(binding = 0) uniform UniformBuffer
+{
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// DrawData, one entry per indirect command
+struct DrawData
+{
+    mat4 model;
+    vec4 color;
+};
+
+layout(std430, binding = 1) readonly buffer DrawDataBuffer
+{
+    DrawData draws[];
+};
+
+layout(location = 0) in vec3 Position;
+layout(location = 1) in vec3 Color;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    // every command's firstInstance is its draw index, instanceCount is 1
+    DrawData draw = draws[gl_InstanceIndex];
+
+    gl_Position = ubo.proj * ubo.view * draw.model * vec4(Position, 1.0);
+    fragColor = Color * draw.color.rgb;
+}
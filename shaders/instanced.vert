@@ -0,0 +1,23 @@
+#version 450
+
+layout(binding = 0) uniform UniformBuffer
+{
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+layout(location = 0) in vec3 Position;
+layout(location = 1) in vec3 Color;
+
+// per instance (InstanceData), the model matrix takes locations 2-5
+layout(location = 2) in mat4 InstanceModel;
+layout(location = 6) in vec4 InstanceColor;
+layout(location = 7) in uint InstanceMaterial;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    gl_Position = ubo.proj * ubo.view * InstanceModel * vec4(Position, 1.0);
+    fragColor = Color * InstanceColor.rgb;
+}
@@ -0,0 +1,43 @@
+#version 450
+
+layout(binding = 0) uniform UniformBuffer
+{
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// object space position = offset + normalized position * scale
+layout(push_constant) uniform Dequantization
+{
+    vec4 positionOffset;
+    vec4 positionScale;
+} dequant;
+
+layout(location = 0) in vec4 Position;   // R16G16B16A16_UNORM, w: bitangent sign
+layout(location = 1) in vec2 Normal;     // R16G16_SNORM, octahedral
+layout(location = 2) in vec2 Tangent;    // R16G16_SNORM, octahedral
+layout(location = 3) in vec2 TexCoord;   // R16G16_SFLOAT
+layout(location = 4) in vec4 Color;      // R8G8B8A8_UNORM
+
+layout(location = 0) out vec3 fragColor;
+
+vec3 DecodeOctahedral(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+void main() {
+    vec3 position = dequant.positionOffset.xyz + Position.xyz * dequant.positionScale.xyz;
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(position, 1.0);
+
+    // simple headlight so the decoded normals are visible
+    vec3 normal = normalize(mat3(ubo.view * ubo.model) * DecodeOctahedral(Normal));
+    float lighting = 0.35 + 0.65 * max(normal.z, 0.0);
+
+    fragColor = Color.rgb * lighting;
+}
@@ -0,0 +1,138 @@
+#include <tools/asset_cooker/cook_manifest.hpp>
+
+// std
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+// renderer includes
+#include <renderer/renderer/mapped_file.hpp>
+
+namespace cooker {
+
+namespace {
+
+constexpr const char* s_manifest_header = "# asset_cooker manifest 1";
+
+} // namespace
+
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed)
+{
+    // MurmurHash64A
+    constexpr uint64_t m = 0xc6a4a7935bd1e995ull;
+    constexpr int r = 47;
+
+    auto mix = [](uint64_t k)
+    {
+        k *= m;
+        k ^= k >> r;
+        return k * m;
+    };
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed ^ (size * m);
+
+    size_t word_count = size / 8;
+    for (size_t i = 0; i < word_count; ++i)
+    {
+        uint64_t k;
+        std::memcpy(&k, bytes + i * 8, 8);
+        hash ^= mix(k);
+        hash *= m;
+    }
+
+    size_t tail = size % 8;
+    if (tail != 0)
+    {
+        uint64_t k = 0;
+        std::memcpy(&k, bytes + word_count * 8, tail);
+        hash ^= k;
+        hash *= m;
+    }
+
+    hash ^= hash >> r;
+    hash *= m;
+    hash ^= hash >> r;
+    return hash;
+}
+
+uint64_t HashFile(const std::string& path, uint64_t seed)
+{
+    renderer::MappedFile file(path);
+    return HashBytes(file.GetData(), file.GetSize(), seed);
+}
+
+CookManifest::CookManifest(const std::string& path)
+    : path_{path}
+{
+    std::ifstream input(path);
+    if (!input)
+    {
+        // first cook
+        return;
+    }
+
+    std::string line;
+    if (!std::getline(input, line) || line != s_manifest_header)
+    {
+        // unknown layout, everything is re-cooked
+        return;
+    }
+
+    while (std::getline(input, line))
+    {
+        size_t first_tab = line.find('\t');
+        size_t second_tab = line.find('\t', first_tab + 1);
+        if (first_tab == std::string::npos || second_tab == std::string::npos)
+        {
+            continue;
+        }
+
+        Entry entry{};
+        entry.key_ = std::strtoull(line.substr(0, first_tab).c_str(), nullptr, 16);
+        entry.source_ = line.substr(second_tab + 1);
+        entries_[line.substr(first_tab + 1, second_tab - first_tab - 1)] = std::move(entry);
+    }
+}
+
+bool CookManifest::IsUpToDate(const std::string& output, uint64_t key) const
+{
+    auto it = entries_.find(output);
+    return it != entries_.end() && it->second.key_ == key && std::filesystem::exists(output);
+}
+
+void CookManifest::Update(const std::string& output, uint64_t key, const std::string& source)
+{
+    entries_[output] = Entry{key, source};
+}
+
+void CookManifest::Save() const
+{
+    std::string temporary_path = path_ + ".tmp";
+    {
+        std::ofstream output(temporary_path, std::ios::trunc);
+        if (!output)
+        {
+            throw std::runtime_error("Failed to write manifest: " + temporary_path);
+        }
+
+        output << s_manifest_header << '\n';
+        for (const auto& [path, entry] : entries_)
+        {
+            char key[17];
+            std::snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(entry.key_));
+            output << key << '\t' << path << '\t' << entry.source_ << '\n';
+        }
+
+        if (!output)
+        {
+            throw std::runtime_error("Failed to write manifest: " + temporary_path);
+        }
+    }
+
+    std::filesystem::rename(temporary_path, path_);
+}
+
+} // namespace cooker
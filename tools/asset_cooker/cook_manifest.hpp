@@ -0,0 +1,40 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace cooker {
+
+// 64-bit content hash, only used to detect changed inputs
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0);
+uint64_t HashFile(const std::string& path, uint64_t seed = 0);
+
+// Output path -> key of the inputs it was cooked from. The key covers the source file, the
+// files it references and the cook settings, so an unchanged key means an up to date output.
+class CookManifest
+{
+public:
+    CookManifest(const std::string& path);
+
+    bool IsUpToDate(const std::string& output, uint64_t key) const;
+    void Update(const std::string& output, uint64_t key, const std::string& source);
+
+    // written to a temporary file and renamed, an interrupted cook leaves the old manifest
+    void Save() const;
+
+private:
+    struct Entry
+    {
+        uint64_t key_;
+        std::string source_;
+    };
+
+private:
+    std::string path_;
+    std::map<std::string, Entry> entries_;
+};
+
+} // namespace cooker
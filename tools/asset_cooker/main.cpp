@@ -0,0 +1,322 @@
+// Offline mesh cooker: imports .obj/.gltf/.glb sources and writes .rmesh files the engine
+// maps at startup. Only sources whose content or cook settings changed are re-cooked.
+//
+//     asset_cooker [options] -o <output dir> <source file or directory>...
+//
+//     --format standard|full|quantized   vertex format of the cooked files (default standard)
+//     --no-optimize                      keep the imported triangle and vertex order
+//     --lods N                           detail levels including the full mesh, 1 disables LODs (default 4)
+//     --lod-reduction R                  triangle count of a level relative to the previous (default 0.5)
+//     --lod-error E                      largest error of a level relative to the mesh radius (default 0.05)
+//     --no-meshlets                      skip the meshlet table used for cluster culling
+//     --threads N                        worker threads, 0 uses every core (default 0)
+//     --force                            cook everything regardless of the manifest
+
+#include <tools/asset_cooker/cook_manifest.hpp>
+
+// std
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// renderer includes
+#include <renderer/renderer/parallel_for.hpp>
+#include <renderer/renderer/mesh/mesh_cooker.hpp>
+#include <renderer/renderer/mesh/mesh_file.hpp>
+#include <renderer/renderer/mesh/mesh_importer.hpp>
+
+namespace {
+
+// bump when the cooking pipeline changes its output for the same input
+constexpr uint64_t s_cooker_version = 3;
+constexpr const char* s_manifest_name = ".cook_manifest";
+
+struct CookerSettings
+{
+    renderer::mesh::CookOptions cook_options_;
+    uint32_t thread_count_ = 0;
+    bool force_ = false;
+    std::filesystem::path output_directory_;
+    std::vector<std::filesystem::path> inputs_;
+};
+
+struct CookJob
+{
+    std::string source_;
+    std::string output_;
+    uint64_t key_ = 0;
+    bool cooked_ = false;
+    std::string error_;
+};
+
+void PrintUsage()
+{
+    std::cerr << "usage: asset_cooker [--format standard|full|quantized] [--lods N] [--lod-reduction R] [--lod-error E]"
+              << " [--no-meshlets] [--no-optimize] [--threads N] [--force]"
+              << " -o <output dir> <source file or directory>..." << std::endl;
+}
+
+bool ParseFormat(std::string_view name, renderer::mesh::MeshVertexFormat& format)
+{
+    if (name == "standard")
+    {
+        format = renderer::mesh::MeshVertexFormat::Standard;
+    }
+    else if (name == "full")
+    {
+        format = renderer::mesh::MeshVertexFormat::Full;
+    }
+    else if (name == "quantized")
+    {
+        format = renderer::mesh::MeshVertexFormat::Quantized;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool ParseArguments(int argc, char** argv, CookerSettings& settings)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg{argv[i]};
+
+        try
+        {
+            if (arg == "--format" && i + 1 < argc)
+            {
+                if (!ParseFormat(argv[++i], settings.cook_options_.vertex_format_))
+                {
+                    std::cerr << "Unknown vertex format: " << argv[i] << std::endl;
+                    return false;
+                }
+            }
+            else if (arg == "--lods" && i + 1 < argc)
+            {
+                settings.cook_options_.lod_count_ = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--lod-reduction" && i + 1 < argc)
+            {
+                settings.cook_options_.lod_reduction_ = std::stof(argv[++i]);
+            }
+            else if (arg == "--lod-error" && i + 1 < argc)
+            {
+                settings.cook_options_.lod_max_error_ = std::stof(argv[++i]);
+            }
+            else if (arg == "--no-meshlets")
+            {
+                settings.cook_options_.build_meshlets_ = false;
+            }
+            else if (arg == "--no-optimize")
+            {
+                settings.cook_options_.optimize_ = false;
+            }
+            else if (arg == "--threads" && i + 1 < argc)
+            {
+                settings.thread_count_ = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--force")
+            {
+                settings.force_ = true;
+            }
+            else if (arg == "-o" && i + 1 < argc)
+            {
+                settings.output_directory_ = argv[++i];
+            }
+            else if (!arg.empty() && arg[0] == '-')
+            {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return false;
+            }
+            else
+            {
+                settings.inputs_.emplace_back(arg);
+            }
+        }
+        catch (const std::invalid_argument&)
+        {
+            std::cerr << "Invalid value for " << arg << ": " << argv[i] << std::endl;
+            return false;
+        }
+        catch (const std::out_of_range&)
+        {
+            std::cerr << "Value out of range for " << arg << ": " << argv[i] << std::endl;
+            return false;
+        }
+    }
+
+    return !settings.output_directory_.empty() && !settings.inputs_.empty();
+}
+
+void AddJob(std::vector<CookJob>& jobs, const std::filesystem::path& source, const std::filesystem::path& output)
+{
+    CookJob job{};
+    job.source_ = source.string();
+    job.output_ = std::filesystem::path(output).replace_extension(".rmesh").string();
+    jobs.push_back(std::move(job));
+}
+
+// directories are searched recursively and mirrored below the output directory
+std::vector<CookJob> CollectJobs(const CookerSettings& settings)
+{
+    std::vector<CookJob> jobs;
+    for (const std::filesystem::path& input : settings.inputs_)
+    {
+        if (std::filesystem::is_directory(input))
+        {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(input))
+            {
+                if (entry.is_regular_file() && renderer::mesh::IsImportableMesh(entry.path().string()))
+                {
+                    AddJob(jobs, entry.path(), settings.output_directory_ / std::filesystem::relative(entry.path(), input));
+                }
+            }
+        }
+        else
+        {
+            AddJob(jobs, input, settings.output_directory_ / input.filename());
+        }
+    }
+
+    // sources differing only in extension would overwrite each other's output
+    std::map<std::string, const CookJob*> outputs;
+    for (CookJob& job : jobs)
+    {
+        auto [it, inserted] = outputs.emplace(job.output_, &job);
+        if (!inserted)
+        {
+            job.error_ = "output " + job.output_ + " is already cooked from " + it->second->source_;
+        }
+    }
+    return jobs;
+}
+
+uint64_t ComputeKey(const CookJob& job, const CookerSettings& settings)
+{
+    const renderer::mesh::CookOptions& options = settings.cook_options_;
+    uint64_t key = cooker::HashBytes(&s_cooker_version, sizeof(s_cooker_version));
+    key = cooker::HashBytes(&renderer::mesh::s_mesh_file_version_, sizeof(renderer::mesh::s_mesh_file_version_), key);
+    key = cooker::HashBytes(&options.vertex_format_, sizeof(options.vertex_format_), key);
+    key = cooker::HashBytes(&options.optimize_, sizeof(options.optimize_), key);
+    key = cooker::HashBytes(&options.lod_count_, sizeof(options.lod_count_), key);
+    key = cooker::HashBytes(&options.lod_reduction_, sizeof(options.lod_reduction_), key);
+    key = cooker::HashBytes(&options.lod_max_error_, sizeof(options.lod_max_error_), key);
+    key = cooker::HashBytes(&options.build_meshlets_, sizeof(options.build_meshlets_), key);
+    key = cooker::HashBytes(&options.meshlet_settings_, sizeof(options.meshlet_settings_), key);
+
+    key = cooker::HashFile(job.source_, key);
+    for (const std::string& dependency : renderer::mesh::GetImportDependencies(job.source_))
+    {
+        key = cooker::HashFile(dependency, key);
+    }
+    return key;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    CookerSettings settings;
+    if (!ParseArguments(argc, argv, settings))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::filesystem::create_directories(settings.output_directory_);
+    cooker::CookManifest manifest((settings.output_directory_ / s_manifest_name).string());
+
+    std::vector<CookJob> jobs = CollectJobs(settings);
+    uint32_t worker_count = renderer::GetWorkerCount(settings.thread_count_);
+
+    // hashing reads every source once, spread it over the workers as well
+    renderer::ParallelFor(jobs.size(), worker_count, [&](size_t i)
+    {
+        if (!jobs[i].error_.empty())
+        {
+            return;
+        }
+
+        try
+        {
+            jobs[i].key_ = ComputeKey(jobs[i], settings);
+        }
+        catch (const std::exception& error)
+        {
+            jobs[i].error_ = error.what();
+        }
+    });
+
+    std::vector<CookJob*> stale_jobs;
+    for (CookJob& job : jobs)
+    {
+        if (job.error_.empty() && (settings.force_ || !manifest.IsUpToDate(job.output_, job.key_)))
+        {
+            stale_jobs.push_back(&job);
+        }
+    }
+
+    // many assets: one per worker, a single asset: all workers inside the importer and optimizer
+    uint32_t inner_thread_count = stale_jobs.size() > 1 ? 1 : worker_count;
+    renderer::mesh::ImportOptions import_options{};
+    import_options.thread_count_ = inner_thread_count;
+    renderer::mesh::CookOptions cook_options = settings.cook_options_;
+    cook_options.thread_count_ = inner_thread_count;
+
+    std::mutex output_mutex;
+    renderer::ParallelFor(stale_jobs.size(), worker_count, [&](size_t i)
+    {
+        CookJob& job = *stale_jobs[i];
+        try
+        {
+            renderer::mesh::ImportedMesh mesh = renderer::mesh::ImportMesh(job.source_, import_options);
+
+            std::filesystem::create_directories(std::filesystem::path(job.output_).parent_path());
+            renderer::mesh::CookReport report = renderer::mesh::CookMesh(mesh, job.output_, cook_options);
+            job.cooked_ = true;
+
+            std::lock_guard<std::mutex> lock(output_mutex);
+            renderer::mesh::PrintStats(job.source_.c_str(), mesh.stats_);
+            renderer::mesh::PrintReport(job.output_.c_str(), report);
+        }
+        catch (const std::exception& error)
+        {
+            job.error_ = error.what();
+        }
+    });
+
+    size_t cooked_count = 0;
+    size_t failed_count = 0;
+    for (const CookJob& job : jobs)
+    {
+        if (!job.error_.empty())
+        {
+            std::cerr << "Failed to cook " << job.source_ << ": " << job.error_ << std::endl;
+            ++failed_count;
+        }
+        else if (job.cooked_)
+        {
+            manifest.Update(job.output_, job.key_, job.source_);
+            ++cooked_count;
+        }
+    }
+    manifest.Save();
+
+    float seconds = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - start_time).count();
+    std::cout << "Cooked " << cooked_count << " of " << jobs.size() << " assets ("
+              << jobs.size() - cooked_count - failed_count << " up to date, " << failed_count << " failed) in " << seconds << " s on "
+              << worker_count << " threads" << std::endl;
+
+    return failed_count == 0 ? 0 : 1;
+}
@@ -0,0 +1,270 @@
+// CPU frustum culling benchmark: the kernels of bounds_culler.hpp against a naive per object glm
+// loop over the same random scene, for bounding spheres and AABBs. Every kernel's visible list is
+// checked against the naive one. Build with optimizations (CMAKE_BUILD_TYPE=Release).
+//
+//     cull_benchmark [options]
+//
+//     --counts N,N,...   object counts (default 10000,100000,1000000)
+//     --iterations N     timed runs per kernel, the median is reported (default 21)
+//     --seed N           scene seed (default 1)
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// glm
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// renderer includes
+#include <renderer/camera.hpp>
+#include <renderer/renderer/bounds_culler.hpp>
+#include <renderer/renderer/frustum.hpp>
+
+namespace {
+
+struct BenchmarkSettings
+{
+    std::vector<size_t> counts_ = {10000, 100000, 1000000};
+    uint32_t iterations_ = 21;
+    uint32_t seed_ = 1;
+};
+
+// the same objects as arrays of structures, for the naive loops
+struct Scene
+{
+    std::vector<glm::vec4> spheres_;
+    std::vector<glm::vec3> aabb_min_;
+    std::vector<glm::vec3> aabb_max_;
+
+    renderer::SphereBounds sphere_bounds_;
+    renderer::AabbBounds aabb_bounds_;
+};
+
+void PrintUsage()
+{
+    std::cerr << "usage: cull_benchmark [--counts N,N,...] [--iterations N] [--seed N]" << std::endl;
+}
+
+bool ParseCounts(std::string_view list, std::vector<size_t>& counts)
+{
+    counts.clear();
+    while (!list.empty())
+    {
+        size_t comma = list.find(',');
+        std::string item(list.substr(0, comma));
+        if (item.empty())
+        {
+            return false;
+        }
+        counts.push_back(std::stoul(item));
+        list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+    }
+    return !counts.empty();
+}
+
+bool ParseArguments(int argc, char** argv, BenchmarkSettings& settings)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg{argv[i]};
+
+        if (arg == "--counts" && i + 1 < argc)
+        {
+            if (!ParseCounts(argv[++i], settings.counts_))
+            {
+                std::cerr << "Invalid object counts: " << argv[i] << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--iterations" && i + 1 < argc)
+        {
+            settings.iterations_ = std::max<uint32_t>(static_cast<uint32_t>(std::stoul(argv[++i])), 1);
+        }
+        else if (arg == "--seed" && i + 1 < argc)
+        {
+            settings.seed_ = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else
+        {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// objects scattered around the camera's target, so some are in view from the default camera
+Scene MakeScene(size_t count, uint32_t seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> extent(0.05f, 0.5f);
+
+    Scene scene;
+    scene.spheres_.reserve(count);
+    scene.aabb_min_.reserve(count);
+    scene.aabb_max_.reserve(count);
+    scene.sphere_bounds_.Reserve(count);
+    scene.aabb_bounds_.Reserve(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        glm::vec3 center(position(random), position(random), position(random));
+        glm::vec3 half_extent(extent(random), extent(random), extent(random));
+        glm::vec4 sphere(center, glm::length(half_extent));
+
+        scene.spheres_.push_back(sphere);
+        scene.aabb_min_.push_back(center - half_extent);
+        scene.aabb_max_.push_back(center + half_extent);
+        scene.sphere_bounds_.Add(sphere);
+        scene.aabb_bounds_.Add(center - half_extent, center + half_extent);
+    }
+    return scene;
+}
+
+void NaiveCullSpheres(const renderer::FrustumPlanes& planes, const std::vector<glm::vec4>& spheres, std::vector<uint32_t>& visible)
+{
+    visible.clear();
+    for (size_t i = 0; i < spheres.size(); ++i)
+    {
+        const glm::vec4& sphere = spheres[i];
+        bool inside = true;
+        for (const glm::vec4& plane : planes)
+        {
+            if (glm::dot(glm::vec3(plane), glm::vec3(sphere)) + plane.w < -sphere.w)
+            {
+                inside = false;
+                break;
+            }
+        }
+        if (inside)
+        {
+            visible.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+void NaiveCullAabbs(const renderer::FrustumPlanes& planes, const std::vector<glm::vec3>& mins, const std::vector<glm::vec3>& maxs, std::vector<uint32_t>& visible)
+{
+    visible.clear();
+    for (size_t i = 0; i < mins.size(); ++i)
+    {
+        bool inside = true;
+        for (const glm::vec4& plane : planes)
+        {
+            glm::vec3 corner(plane.x >= 0.0f ? maxs[i].x : mins[i].x,
+                             plane.y >= 0.0f ? maxs[i].y : mins[i].y,
+                             plane.z >= 0.0f ? maxs[i].z : mins[i].z);
+            if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+            {
+                inside = false;
+                break;
+            }
+        }
+        if (inside)
+        {
+            visible.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+// median of iterations runs in milliseconds, cull's outputs are those of the last run
+template<typename F>
+float MeasureMs(uint32_t iterations, F&& cull)
+{
+    std::vector<float> times(iterations);
+    for (float& time : times)
+    {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        cull();
+        time = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - start_time).count();
+    }
+    std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    return times[times.size() / 2];
+}
+
+void PrintRow(size_t count, const char* bounds, const char* kernel, size_t visible, float ms, float naive_ms, bool matches)
+{
+    std::cout << std::setw(9) << count << std::setw(8) << bounds << std::setw(8) << kernel
+              << std::setw(10) << visible
+              << std::setw(10) << std::fixed << std::setprecision(3) << ms
+              << std::setw(10) << std::setprecision(1) << (ms > 0.0f ? count / (ms * 1000.0f) : 0.0f)
+              << std::setw(8) << std::setprecision(2) << (ms > 0.0f ? naive_ms / ms : 0.0f) << "x"
+              << (matches ? "" : "  MISMATCH") << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BenchmarkSettings settings;
+    if (!ParseArguments(argc, argv, settings))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    // the engine's default view
+    engine::Camera camera(glm::vec3(0.0f, 0.0f, -5.0f), glm::vec3(0.0f), engine::Camera::ProjectionMode::Perspective);
+    renderer::FrustumPlanes planes = renderer::ExtractFrustumPlanes(camera.GetProjMatrix() * camera.GetViewMatrix());
+
+    std::vector<renderer::CullKernel> kernels;
+    for (renderer::CullKernel kernel : {renderer::CullKernel::Scalar, renderer::CullKernel::Sse41, renderer::CullKernel::Avx2})
+    {
+        if (renderer::IsCullKernelSupported(kernel))
+        {
+            kernels.push_back(kernel);
+        }
+    }
+    std::cout << "Best kernel: " << renderer::ToString(renderer::GetBestCullKernel()) << ", median of " << settings.iterations_ << " runs" << std::endl;
+    std::cout << std::setw(9) << "objects" << std::setw(8) << "bounds" << std::setw(8) << "kernel" << std::setw(10) << "visible"
+              << std::setw(10) << "ms" << std::setw(10) << "Mobj/s" << std::setw(9) << "speedup" << std::endl;
+
+    bool all_match = true;
+    for (size_t count : settings.counts_)
+    {
+        Scene scene = MakeScene(count, settings.seed_);
+        std::vector<uint32_t> naive_visible;
+        std::vector<uint32_t> storage;
+        std::span<const uint32_t> visible;
+        naive_visible.reserve(count);
+
+        // spheres
+        float naive_ms = MeasureMs(settings.iterations_, [&]() { NaiveCullSpheres(planes, scene.spheres_, naive_visible); });
+        PrintRow(count, "sphere", "naive", naive_visible.size(), naive_ms, naive_ms, true);
+        for (renderer::CullKernel kernel : kernels)
+        {
+            float ms = MeasureMs(settings.iterations_, [&]() { visible = renderer::CullSpheres(planes, scene.sphere_bounds_, storage, kernel); });
+            bool matches = std::equal(visible.begin(), visible.end(), naive_visible.begin(), naive_visible.end());
+            all_match &= matches;
+            PrintRow(count, "sphere", renderer::ToString(kernel), visible.size(), ms, naive_ms, matches);
+        }
+
+        // AABBs
+        naive_ms = MeasureMs(settings.iterations_, [&]() { NaiveCullAabbs(planes, scene.aabb_min_, scene.aabb_max_, naive_visible); });
+        PrintRow(count, "aabb", "naive", naive_visible.size(), naive_ms, naive_ms, true);
+        for (renderer::CullKernel kernel : kernels)
+        {
+            float ms = MeasureMs(settings.iterations_, [&]() { visible = renderer::CullAabbs(planes, scene.aabb_bounds_, storage, kernel); });
+            bool matches = std::equal(visible.begin(), visible.end(), naive_visible.begin(), naive_visible.end());
+            all_match &= matches;
+            PrintRow(count, "aabb", renderer::ToString(kernel), visible.size(), ms, naive_ms, matches);
+        }
+    }
+
+    if (!all_match)
+    {
+        std::cerr << "A kernel's visible list differs from the naive loop" << std::endl;
+        return 1;
+    }
+    return 0;
+}